@@ -0,0 +1,214 @@
+#include "AlgorithmSelector.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "ExactSolver.h"
+
+using namespace std;
+
+const int AlgorithmSelector::MAX_BRANCH_AND_BOUND_VERTICES;
+const int AlgorithmSelector::MAX_MATRIX_VERTICES;
+
+AlgorithmSelector::AlgorithmSelector() {
+    // measured with 'proj2 calibrate' on the toy and extra graphs
+    table = {
+            {Pipeline::ExactDP,          5,   0.000010, 1.0},
+            {Pipeline::ExactDP,          10,  0.000500, 1.0},
+            {Pipeline::ExactDP,          14,  0.010000, 1.0},
+            {Pipeline::ExactDP,          18,  0.380000, 1.0},
+            {Pipeline::ExactDP,          20,  1.980000, 1.0},
+            {Pipeline::BranchAndBound,   5,   0.000020, 1.0},
+            {Pipeline::BranchAndBound,   8,   0.002400, 1.0},
+            {Pipeline::BranchAndBound,   10,  0.032600, 1.0},
+            {Pipeline::BranchAndBound,   12,  0.672500, 1.0},
+            {Pipeline::BranchAndBound,   13,  2.511000, 1.0},
+            {Pipeline::LocalSearch,      10,  0.000100, 1.009},
+            {Pipeline::LocalSearch,      18,  0.000200, 1.044},
+            {Pipeline::LocalSearch,      100, 0.002300, 1.0},
+            {Pipeline::LocalSearch,      500, 0.033400, 1.0},
+            {Pipeline::LocalSearch,      900, 0.102700, 1.0},
+            {Pipeline::MstApproximation, 10,  0.000100, 1.148},
+            {Pipeline::MstApproximation, 18,  0.000200, 1.377},
+            {Pipeline::MstApproximation, 100, 0.001800, 1.204},
+            {Pipeline::MstApproximation, 500, 0.049300, 1.201},
+            {Pipeline::MstApproximation, 900, 0.118400, 1.208},
+    };
+}
+
+string AlgorithmSelector::getName(Pipeline pipeline) {
+    switch (pipeline) {
+        case Pipeline::ExactDP:
+            return "exact-dp";
+        case Pipeline::BranchAndBound:
+            return "branch-and-bound";
+        case Pipeline::LocalSearch:
+            return "nn-2opt";
+        case Pipeline::MstApproximation:
+            return "mst-approximation";
+    }
+    return "";
+}
+
+vector<Pipeline> AlgorithmSelector::getPipelines() {
+    return {Pipeline::ExactDP, Pipeline::BranchAndBound, Pipeline::LocalSearch, Pipeline::MstApproximation};
+}
+
+bool AlgorithmSelector::parseName(const string &name, Pipeline &pipeline) {
+    for (Pipeline p: getPipelines()) {
+        if (getName(p) == name) {
+            pipeline = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AlgorithmSelector::loadCalibration(const string &filename) {
+    ifstream file(filename);
+    if (!file.is_open()) return false;
+
+    vector<CalibrationEntry> entries;
+    string line;
+    getline(file, line);
+    while (getline(file, line)) {
+        stringstream linestream(line);
+        string name, temp;
+        CalibrationEntry entry;
+        getline(linestream, name, ',');
+        if (!parseName(name, entry.pipeline)) continue;
+        getline(linestream, temp, ',');
+        entry.n = stoi(temp);
+        getline(linestream, temp, ',');
+        entry.seconds = stod(temp);
+        getline(linestream, temp, ',');
+        entry.costRatio = stod(temp);
+        entries.push_back(entry);
+    }
+    if (entries.empty()) return false;
+    table = entries;
+    return true;
+}
+
+bool AlgorithmSelector::saveCalibration(const string &filename, const vector<CalibrationEntry> &entries) {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        cerr << "There was an error opening file " << filename << endl;
+        return false;
+    }
+    file << "pipeline,n,seconds,costRatio" << endl;
+    for (const auto &e: entries) {
+        file << getName(e.pipeline) << "," << e.n << "," << setprecision(9) << e.seconds << "," << e.costRatio << endl;
+    }
+    return true;
+}
+
+bool AlgorithmSelector::isFeasible(Pipeline pipeline, const InstanceFeatures &features) {
+    if (features.n < 2) return false;
+    switch (pipeline) {
+        case Pipeline::ExactDP:
+            return features.n <= ExactSolver::MAX_DP_VERTICES;
+        case Pipeline::BranchAndBound:
+            return features.n <= MAX_BRANCH_AND_BOUND_VERTICES;
+        case Pipeline::LocalSearch:
+            return features.n <= MAX_MATRIX_VERTICES && (features.complete || features.hasCoordinates);
+        case Pipeline::MstApproximation:
+            return features.complete || features.hasCoordinates;
+    }
+    return false;
+}
+
+double AlgorithmSelector::predictSeconds(Pipeline pipeline, int n) const {
+    // average the measurements of each size
+    map<int, pair<double, int>> bySize;
+    for (const auto &e: table) {
+        if (e.pipeline != pipeline || e.seconds <= 0) continue;
+        bySize[e.n].first += log(e.seconds);
+        bySize[e.n].second++;
+    }
+    if (bySize.empty()) return numeric_limits<double>::infinity();
+
+    bool exponential = pipeline == Pipeline::ExactDP || pipeline == Pipeline::BranchAndBound;
+    vector<pair<double, double>> points;
+    for (const auto &s: bySize) {
+        points.push_back(make_pair(exponential ? s.first : log(s.first), s.second.first / s.second.second));
+    }
+    if (points.size() == 1) return exp(points[0].second);
+
+    double x = exponential ? n : log(n);
+    size_t right = 1;
+    while (right + 1 < points.size() && points[right].first < x) right++;
+    const auto &a = points[right - 1];
+    const auto &b = points[right];
+    double y = a.second + (b.second - a.second) * (x - a.first) / (b.first - a.first);
+    return exp(y);
+}
+
+double AlgorithmSelector::predictCostRatio(Pipeline pipeline, int n) const {
+    if (pipeline == Pipeline::ExactDP || pipeline == Pipeline::BranchAndBound) return 1.0;
+    double bestDistance = numeric_limits<double>::infinity();
+    double sum = 0.0;
+    int count = 0;
+    for (const auto &e: table) {
+        if (e.pipeline != pipeline) continue;
+        double distance = fabs(log((double) e.n) - log((double) n));
+        if (distance < bestDistance - 1e-12) {
+            bestDistance = distance;
+            sum = 0.0;
+            count = 0;
+        }
+        if (fabs(distance - bestDistance) <= 1e-12) {
+            sum += e.costRatio;
+            count++;
+        }
+    }
+    return count == 0 ? numeric_limits<double>::infinity() : sum / count;
+}
+
+Pipeline AlgorithmSelector::select(const InstanceFeatures &features, double budgetSeconds) const {
+    bool found = false;
+    Pipeline best = Pipeline::MstApproximation;
+    double bestRatio = 0, bestSeconds = 0;
+    for (Pipeline p: getPipelines()) {
+        if (!isFeasible(p, features)) continue;
+        double seconds = predictSeconds(p, features.n);
+        double ratio = predictCostRatio(p, features.n);
+        bool fits = seconds <= budgetSeconds;
+        bool bestFits = found && bestSeconds <= budgetSeconds;
+        bool better;
+        if (!found) better = true;
+        else if (fits != bestFits) better = fits;
+        else if (fits) better = ratio < bestRatio - 1e-9 || (fabs(ratio - bestRatio) <= 1e-9 && seconds < bestSeconds);
+        else better = seconds < bestSeconds;
+        if (better) {
+            found = true;
+            best = p;
+            bestRatio = ratio;
+            bestSeconds = seconds;
+        }
+    }
+    return best;
+}
+
+void AlgorithmSelector::printPredictions(const InstanceFeatures &features, double budgetSeconds) const {
+    cout << "Vertices: " << features.n << ", edges: " << features.edges << ", density: " << fixed
+         << setprecision(3) << features.density << (features.complete ? " (complete)" : "")
+         << ", coordinates: " << (features.hasCoordinates ? "yes" : "no") << endl;
+    cout << "Metric violations: " << features.metricViolationRate * 100 << "% of "
+         << features.sampledTriangles << " sampled triangles" << endl;
+    for (Pipeline p: getPipelines()) {
+        cout << "  " << left << setw(18) << getName(p) << right;
+        if (!isFeasible(p, features)) {
+            cout << "not available for this dataset" << endl;
+            continue;
+        }
+        double seconds = predictSeconds(p, features.n);
+        cout << "predicted " << scientific << setprecision(2) << seconds << " s, cost ratio " << fixed
+             << setprecision(3) << predictCostRatio(p, features.n)
+             << (seconds <= budgetSeconds ? "" : " (over budget)") << endl;
+    }
+}
@@ -0,0 +1,147 @@
+#ifndef PROJ2_ALGORITHMSELECTOR_H
+#define PROJ2_ALGORITHMSELECTOR_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Characteristics of a loaded instance that decide which algorithms can run on it
+ */
+struct InstanceFeatures {
+    int n = 0;
+    long long edges = 0;
+    double density = 0.0;
+    bool complete = false;
+    bool hasCoordinates = false;
+    int sampledTriangles = 0;
+    double metricViolationRate = 0.0;
+};
+
+/**
+ * @brief Solver pipelines the selector can choose from
+ */
+enum class Pipeline {
+    ExactDP,          // Held-Karp dynamic programming
+    BranchAndBound,   // backtracking with cost bound
+    LocalSearch,      // nearest neighbour + 2-opt
+    MstApproximation  // MST preorder walk
+};
+
+/**
+ * @brief Measured running time and quality of a pipeline on an instance of a given size
+ */
+struct CalibrationEntry {
+    Pipeline pipeline;
+    int n;
+    double seconds;
+    double costRatio; // cost divided by the best cost found on the same instance
+};
+
+/**
+ * @brief Chooses the solver pipeline expected to give the best tour within a latency budget
+ * @details Predictions come from a calibration table produced by 'proj2 calibrate'; a built-in table
+ * measured on the extra graphs is used when none is loaded.
+ */
+class AlgorithmSelector {
+public:
+    /** Largest instance the backtracking pipeline is considered for */
+    static const int MAX_BRANCH_AND_BOUND_VERTICES = 13;
+    /** Largest instance a dense distance matrix is built for */
+    static const int MAX_MATRIX_VERTICES = 5000;
+
+    /**
+     * @brief Constructs a selector with the built-in calibration table
+     * @details Time complexity: O(1)
+     */
+    AlgorithmSelector();
+
+    /**
+     * @brief Replaces the calibration table with one saved by saveCalibration()
+     * @details Time complexity: O(L), where L is the number of lines
+     * @param filename Calibration file
+     * @return True if the file was read
+     */
+    bool loadCalibration(const std::string &filename);
+
+    /**
+     * @brief Saves a calibration table as CSV (pipeline,n,seconds,costRatio)
+     * @details Time complexity: O(L)
+     * @param filename Output file
+     * @param entries Measurements
+     * @return True if the file was written
+     */
+    static bool saveCalibration(const std::string &filename, const std::vector<CalibrationEntry> &entries);
+
+    /**
+     * @brief Checks if a pipeline can produce a valid tour on an instance
+     * @details Time complexity: O(1)
+     * @param pipeline Pipeline
+     * @param features Features of the instance
+     * @return True if the pipeline is applicable
+     */
+    static bool isFeasible(Pipeline pipeline, const InstanceFeatures &features);
+
+    /**
+     * @brief Predicts the running time of a pipeline by interpolating the calibration table
+     * @details Exponential pipelines are interpolated on log(time) versus n, the others on log(time) versus
+     * log(n). Time complexity: O(L)
+     * @param pipeline Pipeline
+     * @param n Number of vertices
+     * @return Predicted seconds, or infinity without calibration data
+     */
+    double predictSeconds(Pipeline pipeline, int n) const;
+
+    /**
+     * @brief Predicts the ratio between the cost of a pipeline and the best known cost
+     * @details Time complexity: O(L)
+     * @param pipeline Pipeline
+     * @param n Number of vertices
+     * @return Ratio measured at the closest calibrated size, 1 for exact pipelines
+     */
+    double predictCostRatio(Pipeline pipeline, int n) const;
+
+    /**
+     * @brief Chooses the pipeline with the best predicted cost among those predicted to fit the budget
+     * @details Falls back to the fastest feasible pipeline when none fits. Time complexity: O(L)
+     * @param features Features of the instance
+     * @param budgetSeconds Latency budget
+     * @return The chosen pipeline
+     */
+    Pipeline select(const InstanceFeatures &features, double budgetSeconds) const;
+
+    /**
+     * @brief Prints the prediction of every pipeline for an instance
+     * @details Time complexity: O(L)
+     * @param features Features of the instance
+     * @param budgetSeconds Latency budget
+     */
+    void printPredictions(const InstanceFeatures &features, double budgetSeconds) const;
+
+    /**
+     * @brief Gets the name of a pipeline
+     * @details Time complexity: O(1)
+     * @param pipeline Pipeline
+     * @return Name used in calibration files
+     */
+    static std::string getName(Pipeline pipeline);
+
+    /**
+     * @brief Gets all the pipelines
+     * @details Time complexity: O(1)
+     * @return Every pipeline
+     */
+    static std::vector<Pipeline> getPipelines();
+
+private:
+    std::vector<CalibrationEntry> table;
+
+    /**
+     * @brief Gets the pipeline with a given name
+     * @param name Name of the pipeline
+     * @param pipeline Pipeline to store the result
+     * @return True if the name is known
+     */
+    static bool parseName(const std::string &name, Pipeline &pipeline);
+};
+
+#endif //PROJ2_ALGORITHMSELECTOR_H
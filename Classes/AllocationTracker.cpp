@@ -0,0 +1,136 @@
+#include "AllocationTracker.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <new>
+#include <cstddef>
+
+using namespace std;
+
+namespace {
+    // plain data only: these are touched from operator new, before any constructor could run
+    struct ThreadCounters {
+        long long allocations;
+        long long frees;
+        long long bytes;
+        long long live;
+        long long peak;
+    };
+
+    thread_local ThreadCounters counters;
+}
+
+#ifdef TRACK_ALLOCATIONS
+
+namespace {
+    // every block is prefixed by its size so that unsized deletes can be accounted for
+    const size_t HEADER = alignof(max_align_t);
+
+    void *trackedAlloc(size_t size) {
+        void *raw = malloc(size + HEADER);
+        if (raw == nullptr) return nullptr;
+        *static_cast<size_t *>(raw) = size;
+        counters.allocations++;
+        counters.bytes += size;
+        counters.live += size;
+        if (counters.live > counters.peak) counters.peak = counters.live;
+        return static_cast<char *>(raw) + HEADER;
+    }
+
+    void trackedFree(void *ptr) {
+        if (ptr == nullptr) return;
+        void *raw = static_cast<char *>(ptr) - HEADER;
+        counters.frees++;
+        counters.live -= *static_cast<size_t *>(raw);
+        free(raw);
+    }
+
+    void *trackedNew(size_t size) {
+        void *ptr = trackedAlloc(size == 0 ? 1 : size);
+        if (ptr == nullptr) throw bad_alloc();
+        return ptr;
+    }
+}
+
+void *operator new(size_t size) {
+    return trackedNew(size);
+}
+
+void *operator new[](size_t size) {
+    return trackedNew(size);
+}
+
+void *operator new(size_t size, const nothrow_t &) noexcept {
+    return trackedAlloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](size_t size, const nothrow_t &) noexcept {
+    return trackedAlloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void *ptr, const nothrow_t &) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void *ptr, const nothrow_t &) noexcept {
+    trackedFree(ptr);
+}
+
+#endif
+
+AllocationScope::AllocationScope() {
+    start.allocations = counters.allocations;
+    start.frees = counters.frees;
+    start.bytes = counters.bytes;
+    startLive = counters.live;
+    outerPeak = counters.peak;
+    counters.peak = counters.live;
+}
+
+AllocationScope::~AllocationScope() {
+    if (outerPeak > counters.peak) counters.peak = outerPeak;
+}
+
+AllocationStats AllocationScope::getStats() const {
+    AllocationStats stats;
+    stats.allocations = counters.allocations - start.allocations;
+    stats.frees = counters.frees - start.frees;
+    stats.bytes = counters.bytes - start.bytes;
+    stats.peakLiveBytes = counters.peak - startLive;
+    return stats;
+}
+
+void AllocationScope::print(const string &label) const {
+    if (!isEnabled()) return;
+    AllocationStats stats = getStats();
+    ios state(nullptr);
+    state.copyfmt(cout);
+    cout << "Allocations in " << label << ": " << stats.allocations << " (" << fixed << setprecision(2)
+         << stats.bytes / 1048576.0 << " MB), frees: " << stats.frees << ", peak live: "
+         << stats.peakLiveBytes / 1048576.0 << " MB" << endl;
+    cout.copyfmt(state);
+}
+
+bool AllocationScope::isEnabled() {
+#ifdef TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
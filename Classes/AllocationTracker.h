@@ -0,0 +1,71 @@
+#ifndef PROJ2_ALLOCATIONTRACKER_H
+#define PROJ2_ALLOCATIONTRACKER_H
+
+#include <string>
+
+/**
+ * @brief Allocation counters of a region of code
+ */
+struct AllocationStats {
+    /** Number of calls to operator new */
+    long long allocations = 0;
+    /** Number of calls to operator delete */
+    long long frees = 0;
+    /** Total number of bytes requested */
+    long long bytes = 0;
+    /** Highest number of live bytes above the live bytes at the start of the region */
+    long long peakLiveBytes = 0;
+};
+
+/**
+ * @brief Measures the heap traffic of the current thread while it is in scope
+ * @details Counting only happens when the project is configured with -DPROJ2_TRACK_ALLOCATIONS=ON, which
+ * replaces the global operator new/delete; otherwise all counters stay at zero and print() does nothing.
+ * Memory freed by a different thread than the one that allocated it is counted on the freeing thread.
+ */
+class AllocationScope {
+public:
+    /**
+     * @brief Starts measuring
+     * @details Time complexity: O(1)
+     */
+    AllocationScope();
+
+    /**
+     * @brief Stops measuring, restoring the peak of any enclosing scope
+     * @details Time complexity: O(1)
+     */
+    ~AllocationScope();
+
+    AllocationScope(const AllocationScope &) = delete;
+
+    AllocationScope &operator=(const AllocationScope &) = delete;
+
+    /**
+     * @brief Gets the counters since the scope started
+     * @details Time complexity: O(1)
+     * @return Allocation counters
+     */
+    AllocationStats getStats() const;
+
+    /**
+     * @brief Prints the counters since the scope started, if tracking is enabled
+     * @details Time complexity: O(1)
+     * @param label Name of the measured region
+     */
+    void print(const std::string &label) const;
+
+    /**
+     * @brief Checks if allocation tracking was compiled in
+     * @details Time complexity: O(1)
+     * @return True if operator new/delete are being counted
+     */
+    static bool isEnabled();
+
+private:
+    AllocationStats start;
+    long long startLive;
+    long long outerPeak;
+};
+
+#endif //PROJ2_ALLOCATIONTRACKER_H
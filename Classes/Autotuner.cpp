@@ -0,0 +1,280 @@
+#include "Autotuner.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+namespace {
+    const int MAX_CANDIDATES = 16;
+    const int MAX_RESTARTS = 8;
+    const int MAX_KICKS = 3000;
+    const int ITERATIONS = 4;
+    const int CANDIDATES_PER_ITERATION = 10;
+    const int ELITES = 3;
+    // instances seen before the first elimination test
+    const int FIRST_TEST = 5;
+
+    vector<TunedConfig> tunedConfigs;
+
+    bool sameConfig(const LocalSearchConfig &a, const LocalSearchConfig &b) {
+        return a.candidates == b.candidates && a.restarts == b.restarts && a.kicks == b.kicks;
+    }
+
+    /**
+     * @brief Upper 95% quantile of the chi-squared distribution (Wilson-Hilferty approximation)
+     */
+    double chiSquared95(int df) {
+        double z = 1.6448536;
+        double h = 2.0 / (9.0 * df);
+        return df * pow(1.0 - h + z * sqrt(h), 3);
+    }
+
+    /**
+     * @brief Upper 97.5% quantile of Student's t distribution (Cornish-Fisher expansion)
+     */
+    double studentT975(int df) {
+        double z = 1.9599640;
+        double z3 = z * z * z, z5 = z3 * z * z;
+        return z + (z3 + z) / (4.0 * df) + (5 * z5 + 16 * z3 + 3 * z) / (96.0 * df * df);
+    }
+}
+
+Autotuner::Autotuner(vector<DistanceMatrix> training, double budgetSeconds, unsigned seed)
+        : training(move(training)), budgetSeconds(budgetSeconds), rng(seed) {}
+
+DistanceMatrix Autotuner::sample(const DistanceMatrix &m, int n, mt19937 &rng) {
+    vector<int> vertices(m.size());
+    iota(vertices.begin(), vertices.end(), 0);
+    shuffle(vertices.begin(), vertices.end(), rng);
+    n = min(n, m.size());
+    DistanceMatrix result(n);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i != j) result.set(i, j, m.at(vertices[i], vertices[j]));
+        }
+    }
+    return result;
+}
+
+LocalSearchConfig Autotuner::randomConfig() {
+    LocalSearchConfig config;
+    config.candidates = uniform_int_distribution<int>(4, MAX_CANDIDATES)(rng);
+    config.restarts = uniform_int_distribution<int>(1, MAX_RESTARTS)(rng);
+    // kicks span several orders of magnitude, so they are drawn on a log scale
+    double logKicks = uniform_real_distribution<double>(0.0, log1p(MAX_KICKS))(rng);
+    config.kicks = (int) round(expm1(logKicks));
+    return config;
+}
+
+LocalSearchConfig Autotuner::perturb(const LocalSearchConfig &parent, double spread) {
+    normal_distribution<double> normal(0.0, spread);
+    LocalSearchConfig config;
+    config.candidates = max(4, min(MAX_CANDIDATES,
+                                   (int) round(parent.candidates + normal(rng) * (MAX_CANDIDATES - 4))));
+    config.restarts = max(1, min(MAX_RESTARTS, (int) round(parent.restarts + normal(rng) * (MAX_RESTARTS - 1))));
+    double logKicks = log1p(parent.kicks) + normal(rng) * log1p(MAX_KICKS);
+    config.kicks = max(0, min(MAX_KICKS, (int) round(expm1(max(0.0, logKicks)))));
+    return config;
+}
+
+vector<double> Autotuner::evaluate(const vector<LocalSearchConfig> &configs, int instance) {
+    vector<double> costs(configs.size());
+    const DistanceMatrix &m = training[instance];
+    ThreadPool::shared().parallelFor(0, configs.size(), 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; c++) {
+            auto start = chrono::steady_clock::now();
+            // every configuration gets the same seed on an instance (common random numbers)
+            vector<int> tour = LocalSearch::solve(m, 0, configs[c], 1000 + instance);
+            chrono::duration<double> duration = chrono::steady_clock::now() - start;
+            costs[c] = duration.count() > budgetSeconds ? numeric_limits<double>::infinity() : toDouble(m.tourCost(tour));
+        }
+    });
+    return costs;
+}
+
+vector<LocalSearchConfig> Autotuner::race(const vector<LocalSearchConfig> &candidates, int maxRuns, int &runsUsed) {
+    vector<int> alive(candidates.size());
+    iota(alive.begin(), alive.end(), 0);
+    // cost of every candidate on each instance seen, indexed like candidates
+    vector<vector<double>> blocks;
+    vector<double> rankSums;
+
+    auto computeRanks = [&]() {
+        // ranks among the candidates still alive, ties sharing their average rank
+        int k = (int) alive.size();
+        rankSums.assign(k, 0.0);
+        double sumSquares = 0.0;
+        vector<int> order(k);
+        for (const auto &block: blocks) {
+            iota(order.begin(), order.end(), 0);
+            sort(order.begin(), order.end(), [&](int a, int b) {
+                return block[alive[a]] < block[alive[b]];
+            });
+            for (int i = 0; i < k;) {
+                int j = i;
+                while (j + 1 < k && block[alive[order[j + 1]]] == block[alive[order[i]]]) j++;
+                double rank = (i + j) / 2.0 + 1.0;
+                for (int t = i; t <= j; t++) {
+                    rankSums[order[t]] += rank;
+                    sumSquares += rank * rank;
+                }
+                i = j + 1;
+            }
+        }
+        return sumSquares;
+    };
+
+    while (alive.size() > 1 && runsUsed + (int) alive.size() <= maxRuns) {
+        vector<LocalSearchConfig> configs;
+        for (int c: alive) {
+            configs.push_back(candidates[c]);
+        }
+        int instance = (int) (nextInstance++ % training.size());
+        vector<double> costs = evaluate(configs, instance);
+        runsUsed += (int) alive.size();
+        vector<double> block(candidates.size(), numeric_limits<double>::infinity());
+        for (size_t i = 0; i < alive.size(); i++) {
+            block[alive[i]] = costs[i];
+        }
+        blocks.push_back(block);
+
+        int b = (int) blocks.size();
+        if (b < FIRST_TEST) continue;
+        int k = (int) alive.size();
+        double sumSquares = computeRanks();
+        double ties = b * k * (k + 1) * (k + 1) / 4.0;
+        if (sumSquares - ties <= 1e-9) continue;
+        double spreadOfSums = 0.0;
+        for (double r: rankSums) {
+            spreadOfSums += (r - b * (k + 1) / 2.0) * (r - b * (k + 1) / 2.0);
+        }
+        double statistic = (k - 1) * spreadOfSums / (sumSquares - ties);
+        if (statistic <= chiSquared95(k - 1)) continue;
+
+        // post-hoc test: drop every candidate whose rank sum is too far from the best one
+        int df = (b - 1) * (k - 1);
+        double critical = studentT975(df) *
+                          sqrt(2.0 * b * (1.0 - statistic / (b * (k - 1.0))) * (sumSquares - ties) / df);
+        double bestSum = *min_element(rankSums.begin(), rankSums.end());
+        vector<int> survivors;
+        for (int i = 0; i < k; i++) {
+            if (rankSums[i] - bestSum <= critical) survivors.push_back(alive[i]);
+        }
+        alive = survivors;
+    }
+
+    computeRanks();
+    vector<int> order(alive.size());
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&](int a, int b) {
+        return rankSums[a] < rankSums[b];
+    });
+    vector<LocalSearchConfig> result;
+    for (int i: order) {
+        result.push_back(candidates[alive[i]]);
+    }
+    return result;
+}
+
+LocalSearchConfig Autotuner::tune(int maxRuns) {
+    if (training.empty()) return LocalSearchConfig();
+    shuffle(training.begin(), training.end(), rng);
+    int runsUsed = 0;
+    vector<LocalSearchConfig> elites = {LocalSearchConfig()};
+    for (int iteration = 1; iteration <= ITERATIONS && runsUsed < maxRuns; iteration++) {
+        // share what is left evenly among the remaining iterations
+        int iterationRuns = (maxRuns - runsUsed) / (ITERATIONS - iteration + 1);
+        double spread = 0.3 * pow(0.6, iteration - 1);
+        vector<LocalSearchConfig> candidates = elites;
+        int attempts = 0;
+        while ((int) candidates.size() < CANDIDATES_PER_ITERATION && attempts++ < 100 * CANDIDATES_PER_ITERATION) {
+            LocalSearchConfig config;
+            if (iteration == 1) config = randomConfig();
+            else {
+                // better elites are picked as parents more often
+                vector<double> weights;
+                for (size_t e = 0; e < elites.size(); e++) {
+                    weights.push_back((double) (elites.size() - e));
+                }
+                size_t parent = discrete_distribution<size_t>(weights.begin(), weights.end())(rng);
+                config = perturb(elites[parent], spread);
+            }
+            bool duplicate = false;
+            for (const auto &c: candidates) {
+                duplicate = duplicate || sameConfig(c, config);
+            }
+            if (!duplicate) candidates.push_back(config);
+        }
+        if (iterationRuns < (int) candidates.size() * FIRST_TEST) break;
+
+        vector<LocalSearchConfig> survivors = race(candidates, runsUsed + iterationRuns, runsUsed);
+        if (survivors.size() > ELITES) survivors.resize(ELITES);
+        elites = survivors;
+        cout << "  iteration " << iteration << ": " << candidates.size() << " candidates, best "
+             << describe(elites.front()) << " (" << runsUsed << "/" << maxRuns << " runs)" << endl;
+    }
+    return elites.front();
+}
+
+bool Autotuner::loadConfigs(const string &filename) {
+    ifstream file(filename);
+    if (!file.is_open()) return false;
+
+    vector<TunedConfig> configs;
+    string line;
+    getline(file, line);
+    while (getline(file, line)) {
+        stringstream linestream(line);
+        string temp;
+        TunedConfig tuned;
+        if (!getline(linestream, temp, ',')) continue;
+        tuned.maxVertices = stoi(temp);
+        getline(linestream, temp, ',');
+        tuned.config.candidates = stoi(temp);
+        getline(linestream, temp, ',');
+        tuned.config.restarts = stoi(temp);
+        getline(linestream, temp, ',');
+        tuned.config.kicks = stoi(temp);
+        configs.push_back(tuned);
+    }
+    if (configs.empty()) return false;
+    sort(configs.begin(), configs.end(), [](const TunedConfig &a, const TunedConfig &b) {
+        return a.maxVertices < b.maxVertices;
+    });
+    tunedConfigs = configs;
+    return true;
+}
+
+bool Autotuner::saveConfigs(const string &filename, const vector<TunedConfig> &configs) {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        cerr << "There was an error opening file " << filename << endl;
+        return false;
+    }
+    file << "maxVertices,candidates,restarts,kicks" << endl;
+    for (const auto &t: configs) {
+        file << t.maxVertices << "," << t.config.candidates << "," << t.config.restarts << "," << t.config.kicks
+             << endl;
+    }
+    return true;
+}
+
+LocalSearchConfig Autotuner::getConfig(int n) {
+    if (tunedConfigs.empty()) return LocalSearchConfig();
+    for (const auto &t: tunedConfigs) {
+        if (n <= t.maxVertices) return t.config;
+    }
+    // larger than every class: use the largest one
+    return tunedConfigs.back().config;
+}
+
+string Autotuner::describe(const LocalSearchConfig &config) {
+    return "candidates=" + to_string(config.candidates) + " restarts=" + to_string(config.restarts) + " kicks=" +
+           to_string(config.kicks);
+}
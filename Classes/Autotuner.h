@@ -0,0 +1,125 @@
+#ifndef PROJ2_AUTOTUNER_H
+#define PROJ2_AUTOTUNER_H
+
+#include <string>
+#include <vector>
+#include "DistanceMatrix.h"
+#include "LocalSearch.h"
+
+/**
+ * @brief Tuned local search configuration for the instances up to a number of vertices
+ */
+struct TunedConfig {
+    int maxVertices;
+    LocalSearchConfig config;
+};
+
+/**
+ * @brief Tunes the local search knobs with iterated F-race
+ * @details Each iteration samples configurations around the current elites and races them: all surviving
+ * configurations run on one more training instance at a time, and once enough instances were seen the
+ * Friedman test with its post-hoc comparison drops those ranked significantly worse than the best.
+ * A run slower than the time budget counts as the worst result of its instance.
+ */
+class Autotuner {
+public:
+    /**
+     * @brief Constructs a tuner over a training set
+     * @details Time complexity: O(1)
+     * @param training Training instances, all complete
+     * @param budgetSeconds Time a single run may take
+     * @param seed Seed of the sampling and of the runs
+     */
+    Autotuner(std::vector<DistanceMatrix> training, double budgetSeconds, unsigned seed = 42);
+
+    /**
+     * @brief Runs iterated F-race
+     * @details Time complexity: O(E * R / T), where E is the number of runs, R the time of one run and T the
+     * number of threads
+     * @param maxRuns Total number of runs allowed
+     * @return The best configuration found
+     */
+    LocalSearchConfig tune(int maxRuns);
+
+    /**
+     * @brief Builds a training instance from a random subset of the vertices of a matrix
+     * @details Time complexity: O(n^2)
+     * @param m Source matrix
+     * @param n Number of vertices to keep
+     * @param rng Random number generator
+     * @return The sub-matrix
+     */
+    static DistanceMatrix sample(const DistanceMatrix &m, int n, std::mt19937 &rng);
+
+    /**
+     * @brief Loads the tuned configurations saved by saveConfigs(), replacing the current ones
+     * @details Time complexity: O(L), where L is the number of lines
+     * @param filename Configuration file
+     * @return True if the file was read
+     */
+    static bool loadConfigs(const std::string &filename);
+
+    /**
+     * @brief Saves tuned configurations as CSV (maxVertices,candidates,restarts,kicks)
+     * @details Time complexity: O(L)
+     * @param filename Output file
+     * @param configs Configurations, by increasing maxVertices
+     * @return True if the file was written
+     */
+    static bool saveConfigs(const std::string &filename, const std::vector<TunedConfig> &configs);
+
+    /**
+     * @brief Gets the configuration of the smallest size class that holds an instance
+     * @details The default configuration is used when nothing was loaded. Time complexity: O(L)
+     * @param n Number of vertices
+     * @return The configuration
+     */
+    static LocalSearchConfig getConfig(int n);
+
+    /**
+     * @brief Gets the name of a configuration, as printed in the race log
+     * @details Time complexity: O(1)
+     * @param config Configuration
+     * @return The name
+     */
+    static std::string describe(const LocalSearchConfig &config);
+
+private:
+    std::vector<DistanceMatrix> training;
+    double budgetSeconds;
+    std::mt19937 rng;
+    std::size_t nextInstance = 0;
+
+    /**
+     * @brief Races configurations until one is left, too few remain or the runs are used up
+     * @param candidates Configurations to race
+     * @param maxRuns Runs allowed in this race
+     * @param runsUsed Number of runs done, updated
+     * @return The survivors, best mean rank first
+     */
+    std::vector<LocalSearchConfig> race(const std::vector<LocalSearchConfig> &candidates, int maxRuns, int &runsUsed);
+
+    /**
+     * @brief Runs every configuration on one training instance, in parallel
+     * @param configs Configurations
+     * @param instance Index of the training instance
+     * @return The cost of each run, infinity for runs over the time budget
+     */
+    std::vector<double> evaluate(const std::vector<LocalSearchConfig> &configs, int instance);
+
+    /**
+     * @brief Samples a configuration around a parent
+     * @param parent Parent configuration
+     * @param spread Relative standard deviation of the changes
+     * @return The new configuration
+     */
+    LocalSearchConfig perturb(const LocalSearchConfig &parent, double spread);
+
+    /**
+     * @brief Samples a configuration uniformly from the parameter space
+     * @return The configuration
+     */
+    LocalSearchConfig randomConfig();
+};
+
+#endif //PROJ2_AUTOTUNER_H
@@ -0,0 +1,217 @@
+#include "Backbone.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+using namespace std;
+
+vector<vector<int>> Backbone::fixedPaths(const vector<vector<int>> &tours, int *commonEdges) {
+    vector<vector<int>> paths;
+    if (commonEdges) *commonEdges = 0;
+    if (tours.empty()) return paths;
+    int n = (int) tours[0].size();
+    if (n == 0) return paths;
+    // an edge u-v of the first tour is common if v is next to u in every other tour
+    vector<vector<int>> position(tours.size(), vector<int>(n));
+    for (size_t t = 0; t < tours.size(); t++) {
+        for (int k = 0; k < n; k++) {
+            position[t][tours[t][k]] = k;
+        }
+    }
+    auto isCommon = [&](int u, int v) {
+        for (size_t t = 1; t < tours.size(); t++) {
+            int gap = abs(position[t][u] - position[t][v]);
+            if (gap != 1 && gap != n - 1) return false;
+        }
+        return true;
+    };
+    const vector<int> &first = tours[0];
+    vector<bool> commonNext(n);
+    int numCommon = 0;
+    for (int k = 0; k < n; k++) {
+        commonNext[k] = n > 1 && isCommon(first[k], first[(k + 1) % n]);
+        if (commonNext[k]) numCommon++;
+    }
+    if (commonEdges) *commonEdges = numCommon;
+    if (numCommon == n) {
+        paths.push_back(first);
+        return paths;
+    }
+
+    // the common edges are all edges of the first tour, so the paths are its runs of common edges; start
+    // right after an edge that is not common
+    int begin = 0;
+    while (commonNext[(begin + n - 1) % n]) begin++;
+    vector<int> path;
+    for (int i = 0; i < n; i++) {
+        int k = (begin + i) % n;
+        path.push_back(first[k]);
+        if (!commonNext[k]) {
+            paths.push_back(path);
+            path.clear();
+        }
+    }
+    return paths;
+}
+
+Cost Backbone::solveContracted(const DistanceMatrix &m, const vector<vector<int>> &paths, vector<int> &tour,
+                               const CancellationToken *cancel) {
+    tour.clear();
+    const Cost inf = INFINITE_COST;
+    int s = (int) paths.size();
+    if (s == 0 || s > MAX_SUPER_NODES) return inf;
+
+    // a super-node in direction 0 is entered at the front of its path and left at the back, in direction 1
+    // the other way around
+    vector<Cost> inner(2 * s, 0);
+    auto add = [&](Cost &total, Weight w) { total = total == inf || w == MISSING_WEIGHT ? inf : total + w; };
+    for (int i = 0; i < s; i++) {
+        const vector<int> &p = paths[i];
+        for (size_t k = 1; k < p.size(); k++) {
+            add(inner[2 * i], m.at(p[k - 1], p[k]));
+            add(inner[2 * i + 1], m.at(p[k], p[k - 1]));
+        }
+    }
+    auto entry = [&](int node) { return node % 2 == 0 ? paths[node / 2].front() : paths[node / 2].back(); };
+    auto exit = [&](int node) { return node % 2 == 0 ? paths[node / 2].back() : paths[node / 2].front(); };
+    if (s == 1) {
+        if (inner[0] == inf || m.at(exit(0), entry(0)) == MISSING_WEIGHT) return inf;
+        tour = paths[0];
+        return tour.size() == 1 ? 0 : inner[0] + m.at(exit(0), entry(0));
+    }
+
+    // the first super-node is the start, in either direction; bit i-1 of a mask stands for super-node i and a
+    // state is a mask and the last super-node with its direction
+    int k = s - 1;
+    size_t numMasks = (size_t) 1 << k;
+    int width = 2 * k;
+    vector<Cost> cost(numMasks * width);
+    vector<int8_t> parent(numMasks * width);
+    Cost best = inf;
+    CancellationCheck stop(cancel);
+    for (int startDirection = 0; startDirection < (paths[0].size() > 1 ? 2 : 1); startDirection++) {
+        if (inner[startDirection] == inf) continue;
+        fill(cost.begin(), cost.end(), inf);
+        fill(parent.begin(), parent.end(), (int8_t) -1);
+        int start = startDirection;
+        for (int node = 0; node < width; node++) {
+            if (node % 2 == 1 && paths[node / 2 + 1].size() == 1) continue;
+            Weight w = m.at(exit(start), entry(node + 2));
+            if (w == MISSING_WEIGHT || inner[node + 2] == inf) continue;
+            cost[((size_t) 1 << (node / 2)) * width + node] = inner[start] + w + inner[node + 2];
+        }
+        for (size_t mask = 1; mask < numMasks; mask++) {
+            if (stop.step()) {
+                tour.clear();
+                return inf;
+            }
+            for (int last = 0; last < width; last++) {
+                Cost current = cost[mask * width + last];
+                if (current == inf) continue;
+                for (int next = 0; next < width; next++) {
+                    if ((mask & ((size_t) 1 << (next / 2))) || inner[next + 2] == inf) continue;
+                    if (next % 2 == 1 && paths[next / 2 + 1].size() == 1) continue;
+                    Weight w = m.at(exit(last + 2), entry(next + 2));
+                    if (w == MISSING_WEIGHT) continue;
+                    Cost candidate = current + w + inner[next + 2];
+                    size_t state = (mask | ((size_t) 1 << (next / 2))) * width + next;
+                    if (candidate < cost[state]) {
+                        cost[state] = candidate;
+                        parent[state] = (int8_t) last;
+                    }
+                }
+            }
+        }
+
+        size_t full = numMasks - 1;
+        int bestLast = -1;
+        Cost bestCost = inf;
+        for (int last = 0; last < width; last++) {
+            Cost current = cost[full * width + last];
+            Weight w = m.at(exit(last + 2), entry(start));
+            if (current == inf || w == MISSING_WEIGHT) continue;
+            if (current + w < bestCost) {
+                bestCost = current + w;
+                bestLast = last;
+            }
+        }
+        if (bestLast == -1 || bestCost >= best) continue;
+        best = bestCost;
+
+        // walk the parents back, then expand every super-node into its path
+        vector<int> nodes;
+        size_t mask = full;
+        for (int last = bestLast; last != -1;) {
+            nodes.push_back(last + 2);
+            int previous = parent[mask * width + last];
+            mask &= ~((size_t) 1 << (last / 2));
+            last = previous;
+        }
+        nodes.push_back(start);
+        std::reverse(nodes.begin(), nodes.end());
+        tour.clear();
+        for (int node: nodes) {
+            const vector<int> &p = paths[node / 2];
+            if (node % 2 == 0) {
+                tour.insert(tour.end(), p.begin(), p.end());
+            } else {
+                tour.insert(tour.end(), p.rbegin(), p.rend());
+            }
+        }
+    }
+    return best;
+}
+
+vector<int> Backbone::solve(const DistanceMatrix &m, int runs, const LocalSearchConfig &config, unsigned seed,
+                            BackboneReport *report, const CancellationToken *cancel) {
+    BackboneReport local;
+    BackboneReport &r = report ? *report : local;
+    r = BackboneReport();
+    int n = m.size();
+    if (n == 0) return {};
+    runs = max(runs, 2);
+    r.runs = runs;
+
+    auto begin = chrono::steady_clock::now();
+    vector<pair<Cost, vector<int>>> tours;
+    for (int k = 0; k < runs; k++) {
+        if (k > 0 && cancel && cancel->isCancelled()) break;
+        // starts spread over the vertices, so the constructions differ
+        vector<int> tour = LocalSearch::solve(m, (int) ((long long) k * n / runs), config, seed + (unsigned) k,
+                                              cancel);
+        Cost cost = m.tourCost(tour);
+        tours.emplace_back(cost, tour);
+    }
+    sort(tours.begin(), tours.end(), [](const pair<Cost, vector<int>> &a, const pair<Cost, vector<int>> &b) {
+        return a.first < b.first;
+    });
+    r.heuristicCost = tours[0].first;
+    r.heuristicSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    // cancelled during the runs: too few tours to agree on anything
+    if ((int) tours.size() < runs) {
+        r.runs = (int) tours.size();
+        return tours[0].second;
+    }
+
+    // the better half of the runs, which leaves out the tours stuck far from the others; if they agree on too
+    // few edges for the exact solver, fewer of the best tours are intersected, down to two
+    vector<vector<int>> paths;
+    for (r.goodTours = max(2, runs / 2); r.goodTours >= 2; r.goodTours--) {
+        vector<vector<int>> good;
+        for (int k = 0; k < r.goodTours; k++) {
+            good.push_back(tours[k].second);
+        }
+        paths = fixedPaths(good, &r.fixedEdges);
+        if ((int) paths.size() <= MAX_SUPER_NODES || r.goodTours == 2) break;
+    }
+    r.superNodes = (int) paths.size();
+    r.reduction = (double) r.superNodes / n;
+
+    begin = chrono::steady_clock::now();
+    vector<int> tour;
+    Cost cost = solveContracted(m, paths, tour, cancel);
+    r.exactSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    r.solved = cost != INFINITE_COST;
+    if (!r.solved || cost > r.heuristicCost) return tours[0].second;
+    return tour;
+}
@@ -0,0 +1,82 @@
+#ifndef PROJ2_BACKBONE_H
+#define PROJ2_BACKBONE_H
+
+#include <vector>
+#include "DistanceMatrix.h"
+#include "LocalSearch.h"
+#include "Cancellation.h"
+
+/**
+ * @brief What a backbone solve did, see Backbone::solve()
+ */
+struct BackboneReport {
+    int runs = 0;                   // local search runs
+    int goodTours = 0;              // runs whose edges were intersected
+    int fixedEdges = 0;             // edges common to all the good tours
+    int superNodes = 0;             // vertices of the contracted instance
+    double reduction = 0.0;         // super-nodes over vertices
+    bool solved = false;            // false if the contracted instance was too large for the exact solver
+    Cost heuristicCost = INFINITE_COST; // best tour of the runs
+    double heuristicSeconds = 0.0;
+    double exactSeconds = 0.0;
+};
+
+/**
+ * @brief Backbone edge fixing: the edges that all good tours agree on are fixed, and the exact solver only
+ * decides how to join the paths they form
+ * @details Each fixed path is contracted into a super-node entered at one end and left at the other, in either
+ * direction, so the exact search runs over the super-nodes instead of the vertices. The result is the best tour
+ * that keeps every fixed edge, which is the optimum whenever the optimum has them all, as it usually does when
+ * the good tours are close to it.
+ */
+class Backbone {
+public:
+    /** Largest contracted instance the exact solver accepts (its memory grows as 2^s * s) */
+    static const int MAX_SUPER_NODES = 18;
+
+    /**
+     * @brief Finds the paths formed by the edges common to all tours
+     * @details Every vertex is in exactly one path, vertices without a common edge in a path of their own.
+     * When the tours are all the same cycle it is returned as a single path. Time complexity: O(n * T), where T
+     * is the number of tours
+     * @param tours Tours of the same matrix indices, without repeating the first vertex
+     * @param commonEdges Set to the number of edges common to all tours, if not null
+     * @return The paths, as matrix indices from one end to the other
+     */
+    static std::vector<std::vector<int>> fixedPaths(const std::vector<std::vector<int>> &tours,
+                                                    int *commonEdges = nullptr);
+
+    /**
+     * @brief Finds the best tour that traverses every path from one end to the other
+     * @details Held-Karp dynamic programming over the paths, where the state also holds the direction the last
+     * path was traversed in. Time complexity: O(2^s * s^2), memory O(2^s * s), where s is the number of paths
+     * @param m Distance matrix
+     * @param paths Paths covering every vertex once, at most MAX_SUPER_NODES of them
+     * @param tour Vector to store the tour, as matrix indices starting at the first path
+     * @param cancel Token that stops the search, or null
+     * @return The cost of the tour, or INFINITE_COST if there are too many paths, no tour or the search was
+     * cancelled
+     */
+    static Cost solveContracted(const DistanceMatrix &m, const std::vector<std::vector<int>> &paths,
+                                std::vector<int> &tour, const CancellationToken *cancel = nullptr);
+
+    /**
+     * @brief Runs local search from spread-out starts, fixes the edges common to the better half of the tours
+     * and solves the contracted instance exactly
+     * @details When the better half leaves more than MAX_SUPER_NODES paths, fewer of the best tours are
+     * intersected, down to two. When cancelled, the best tour of the runs so far is returned. Time complexity:
+     * that of the runs, plus O(2^s * s^2) for the exact solve
+     * @param m Distance matrix
+     * @param runs Number of local search runs, at least 2
+     * @param config Knobs of each run
+     * @param seed Seed of the first run, the others use the next seeds
+     * @param report Report to fill in, if not null
+     * @param cancel Token that stops the runs and the exact solve, or null
+     * @return The tour, the best heuristic one if the contracted instance was too large
+     */
+    static std::vector<int> solve(const DistanceMatrix &m, int runs, const LocalSearchConfig &config,
+                                  unsigned seed, BackboneReport *report = nullptr,
+                                  const CancellationToken *cancel = nullptr);
+};
+
+#endif //PROJ2_BACKBONE_H
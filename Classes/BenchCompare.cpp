@@ -0,0 +1,89 @@
+#include "BenchCompare.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+double BenchCompare::median(vector<double> samples) {
+    if (samples.empty()) return 0.0;
+    size_t middle = samples.size() / 2;
+    nth_element(samples.begin(), samples.begin() + (ptrdiff_t) middle, samples.end());
+    double upper = samples[middle];
+    if (samples.size() % 2 == 1) return upper;
+    double lower = *max_element(samples.begin(), samples.begin() + (ptrdiff_t) middle);
+    return (lower + upper) / 2;
+}
+
+double BenchCompare::mannWhitney(const vector<double> &a, const vector<double> &b) {
+    if (a.empty() || b.empty()) return 1.0;
+    // rank the pooled samples, ties getting the mean of their ranks
+    vector<pair<double, int>> pooled;
+    for (double x: a) pooled.emplace_back(x, 0);
+    for (double x: b) pooled.emplace_back(x, 1);
+    sort(pooled.begin(), pooled.end());
+    double n1 = (double) a.size(), n2 = (double) b.size(), n = n1 + n2;
+    double rankSum = 0.0, tieTerm = 0.0;
+    for (size_t i = 0; i < pooled.size();) {
+        size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first) j++;
+        double rank = (double) (i + j + 1) / 2;  // ranks i+1 .. j
+        for (size_t k = i; k < j; k++) {
+            if (pooled[k].second == 0) rankSum += rank;
+        }
+        double t = (double) (j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+    double u = rankSum - n1 * (n1 + 1) / 2;
+    double mean = n1 * n2 / 2;
+    double variance = n1 * n2 / 12 * ((n + 1) - tieTerm / (n * (n - 1)));
+    if (variance <= 0) return 1.0;
+    double z = max(0.0, fabs(u - mean) - 0.5) / sqrt(variance);
+    return erfc(z / sqrt(2.0));
+}
+
+pair<double, double> BenchCompare::bootstrapRatio(const vector<double> &a, const vector<double> &b,
+                                                  double confidence, int resamples, mt19937 &rng) {
+    if (a.empty() || b.empty() || resamples <= 0) return {1.0, 1.0};
+    uniform_int_distribution<size_t> pickA(0, a.size() - 1), pickB(0, b.size() - 1);
+    vector<double> ratios, resampleA(a.size()), resampleB(b.size());
+    ratios.reserve(resamples);
+    for (int r = 0; r < resamples; r++) {
+        for (double &x: resampleA) x = a[pickA(rng)];
+        for (double &x: resampleB) x = b[pickB(rng)];
+        double base = median(resampleA);
+        if (base != 0) ratios.push_back(median(resampleB) / base);
+    }
+    if (ratios.empty()) return {1.0, 1.0};
+    sort(ratios.begin(), ratios.end());
+    double tail = (1 - confidence) / 2;
+    auto at = [&](double fraction) { return ratios[(size_t) (fraction * (double) (ratios.size() - 1))]; };
+    return {at(tail), at(1 - tail)};
+}
+
+vector<CaseComparison> BenchCompare::compare(const vector<BenchmarkCase> &baseline,
+                                             const vector<BenchmarkCase> &candidate, double alpha,
+                                             double threshold) {
+    vector<CaseComparison> comparisons;
+    mt19937 rng(42);
+    for (const auto &b: baseline) {
+        auto c = find_if(candidate.begin(), candidate.end(),
+                         [&](const BenchmarkCase &x) { return x.name == b.name; });
+        if (c == candidate.end()) continue;
+        CaseComparison result;
+        result.name = b.name;
+        result.unit = b.unit;
+        result.baselineMedian = median(b.samples);
+        result.candidateMedian = median(c->samples);
+        result.ratio = result.baselineMedian != 0 ? result.candidateMedian / result.baselineMedian : 1.0;
+        tie(result.ratioLow, result.ratioHigh) = bootstrapRatio(b.samples, c->samples, 1 - alpha, 2000, rng);
+        result.pValue = mannWhitney(b.samples, c->samples);
+        bool large = fabs(result.ratio - 1) >= threshold;
+        if (result.pValue < alpha && large && (result.ratioLow > 1 || result.ratioHigh < 1)) {
+            bool increased = result.ratioLow > 1;
+            result.verdict = increased == b.higherIsBetter ? 1 : -1;
+        }
+        comparisons.push_back(result);
+    }
+    return comparisons;
+}
@@ -0,0 +1,80 @@
+#ifndef PROJ2_BENCHCOMPARE_H
+#define PROJ2_BENCHCOMPARE_H
+
+#include <vector>
+#include <string>
+#include <random>
+#include "Benchmark.h"
+
+/**
+ * @brief Comparison of one case between two benchmark results
+ */
+struct CaseComparison {
+    std::string name;
+    std::string unit;
+    double baselineMedian = 0.0;
+    double candidateMedian = 0.0;
+    double ratio = 1.0;      // candidate median over baseline median
+    double ratioLow = 1.0;   // bootstrap confidence interval of the ratio
+    double ratioHigh = 1.0;
+    double pValue = 1.0;     // two-sided Mann-Whitney U test
+    int verdict = 0;         // 1 for a significant improvement, -1 for a significant regression, 0 otherwise
+};
+
+/**
+ * @brief Statistics that tell a real performance change from run-to-run noise
+ * @details Benchmark timings are skewed and often have outliers, so the comparison relies on ranks and
+ * resampling instead of means: a Mann-Whitney U test for whether the candidate differs at all, and a bootstrap
+ * interval of the ratio of medians for how much.
+ */
+class BenchCompare {
+public:
+    /**
+     * @brief Computes the two-sided p-value of the Mann-Whitney U test
+     * @details Uses the normal approximation with tie and continuity corrections, which is accurate from about
+     * 8 runs per side. Time complexity: O((a + b)log(a + b))
+     * @param a Samples of the first group
+     * @param b Samples of the second group
+     * @return The p-value, 1 if a group is empty
+     */
+    static double mannWhitney(const std::vector<double> &a, const std::vector<double> &b);
+
+    /**
+     * @brief Computes a percentile bootstrap confidence interval of median(b) / median(a)
+     * @details Time complexity: O(R * (a + b)), where R is the number of resamples
+     * @param a Samples of the baseline
+     * @param b Samples of the candidate
+     * @param confidence Confidence level, e.g. 0.95
+     * @param resamples Number of resamples
+     * @param rng Random number generator
+     * @return The lower and upper ends of the interval
+     */
+    static std::pair<double, double> bootstrapRatio(const std::vector<double> &a, const std::vector<double> &b,
+                                                    double confidence, int resamples, std::mt19937 &rng);
+
+    /**
+     * @brief Compares the cases present in both results
+     * @details A change is significant when the p-value is below alpha, the interval of the ratio excludes 1
+     * and the ratio differs from 1 by at least the threshold. The bootstrap is seeded, so the same files always
+     * give the same report. Time complexity: O(C * R * S), where C is the number of cases, R the number of
+     * resamples and S the number of samples per case
+     * @param baseline Cases of the baseline
+     * @param candidate Cases of the candidate
+     * @param alpha Significance level
+     * @param threshold Smallest relative change counted as significant, e.g. 0.05
+     * @return One comparison per matching case, in the order of the baseline
+     */
+    static std::vector<CaseComparison> compare(const std::vector<BenchmarkCase> &baseline,
+                                               const std::vector<BenchmarkCase> &candidate, double alpha,
+                                               double threshold);
+
+    /**
+     * @brief Computes the median of some samples
+     * @details Time complexity: O(n)
+     * @param samples Samples, copied
+     * @return The median, 0 if there are none
+     */
+    static double median(std::vector<double> samples);
+};
+
+#endif //PROJ2_BENCHCOMPARE_H
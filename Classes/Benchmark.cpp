@@ -0,0 +1,598 @@
+#include "Benchmark.h"
+#include <random>
+#include <algorithm>
+#include <limits>
+#include <iomanip>
+#include <memory>
+#include <thread>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include "TourEvaluator.h"
+#include "ThreadPool.h"
+#include "SolveScheduler.h"
+
+using namespace std;
+
+Benchmark::Benchmark(TspManager &tspm, const string &dataset) : tspm(tspm), dataset(dataset) {}
+
+void Benchmark::measure(const string &name, int repetitions, const function<void(int)> &query) {
+    TraceSpan span("benchmarkQuery");
+    LatencyHistogram &histogram = results[name];
+    BenchmarkCase &latency = cases[name];
+    latency = BenchmarkCase{name, "s", false, {}};
+    BenchmarkCase &memory = cases[name + ".peakBytes"];
+    memory = BenchmarkCase{name + ".peakBytes", "B", false, {}};
+    for (int r = 0; r < repetitions; r++) {
+        AllocationScope alloc;
+        auto start = chrono::steady_clock::now();
+        query(r);
+        auto end = chrono::steady_clock::now();
+        histogram.record((uint64_t) chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+        latency.samples.push_back(chrono::duration<double>(end - start).count());
+        memory.samples.push_back((double) alloc.getStats().peakLiveBytes);
+    }
+    if (!AllocationScope::isEnabled()) cases.erase(name + ".peakBytes");
+}
+
+void Benchmark::runLoader(int repetitions) {
+    BenchmarkCase &time = cases["load"];
+    time = BenchmarkCase{"load", "s", false, {}};
+    BenchmarkCase &throughput = cases["loadThroughput"];
+    throughput = BenchmarkCase{"loadThroughput", "edges/s", true, {}};
+    for (int r = 0; r < repetitions; r++) {
+        auto start = chrono::steady_clock::now();
+        Data d(dataset);
+        chrono::duration<double> seconds = chrono::steady_clock::now() - start;
+        size_t edges = 0;
+        for (auto v: d.getGraph().getVertexSet()) {
+            edges += v->getAdj().size();
+        }
+        time.samples.push_back(seconds.count());
+        throughput.samples.push_back(seconds.count() > 0 ? (double) edges / seconds.count() : 0.0);
+    }
+}
+
+void Benchmark::runLatency(int repetitions, unsigned seed) {
+    int n = tspm.getNumVertex();
+    if (n == 0) {
+        cout << "Graph is empty" << endl;
+        return;
+    }
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pickNode(0, n - 1);
+    vector<int> starts(repetitions), targets(repetitions);
+    for (int r = 0; r < repetitions; r++) {
+        starts[r] = pickNode(rng);
+        targets[r] = pickNode(rng);
+    }
+
+    vector<int> tour;
+    measure("nearestNeighbour", repetitions, [&](int r) { tspm.nearestNeighbourTour(starts[r], tour); });
+    measure("mstApproximation", repetitions, [&](int r) { tspm.mstApproximationTour(starts[r], tour); });
+    measure("dijkstra", repetitions, [&](int r) { tspm.shortestPathDistance(starts[r], targets[r]); });
+    measure("primMST", repetitions, [&](int) { tspm.primMstWeight(); });
+    measure("kruskalMST", repetitions, [&](int r) { tspm.kruskalMstWeight(starts[r]); });
+    // the exact search is only repeated a few times, and only on toy-sized graphs
+    if (n <= 10) {
+        measure("backtracking", min(repetitions, 10), [&](int) { tspm.backtrackingTour(tour); });
+    }
+}
+
+void Benchmark::print() const {
+    cout << "Latency of " << dataset << ":" << endl;
+    for (const auto &result: results) {
+        result.second.print(result.first);
+    }
+}
+
+bool Benchmark::save(const string &filename) const {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        cerr << "There was an error opening file " << filename << endl;
+        return false;
+    }
+    file << "dataset " << dataset << "\n";
+    for (const auto &result: results) {
+        file << "query " << result.first << "\n";
+        result.second.write(file);
+    }
+    return true;
+}
+
+bool Benchmark::load(const string &filename, map<string, LatencyHistogram> &results) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "There was an error opening file " << filename << endl;
+        return false;
+    }
+    string tag, name;
+    if (!(file >> tag >> name) || tag != "dataset") return false;
+    while (file >> tag >> name) {
+        if (tag != "query" || !results[name].read(file)) return false;
+    }
+    return true;
+}
+
+bool Benchmark::saveJson(const string &filename) const {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        cerr << "There was an error opening file " << filename << endl;
+        return false;
+    }
+    // names are plain identifiers, so they are written without escaping
+    file << "{\n  \"dataset\": \"" << dataset << "\",\n  \"cases\": [";
+    file << setprecision(17);
+    bool firstCase = true;
+    for (const auto &entry: cases) {
+        const BenchmarkCase &c = entry.second;
+        file << (firstCase ? "" : ",") << "\n    {\"name\": \"" << c.name << "\", \"unit\": \"" << c.unit
+             << "\", \"better\": \"" << (c.higherIsBetter ? "higher" : "lower") << "\", \"samples\": [";
+        for (size_t i = 0; i < c.samples.size(); i++) {
+            file << (i == 0 ? "" : ", ") << c.samples[i];
+        }
+        file << "]}";
+        firstCase = false;
+    }
+    file << "\n  ]\n}\n";
+    return true;
+}
+
+namespace {
+    /**
+     * @brief Reader of the JSON written by Benchmark::saveJson(): objects, arrays, strings and numbers
+     */
+    class JsonReader {
+    public:
+        explicit JsonReader(const string &text) : text(text) {}
+
+        bool consume(char c) {
+            skipSpaces();
+            if (pos < text.size() && text[pos] == c) {
+                pos++;
+                return true;
+            }
+            return false;
+        }
+
+        bool peek(char c) {
+            skipSpaces();
+            return pos < text.size() && text[pos] == c;
+        }
+
+        bool readString(string &value) {
+            if (!consume('"')) return false;
+            value.clear();
+            while (pos < text.size() && text[pos] != '"') {
+                if (text[pos] == '\\' && pos + 1 < text.size()) pos++;
+                value.push_back(text[pos++]);
+            }
+            return consume('"');
+        }
+
+        bool readNumber(double &value) {
+            skipSpaces();
+            const char *begin = text.c_str() + pos;
+            char *end;
+            value = strtod(begin, &end);
+            if (end == begin) return false;
+            pos += (size_t) (end - begin);
+            return true;
+        }
+
+        /**
+         * @brief Reads an object, handing each key to a callback that reads its value
+         * @param member Callback, returning false on a malformed value
+         * @return True if the object was read
+         */
+        bool readObject(const function<bool(const string &)> &member) {
+            if (!consume('{')) return false;
+            if (consume('}')) return true;
+            do {
+                string key;
+                if (!readString(key) || !consume(':') || !member(key)) return false;
+            } while (consume(','));
+            return consume('}');
+        }
+
+        /**
+         * @brief Reads an array, handing each element to a callback that reads it
+         * @param element Callback, returning false on a malformed element
+         * @return True if the array was read
+         */
+        bool readArray(const function<bool()> &element) {
+            if (!consume('[')) return false;
+            if (consume(']')) return true;
+            do {
+                if (!element()) return false;
+            } while (consume(','));
+            return consume(']');
+        }
+
+        /**
+         * @brief Skips a value of a field that is not used
+         * @return True if the value was read
+         */
+        bool skipValue() {
+            string ignored;
+            double number;
+            if (peek('"')) return readString(ignored);
+            if (peek('{')) return readObject([&](const string &) { return skipValue(); });
+            if (peek('[')) return readArray([&]() { return skipValue(); });
+            if (readNumber(number)) return true;
+            // true, false and null
+            while (pos < text.size() && isalpha((unsigned char) text[pos])) pos++;
+            return true;
+        }
+
+    private:
+        const string &text;
+        size_t pos = 0;
+
+        void skipSpaces() {
+            while (pos < text.size() && isspace((unsigned char) text[pos])) pos++;
+        }
+    };
+}
+
+bool Benchmark::loadJson(const string &filename, string &dataset, vector<BenchmarkCase> &cases) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "There was an error opening file " << filename << endl;
+        return false;
+    }
+    stringstream buffer;
+    buffer << file.rdbuf();
+    string text = buffer.str();
+    JsonReader reader(text);
+    cases.clear();
+    bool ok = reader.readObject([&](const string &key) {
+        if (key == "dataset") return reader.readString(dataset);
+        if (key != "cases") return reader.skipValue();
+        return reader.readArray([&]() {
+            BenchmarkCase c;
+            bool read = reader.readObject([&](const string &field) {
+                if (field == "name") return reader.readString(c.name);
+                if (field == "unit") return reader.readString(c.unit);
+                if (field == "better") {
+                    string better;
+                    if (!reader.readString(better)) return false;
+                    c.higherIsBetter = better == "higher";
+                    return true;
+                }
+                if (field == "samples") {
+                    return reader.readArray([&]() {
+                        double value;
+                        if (!reader.readNumber(value)) return false;
+                        c.samples.push_back(value);
+                        return true;
+                    });
+                }
+                return reader.skipValue();
+            });
+            cases.push_back(c);
+            return read;
+        });
+    });
+    if (!ok) cerr << "File " << filename << " is not a benchmark result" << endl;
+    return ok;
+}
+
+const map<string, LatencyHistogram> &Benchmark::getResults() const {
+    return results;
+}
+
+double Benchmark::fitExponent(const vector<pair<double, double>> &points) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int count = 0;
+    for (const auto &p: points) {
+        if (p.first <= 0 || p.second <= 0) continue;
+        double x = log(p.first), y = log(p.second);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        count++;
+    }
+    double denominator = count * sxx - sx * sx;
+    if (count < 2 || denominator == 0) return numeric_limits<double>::quiet_NaN();
+    return (count * sxy - sx * sy) / denominator;
+}
+
+void Benchmark::scalingReport(const vector<string> &datasets, int repetitions, double budgetSeconds) {
+    struct ScalingCase {
+        string name;
+        string documented;
+        double exponent; // documented complexity as n^exponent * log(n)^logFactor on a fully connected graph
+        int logFactor;
+        function<void(TspManager &)> run;
+    };
+    vector<int> tour;
+    vector<ScalingCase> cases = {
+            {"nearestNeighbour", "O(V^2)",       2.0, 0, [&](TspManager &t) { t.nearestNeighbourTour(0, tour); }},
+            {"mstApproximation", "O(V^2)",       2.0, 0, [&](TspManager &t) { t.mstApproximationTour(0, tour); }},
+            {"primMST",          "O(ElogV)",     2.0, 1, [&](TspManager &t) { t.primMstWeight(); }},
+            {"kruskalMST",       "O(ElogE)",     2.0, 1, [&](TspManager &t) { t.kruskalMstWeight(0); }},
+            {"dijkstra",         "O((V+E)logV)", 2.0, 1, [&](TspManager &t) { t.shortestPathDistance(0, 1); }},
+    };
+    map<string, vector<ScalingPoint>> points;
+    map<string, bool> dropped;
+
+    for (const string &dataset: datasets) {
+        Data d = Data(dataset);
+        TspManager tspm(d);
+        int n = tspm.getNumVertex();
+        if (n < 2) {
+            cout << "Skipping " << dataset << ": could not be loaded" << endl;
+            continue;
+        }
+        cout << "n=" << n << ":";
+        for (const auto &c: cases) {
+            if (dropped[c.name]) continue;
+            vector<double> times;
+            long long peak = 0;
+            for (int r = 0; r < repetitions; r++) {
+                AllocationScope alloc;
+                auto start = chrono::steady_clock::now();
+                c.run(tspm);
+                chrono::duration<double> duration = chrono::steady_clock::now() - start;
+                times.push_back(duration.count());
+                peak = max(peak, alloc.getStats().peakLiveBytes);
+            }
+            sort(times.begin(), times.end());
+            double median = times[times.size() / 2];
+            points[c.name].push_back({n, median, peak});
+            cout << " " << c.name << "=" << fixed << setprecision(4) << median << "s";
+            if (median > budgetSeconds) dropped[c.name] = true;
+        }
+        cout << endl;
+    }
+
+    cout << endl << left << setw(18) << "algorithm" << setw(14) << "documented" << right << setw(10) << "time k"
+         << setw(10) << "memory k" << "  verdict" << endl;
+    for (const auto &c: cases) {
+        const auto &series = points[c.name];
+        // small instances are dominated by constant overheads, fit on n >= 100 when there is enough data
+        vector<pair<double, double>> time, memory, residual;
+        bool enoughLarge = count_if(series.begin(), series.end(), [](const ScalingPoint &p) { return p.n >= 100; }) >= 3;
+        for (const auto &p: series) {
+            if (enoughLarge && p.n < 100) continue;
+            double model = pow(p.n, c.exponent) * pow(log(p.n), c.logFactor);
+            time.push_back(make_pair(p.n, p.seconds));
+            memory.push_back(make_pair(p.n, (double) p.peakBytes));
+            residual.push_back(make_pair(p.n, p.seconds / model));
+        }
+        double timeExponent = fitExponent(time);
+        double memoryExponent = AllocationScope::isEnabled() ? fitExponent(memory) : numeric_limits<double>::quiet_NaN();
+        // time divided by the documented complexity should stay flat; a growing ratio means extra work per step
+        double residualExponent = fitExponent(residual);
+        string verdict = "ok";
+        if (std::isnan(timeExponent)) verdict = "not enough sizes";
+        else if (residualExponent > 0.3) verdict = "EXCEEDS documented complexity";
+
+        cout << left << setw(18) << c.name << setw(14) << c.documented << right << fixed << setprecision(2)
+             << setw(10) << timeExponent << setw(10);
+        if (std::isnan(memoryExponent)) cout << "n/a";
+        else cout << memoryExponent;
+        cout << "  " << verdict;
+        if (dropped[c.name]) cout << " (over budget after n=" << series.back().n << ")";
+        cout << endl;
+    }
+    if (!AllocationScope::isEnabled()) {
+        cout << "Configure with -DPROJ2_TRACK_ALLOCATIONS=ON to measure memory growth." << endl;
+    }
+}
+
+bool Benchmark::calibrate(const vector<string> &datasets, const string &filename, double budgetSeconds) {
+    vector<CalibrationEntry> entries;
+    map<Pipeline, bool> dropped;
+    for (const string &dataset: datasets) {
+        Data d = Data(dataset);
+        TspManager tspm(d);
+        InstanceFeatures features = tspm.getInstanceFeatures();
+        if (features.n < 2) {
+            cout << "Skipping " << dataset << ": could not be loaded" << endl;
+            continue;
+        }
+        // build the matrix up front so that it is not charged to the first pipeline
+        if (features.n <= AlgorithmSelector::MAX_MATRIX_VERTICES) tspm.getDistanceMatrix();
+
+        vector<CalibrationEntry> measured;
+        double best = numeric_limits<double>::infinity();
+        vector<int> tour;
+        for (Pipeline p: AlgorithmSelector::getPipelines()) {
+            if (dropped[p] || !AlgorithmSelector::isFeasible(p, features)) continue;
+            auto start = chrono::steady_clock::now();
+            double cost = tspm.runPipeline(p, tour);
+            chrono::duration<double> duration = chrono::steady_clock::now() - start;
+            measured.push_back({p, features.n, duration.count(), cost});
+            best = min(best, cost);
+            if (duration.count() > budgetSeconds) dropped[p] = true;
+        }
+        cout << dataset << " (n=" << features.n << "):";
+        for (auto &e: measured) {
+            e.costRatio = best > 0 ? e.costRatio / best : 1.0;
+            cout << " " << AlgorithmSelector::getName(e.pipeline) << "=" << fixed << setprecision(4) << e.seconds
+                 << "s/" << setprecision(3) << e.costRatio;
+            entries.push_back(e);
+        }
+        cout << endl;
+    }
+    return AlgorithmSelector::saveCalibration(filename, entries);
+}
+
+void Benchmark::tourEvaluation(const DistanceMatrix &m, int numTours, unsigned numThreads, int repetitions) {
+    int n = m.size();
+    if (n == 0) {
+        cout << "Graph is empty" << endl;
+        return;
+    }
+    mt19937 rng(42);
+    vector<vector<int>> tours(numTours);
+    for (auto &tour: tours) {
+        tour.resize(n);
+        for (int i = 0; i < n; i++) {
+            tour[i] = i;
+        }
+        shuffle(tour.begin(), tour.end(), rng);
+    }
+    double hops = (double) numTours * n;
+
+    vector<Cost> expected(tours.size()), costs;
+    auto best = [&](const function<void()> &run) {
+        double fastest = numeric_limits<double>::infinity();
+        for (int r = 0; r < repetitions; r++) {
+            auto start = chrono::steady_clock::now();
+            run();
+            chrono::duration<double> duration = chrono::steady_clock::now() - start;
+            fastest = min(fastest, duration.count());
+        }
+        return fastest;
+    };
+    double scalar = best([&]() {
+        for (size_t t = 0; t < tours.size(); t++) {
+            expected[t] = TourEvaluator::scalarTourCost(m, tours[t].data(), tours[t].size());
+        }
+    });
+    ThreadPool alone(0);
+    double single = best([&]() { TourEvaluator::evaluate(m, tours, costs, alone); });
+    bool match = true;
+    for (size_t t = 0; t < tours.size(); t++) {
+        // the gathers add the hops of a double tour in another order
+        match = match && (costs[t] == expected[t] || (double) abs(costs[t] - expected[t]) <= 1e-9 * (double) expected[t]);
+    }
+    unique_ptr<ThreadPool> own;
+    if (numThreads > 0) own.reset(new ThreadPool(numThreads - 1));
+    ThreadPool &pool = numThreads > 0 ? *own : ThreadPool::shared();
+    double parallel = best([&]() { TourEvaluator::evaluate(m, tours, costs, pool); });
+
+    cout << numTours << " tours of " << n << " vertices, AVX2 gathers " << (TourEvaluator::usesGathers() ? "on" : "off")
+         << ", threads " << pool.concurrency() << endl;
+    cout << left << setw(22) << "variant" << right << setw(14) << "seconds" << setw(18) << "hops/s" << endl;
+    auto row = [&](const string &name, double seconds) {
+        cout << left << setw(22) << name << right << fixed << setprecision(6) << setw(14) << seconds
+             << setprecision(0) << setw(18) << hops / seconds << endl;
+    };
+    row("scalar", scalar);
+    row("batch, 1 thread", single);
+    row("batch, all threads", parallel);
+    if (!match) cout << "Batch costs differ from the scalar costs" << endl;
+}
+
+void Benchmark::threadPool(int numTasks, unsigned maxThreads) {
+    if (maxThreads == 0) maxThreads = max(1u, thread::hardware_concurrency());
+    auto seconds = [](const function<void()> &run) {
+        auto start = chrono::steady_clock::now();
+        run();
+        chrono::duration<double> duration = chrono::steady_clock::now() - start;
+        return duration.count();
+    };
+
+    cout << "Overhead per empty task, " << numTasks << " tasks" << endl;
+    cout << left << setw(10) << "threads" << right << setw(16) << "group ns/task" << setw(20) << "parallelFor ns/task"
+         << endl;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads - 1);
+        double group = seconds([&]() {
+            TaskGroup tasks(pool);
+            for (int t = 0; t < numTasks; t++) {
+                tasks.run([]() {});
+            }
+            tasks.wait();
+        });
+        double loop = seconds([&]() {
+            pool.parallelFor(0, (size_t) numTasks, 1, [](size_t, size_t) {});
+        });
+        cout << left << setw(10) << threads << right << fixed << setprecision(1) << setw(16) << group * 1e9 / numTasks
+             << setw(20) << loop * 1e9 / numTasks << endl;
+    }
+
+    // a loop with enough work per index for the scheduling to vanish
+    const size_t work = 1 << 24;
+    auto map = [](size_t b, size_t e) {
+        double sum = 0.0;
+        for (size_t i = b; i < e; i++) {
+            sum += sqrt((double) i);
+        }
+        return sum;
+    };
+    auto combine = [](double a, double b) { return a + b; };
+    cout << "Scaling of a parallelReduce over " << work << " square roots" << endl;
+    cout << left << setw(10) << "threads" << right << setw(14) << "seconds" << setw(12) << "speedup" << endl;
+    double base = 0.0, baseResult = 0.0;
+    for (unsigned threads = 1; threads <= maxThreads; threads++) {
+        ThreadPool pool(threads - 1);
+        double result = 0.0;
+        double time = seconds([&]() { result = pool.parallelReduce(0, work, 1 << 14, 0.0, map, combine); });
+        if (threads == 1) {
+            base = time;
+            baseResult = result;
+        }
+        cout << left << setw(10) << threads << right << fixed << setprecision(6) << setw(14) << time
+             << setprecision(2) << setw(12) << base / time << endl;
+        // the chunks are fixed, so every pool gives the same sum
+        if (result != baseResult) cout << "Sum differs from the one-thread sum" << endl;
+    }
+}
+
+void Benchmark::serveSimulation(int numRequests, unsigned numWorkers, double deadlineSeconds, double rate) {
+    mt19937 rng(42);
+    uniform_int_distribution<int> pickSize(10, 50);
+    uniform_real_distribution<double> pickCoordinate(0.0, 10000.0);
+    vector<DistanceMatrix> instances;
+    for (int r = 0; r < numRequests; r++) {
+        int n = pickSize(rng);
+        vector<double> x(n), y(n);
+        for (int i = 0; i < n; i++) {
+            x[i] = pickCoordinate(rng);
+            y[i] = pickCoordinate(rng);
+        }
+        DistanceMatrix m(n);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (i != j) m.set(i, j, toWeight(hypot(x[i] - x[j], y[i] - y[j])));
+            }
+        }
+        instances.push_back(m);
+    }
+    LocalSearchConfig config;
+    config.kicks = 50;
+
+    vector<future<ScheduledResult>> results;
+    auto start = chrono::steady_clock::now();
+    {
+        SolveScheduler scheduler(numWorkers);
+        for (int r = 0; r < numRequests; r++) {
+            if (rate > 0) this_thread::sleep_until(start + chrono::duration_cast<chrono::steady_clock::duration>(
+                    chrono::duration<double>(r / rate)));
+            results.push_back(scheduler.submit(SolveScheduler::makeSolve(instances[r], 0, config), deadlineSeconds));
+        }
+        for (auto &f: results) {
+            f.wait();
+        }
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    LatencyHistogram latency;
+    int finished = 0;
+    double gapSum = 0.0;
+    for (int r = 0; r < numRequests; r++) {
+        ScheduledResult result = results[r].get();
+        latency.record((uint64_t) (result.latencySeconds * 1e9));
+        if (result.finished) finished++;
+        // the reference is the uninterrupted solve, run after the simulation
+        auto reference = SolveScheduler::makeSolve(instances[r], 0, config);
+        while (!reference->resume(numeric_limits<long>::max())) {}
+        gapSum += toDouble(result.cost) / toDouble(reference->getCost()) - 1.0;
+    }
+    cout << numRequests << " requests, " << numWorkers << " workers, deadline " << deadlineSeconds * 1000.0
+         << " ms, " << (rate > 0 ? to_string((int) rate) + " per second" : string("all at once")) << endl;
+    latency.print("latency");
+    cout << fixed << setprecision(1) << "Finished before the deadline: " << 100.0 * finished / max(1, numRequests)
+         << "%" << endl;
+    cout << setprecision(3) << "Mean gap to the uninterrupted solve: " << 100.0 * gapSum / max(1, numRequests) << "%"
+         << endl;
+    cout << "Wall time: " << elapsed.count() << " s, throughput " << setprecision(1)
+         << numRequests / elapsed.count() << " requests/s" << endl;
+}
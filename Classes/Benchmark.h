@@ -0,0 +1,192 @@
+#ifndef PROJ2_BENCHMARK_H
+#define PROJ2_BENCHMARK_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <functional>
+#include "TspManager.h"
+#include "LatencyHistogram.h"
+
+/**
+ * @brief Time and memory of one algorithm run at one instance size
+ */
+struct ScalingPoint {
+    int n;
+    double seconds;
+    long long peakBytes;
+};
+
+/**
+ * @brief Measurements of one benchmark case, one value per run, as saved by Benchmark::saveJson()
+ */
+struct BenchmarkCase {
+    std::string name;
+    std::string unit;
+    bool higherIsBetter = false;
+    std::vector<double> samples;
+};
+
+/**
+ * @brief Benchmark harness that runs repeated queries on a loaded dataset and records their latency
+ */
+class Benchmark {
+public:
+    /**
+     * @brief Constructs a benchmark over the given manager
+     * @details Time complexity: O(1)
+     * @param tspm Manager holding the loaded graph
+     * @param dataset Name of the dataset, used in the reports
+     */
+    Benchmark(TspManager &tspm, const std::string &dataset);
+
+    /**
+     * @brief Runs every query type a number of times from random start nodes
+     * @details Queries: nearest neighbour tour, MST approximation tour, Dijkstra shortest path, Prim and
+     * Kruskal MSTs, and the backtracking tour on graphs of up to 10 vertices (at most 10 runs).
+     * Time complexity: O(R * ElogV) for the polynomial queries, where R is the number of repetitions
+     * @param repetitions Number of times each query is run
+     * @param seed Seed for the random start nodes
+     */
+    void runLatency(int repetitions, unsigned seed = 42);
+
+    /**
+     * @brief Loads the dataset a number of times and records the load time and the edges read per second
+     * @details Time complexity: O(R * (V + E)), where R is the number of repetitions
+     * @param repetitions Number of loads
+     */
+    void runLoader(int repetitions);
+
+    /**
+     * @brief Prints the latency percentiles of every query type
+     * @details Time complexity: O(Q * B), where Q is the number of query types and B the number of buckets
+     */
+    void print() const;
+
+    /**
+     * @brief Saves the histograms so that they can be compared with those of another build
+     * @details Time complexity: O(Q * B)
+     * @param filename Output file
+     * @return True if the file was written
+     */
+    bool save(const std::string &filename) const;
+
+    /**
+     * @brief Loads histograms saved by save()
+     * @details Time complexity: O(Q * B)
+     * @param filename Input file
+     * @param results Map to store the histogram of each query type
+     * @return True if the file was read
+     */
+    static bool load(const std::string &filename, std::map<std::string, LatencyHistogram> &results);
+
+    /**
+     * @brief Saves every run of every case as JSON, for the bench-compare command
+     * @details Each query type gives a case in seconds and, when allocation tracking is compiled in, one with
+     * the peak live bytes of each run; runLoader() adds the load time and throughput.
+     * Time complexity: O(C * R), where C is the number of cases and R the number of runs
+     * @param filename Output file
+     * @return True if the file was written
+     */
+    bool saveJson(const std::string &filename) const;
+
+    /**
+     * @brief Loads the cases saved by saveJson()
+     * @details Only the fields written by saveJson() are read, in any order. Time complexity: O(L), where L is
+     * the length of the file
+     * @param filename Input file
+     * @param dataset String to store the name of the dataset
+     * @param cases Vector to store the cases
+     * @return True if the file was read
+     */
+    static bool loadJson(const std::string &filename, std::string &dataset, std::vector<BenchmarkCase> &cases);
+
+    /**
+     * @brief Gets the histogram of each query type
+     * @details Time complexity: O(1)
+     * @return Map from query type to histogram
+     */
+    const std::map<std::string, LatencyHistogram> &getResults() const;
+
+    /**
+     * @brief Runs every algorithm across a ladder of datasets and compares the measured growth with the documented one
+     * @details For each algorithm the exponent k of time ~ n^k (and of peak memory, when allocation tracking
+     * is compiled in) is fitted by least squares in log-log space, and algorithms growing faster than their
+     * documented complexity on fully connected graphs are flagged. An algorithm whose median run exceeds the
+     * budget is not run on larger datasets.
+     * @param datasets Datasets in increasing size, e.g. "25" ... "900", "random1200"
+     * @param repetitions Number of runs per algorithm and size, the median is kept
+     * @param budgetSeconds Time above which an algorithm is dropped from the larger sizes
+     */
+    static void scalingReport(const std::vector<std::string> &datasets, int repetitions, double budgetSeconds);
+
+    /**
+     * @brief Fits y = c * n^k by least squares on (log n, log y)
+     * @details Time complexity: O(P), where P is the number of points
+     * @param points Pairs (n, y) with positive values
+     * @return The exponent k, or NaN with fewer than two points
+     */
+    static double fitExponent(const std::vector<std::pair<double, double>> &points);
+
+    /**
+     * @brief Measures the time and tour quality of every feasible pipeline on each dataset, for the algorithm selector
+     * @details The cost ratio of a pipeline is its tour cost divided by the best cost found on the same dataset.
+     * Pipelines are skipped on larger datasets once a run exceeds the budget
+     * @param datasets Datasets to measure, in increasing size
+     * @param filename Output calibration file
+     * @param budgetSeconds Time above which a pipeline is not run on larger datasets
+     * @return True if the calibration file was written
+     */
+    static bool calibrate(const std::vector<std::string> &datasets, const std::string &filename, double budgetSeconds);
+
+    /**
+     * @brief Measures the throughput of batch tour evaluation in hops per second
+     * @details Random tours are priced one hop at a time, with the gather kernel on one thread and with the
+     * gather kernel on every thread, and the costs are checked against each other.
+     * Time complexity: O(R * T * n), where R is the number of repetitions
+     * @param m Distance matrix
+     * @param numTours Number of tours in the batch
+     * @param numThreads Threads of the parallel run, 0 for the shared pool
+     * @param repetitions Runs of each variant, the fastest is reported
+     */
+    static void tourEvaluation(const DistanceMatrix &m, int numTours, unsigned numThreads, int repetitions = 5);
+
+    /**
+     * @brief Measures the overhead and the scaling of the thread pool
+     * @details The overhead is the time per empty task, spawned one by one into a group and through
+     * parallelFor. The scaling runs the same CPU-bound parallelReduce on pools of 1 to maxThreads threads.
+     * Time complexity: O(T + W * maxThreads), where W is the size of the CPU-bound loop
+     * @param numTasks Number of empty tasks
+     * @param maxThreads Largest pool measured, 0 for one thread per hardware thread
+     */
+    static void threadPool(int numTasks, unsigned maxThreads);
+
+    /**
+     * @brief Simulates a server answering many small routing requests with the cooperative scheduler
+     * @details Each request is a random instance of 10 to 50 points in the plane. The latency percentiles,
+     * the share of requests solved before their deadline and the gap of the answers to a full local
+     * search are reported. Time complexity: O(R * S), where S is the work of one solve
+     * @param numRequests Number of requests
+     * @param numWorkers Scheduler threads
+     * @param deadlineSeconds Deadline of each request
+     * @param rate Arrivals per second, 0 to submit every request at once
+     */
+    static void serveSimulation(int numRequests, unsigned numWorkers, double deadlineSeconds, double rate);
+
+private:
+    TspManager &tspm;
+    std::string dataset;
+    std::map<std::string, LatencyHistogram> results;
+    std::map<std::string, BenchmarkCase> cases;
+
+    /**
+     * @brief Runs a query a number of times, recording the latency of each run
+     * @details The latency and peak memory of every run are also kept for saveJson(). Time complexity: O(R * Q), where Q is the complexity of the query
+     * @param name Query type
+     * @param repetitions Number of runs
+     * @param query Function running the query once, given the run number
+     */
+    void measure(const std::string &name, int repetitions, const std::function<void(int)> &query);
+};
+
+#endif //PROJ2_BENCHMARK_H
@@ -0,0 +1,67 @@
+#include "Cancellation.h"
+#include <csignal>
+
+using namespace std;
+
+namespace {
+    atomic<CancellationToken *> interruptTarget(nullptr);
+
+    int64_t ticksNow() {
+        return (int64_t) chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    extern "C" void onInterrupt(int signal) {
+        CancellationToken *token = interruptTarget.load();
+        if (token == nullptr || token->isCancelled()) {
+            // nothing to cancel, or asked twice: end the process as if there were no handler
+            std::signal(signal, SIG_DFL);
+            std::raise(signal);
+            return;
+        }
+        token->cancel();
+    }
+}
+
+const int64_t CancellationToken::NO_DEADLINE;
+
+CancellationToken::CancellationToken() : cancelled(false), deadline(NO_DEADLINE) {}
+
+void CancellationToken::cancel() {
+    cancelled.store(true);
+}
+
+void CancellationToken::setDeadline(double seconds) {
+    if (seconds < 0) {
+        deadline.store(NO_DEADLINE);
+        return;
+    }
+    auto span = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+    deadline.store(ticksNow() + (int64_t) span.count());
+}
+
+void CancellationToken::setParent(const CancellationToken *token) {
+    parent = token;
+}
+
+void CancellationToken::reset() {
+    deadline.store(NO_DEADLINE);
+    cancelled.store(false);
+}
+
+bool CancellationToken::isCancelled() const {
+    if (cancelled.load(memory_order_relaxed)) return true;
+    int64_t until = deadline.load(memory_order_relaxed);
+    bool fired = parent != nullptr && parent->isCancelled();
+    if (!fired && (until == NO_DEADLINE || ticksNow() < until)) return false;
+    cancelled.store(true, memory_order_relaxed);
+    return true;
+}
+
+InterruptScope::InterruptScope(CancellationToken &token) : previousToken(interruptTarget.exchange(&token)) {
+    previousHandler = std::signal(SIGINT, onInterrupt);
+}
+
+InterruptScope::~InterruptScope() {
+    std::signal(SIGINT, previousHandler == SIG_ERR ? SIG_DFL : previousHandler);
+    interruptTarget.store(previousToken);
+}
@@ -0,0 +1,148 @@
+#ifndef PROJ2_CANCELLATION_H
+#define PROJ2_CANCELLATION_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Asks running solvers to stop, by hand, when a deadline passes or on Ctrl-C (see InterruptScope)
+ * @details Solvers that take a token poll it in their loops and return the best tour found so far instead of
+ * finishing. A null token never fires. The token may be cancelled from any thread or from a signal handler.
+ */
+class CancellationToken {
+public:
+    /**
+     * @brief Constructs a token that is not cancelled and has no deadline
+     * @details Time complexity: O(1)
+     */
+    CancellationToken();
+
+    CancellationToken(const CancellationToken &) = delete;
+
+    CancellationToken &operator=(const CancellationToken &) = delete;
+
+    /**
+     * @brief Cancels the token
+     * @details Lock-free, so it is safe in a signal handler. Time complexity: O(1)
+     */
+    void cancel();
+
+    /**
+     * @brief Makes the token fire once some time has passed
+     * @details Time complexity: O(1)
+     * @param seconds Time from now, or a negative value to remove the deadline
+     */
+    void setDeadline(double seconds);
+
+    /**
+     * @brief Makes the token also fire when another one does, so a stage can have its own deadline and still
+     * stop on Ctrl-C
+     * @details Time complexity: O(1)
+     * @param token Token to follow, which must outlive this one, or null to follow none
+     */
+    void setParent(const CancellationToken *token);
+
+    /**
+     * @brief Clears the cancellation and the deadline, so the token can be used for another solve
+     * @details Time complexity: O(1)
+     */
+    void reset();
+
+    /**
+     * @brief Checks if the token was cancelled or its deadline has passed
+     * @details Reads the clock when there is a deadline, so tight loops should go through CancellationCheck.
+     * Time complexity: O(1)
+     * @return True if the solver should stop
+     */
+    bool isCancelled() const;
+
+private:
+    static const int64_t NO_DEADLINE = INT64_MAX;
+
+    mutable std::atomic<bool> cancelled;
+    std::atomic<int64_t> deadline; // steady_clock ticks
+    const CancellationToken *parent = nullptr;
+};
+
+/**
+ * @brief Polls a token from the inner loop of a search
+ * @details Like CheckpointTimer, the token is only read every few thousand steps, so the check costs next to
+ * nothing per step. Once it has fired it stays fired.
+ */
+class CancellationCheck {
+public:
+    /**
+     * @brief Constructs a check of a token
+     * @details Time complexity: O(1)
+     * @param token Token, or null for a check that never fires
+     */
+    explicit CancellationCheck(const CancellationToken *token) : token(token) {}
+
+    /**
+     * @brief Counts a step of the search and checks the token every STEPS_PER_CHECK steps
+     * @details Time complexity: O(1)
+     * @return True if the search should stop
+     */
+    bool step() {
+        if (stopped) return true;
+        if (!token || ++steps < STEPS_PER_CHECK) return false;
+        steps = 0;
+        return now();
+    }
+
+    /**
+     * @brief Checks the token, regardless of the number of steps
+     * @details Time complexity: O(1)
+     * @return True if the search should stop
+     */
+    bool now() {
+        if (!stopped && token) stopped = token->isCancelled();
+        return stopped;
+    }
+
+    /**
+     * @brief Checks if the search was stopped by the token
+     * @details Time complexity: O(1)
+     * @return True if a check has fired
+     */
+    bool wasCancelled() const {
+        return stopped;
+    }
+
+private:
+    static const int STEPS_PER_CHECK = 1 << 10;
+    const CancellationToken *token;
+    int steps = 0;
+    bool stopped = false;
+};
+
+/**
+ * @brief Cancels a token on SIGINT (Ctrl-C) for as long as it is in scope, then restores the previous handler
+ * @details A second Ctrl-C while the token is already cancelled ends the process as usual, so a solver that
+ * does not poll the token can still be killed. Scopes do not nest; the innermost one wins.
+ */
+class InterruptScope {
+public:
+    /**
+     * @brief Installs the handler
+     * @details Time complexity: O(1)
+     * @param token Token to cancel, which must outlive the scope
+     */
+    explicit InterruptScope(CancellationToken &token);
+
+    InterruptScope(const InterruptScope &) = delete;
+
+    InterruptScope &operator=(const InterruptScope &) = delete;
+
+    /**
+     * @brief Restores the handler that was installed before
+     */
+    ~InterruptScope();
+
+private:
+    void (*previousHandler)(int);
+    CancellationToken *previousToken;
+};
+
+#endif //PROJ2_CANCELLATION_H
@@ -0,0 +1,172 @@
+#include "Checkpoint.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+    const char MAGIC[4] = {'P', '2', 'C', 'K'};
+    const uint32_t VERSION = 2;
+
+    uint64_t hashMatrix(const DistanceMatrix &m) {
+        // FNV-1a over the size, the ids and the weights
+        uint64_t hash = 1469598103934665603ULL;
+        auto mix = [&hash](const void *data, size_t size) {
+            const unsigned char *bytes = (const unsigned char *) data;
+            for (size_t i = 0; i < size; i++) {
+                hash = (hash ^ bytes[i]) * 1099511628211ULL;
+            }
+        };
+        int n = m.size();
+        mix(&n, sizeof(n));
+        for (int i = 0; i < n; i++) {
+            int id = m.getId(i);
+            mix(&id, sizeof(id));
+            for (int j = 0; j < n; j++) {
+                Weight w = m.at(i, j);
+                mix(&w, sizeof(w));
+            }
+        }
+        return hash;
+    }
+}
+
+const int CheckpointTimer::STEPS_PER_CHECK;
+
+Checkpoint::Checkpoint(const string &kind, const DistanceMatrix &m) : instanceHash(hashMatrix(m)) {
+    memset(this->kind, 0, sizeof(this->kind));
+    memcpy(this->kind, kind.data(), min(kind.size(), sizeof(this->kind)));
+}
+
+void Checkpoint::putInt(int64_t value) {
+    const char *bytes = (const char *) &value;
+    payload.insert(payload.end(), bytes, bytes + sizeof(value));
+}
+
+void Checkpoint::putDouble(double value) {
+    const char *bytes = (const char *) &value;
+    payload.insert(payload.end(), bytes, bytes + sizeof(value));
+}
+
+void Checkpoint::putInts(const vector<int> &values) {
+    putInt((int64_t) values.size());
+    for (int v: values) {
+        int32_t value = v;
+        const char *bytes = (const char *) &value;
+        payload.insert(payload.end(), bytes, bytes + sizeof(value));
+    }
+}
+
+void Checkpoint::putBytes(const void *data, size_t size) {
+    putInt((int64_t) size);
+    const char *bytes = (const char *) data;
+    payload.insert(payload.end(), bytes, bytes + size);
+}
+
+int64_t Checkpoint::getInt() {
+    int64_t value = 0;
+    if (readPosition + sizeof(value) > payload.size()) {
+        valid = false;
+        return 0;
+    }
+    memcpy(&value, payload.data() + readPosition, sizeof(value));
+    readPosition += sizeof(value);
+    return value;
+}
+
+double Checkpoint::getDouble() {
+    double value = 0;
+    if (readPosition + sizeof(value) > payload.size()) {
+        valid = false;
+        return 0;
+    }
+    memcpy(&value, payload.data() + readPosition, sizeof(value));
+    readPosition += sizeof(value);
+    return value;
+}
+
+vector<int> Checkpoint::getInts() {
+    int64_t size = getInt();
+    if (size < 0 || readPosition + size * sizeof(int32_t) > payload.size()) {
+        valid = false;
+        return {};
+    }
+    vector<int> values((size_t) size);
+    for (int64_t i = 0; i < size; i++) {
+        int32_t value;
+        memcpy(&value, payload.data() + readPosition, sizeof(value));
+        readPosition += sizeof(value);
+        values[i] = value;
+    }
+    return values;
+}
+
+bool Checkpoint::getBytes(void *data, size_t size) {
+    int64_t stored = getInt();
+    if (stored != (int64_t) size || readPosition + size > payload.size()) {
+        valid = false;
+        return false;
+    }
+    memcpy(data, payload.data() + readPosition, size);
+    readPosition += size;
+    return true;
+}
+
+bool Checkpoint::isValid() const {
+    return valid;
+}
+
+bool Checkpoint::save(const string &filename) const {
+    string temporary = filename + ".tmp";
+    FILE *file = fopen(temporary.c_str(), "wb");
+    if (file == nullptr) return false;
+    uint64_t size = payload.size();
+    bool ok = fwrite(MAGIC, sizeof(MAGIC), 1, file) == 1 && fwrite(&VERSION, sizeof(VERSION), 1, file) == 1 &&
+              fwrite(kind, sizeof(kind), 1, file) == 1 && fwrite(&instanceHash, sizeof(instanceHash), 1, file) == 1 &&
+              fwrite(&size, sizeof(size), 1, file) == 1 &&
+              fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+    ok = fclose(file) == 0 && ok;
+    return ok && rename(temporary.c_str(), filename.c_str()) == 0;
+}
+
+bool Checkpoint::load(const string &filename) {
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file == nullptr) return false;
+    char magic[4], storedKind[8];
+    uint32_t version;
+    uint64_t hash, size;
+    bool ok = fread(magic, sizeof(magic), 1, file) == 1 && fread(&version, sizeof(version), 1, file) == 1 &&
+              fread(storedKind, sizeof(storedKind), 1, file) == 1 && fread(&hash, sizeof(hash), 1, file) == 1 &&
+              fread(&size, sizeof(size), 1, file) == 1;
+    ok = ok && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 && version == VERSION;
+    ok = ok && memcmp(storedKind, kind, sizeof(kind)) == 0 && hash == instanceHash;
+
+    vector<char> data;
+    if (ok) {
+        data.resize(size);
+        ok = fread(data.data(), 1, size, file) == size;
+    }
+    fclose(file);
+    if (!ok) return false;
+    payload.swap(data);
+    readPosition = 0;
+    valid = true;
+    return true;
+}
+
+void Checkpoint::remove(const string &filename) {
+    std::remove(filename.c_str());
+}
+
+CheckpointTimer::CheckpointTimer(const CheckpointOptions &options)
+        : enabled(!options.filename.empty()), intervalSeconds(options.intervalSeconds),
+          last(chrono::steady_clock::now()) {}
+
+bool CheckpointTimer::due() {
+    if (!enabled) return false;
+    auto now = chrono::steady_clock::now();
+    if (chrono::duration<double>(now - last).count() < intervalSeconds) return false;
+    last = now;
+    count++;
+    return true;
+}
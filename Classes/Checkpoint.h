@@ -0,0 +1,183 @@
+#ifndef PROJ2_CHECKPOINT_H
+#define PROJ2_CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "DistanceMatrix.h"
+
+/**
+ * @brief Where and how often a long-running solver saves its state
+ */
+struct CheckpointOptions {
+    std::string filename;         // empty disables checkpointing
+    double intervalSeconds = 60.0;
+    bool resume = true;           // continue from the file when it holds a checkpoint of the same search
+};
+
+/**
+ * @brief Binary snapshot of the state of a solver, tied to the instance it was taken on
+ * @details The file starts with a magic number, a format version, the solver kind and a hash of the
+ * distance matrix, so a checkpoint is never resumed on another instance or by another solver.
+ * Values are fixed-width and stored in host byte order. Files are written to a temporary name and
+ * renamed, so a crash while saving leaves the previous checkpoint intact.
+ */
+class Checkpoint {
+public:
+    /**
+     * @brief Constructs an empty checkpoint
+     * @details Time complexity: O(n^2), to hash the matrix
+     * @param kind Name of the solver, at most 8 characters
+     * @param m Distance matrix of the instance
+     */
+    Checkpoint(const std::string &kind, const DistanceMatrix &m);
+
+    /**
+     * @brief Appends a value to the payload
+     * @details Time complexity: O(1)
+     * @param value Value
+     */
+    void putInt(int64_t value);
+
+    /**
+     * @brief Appends a value to the payload
+     * @details Time complexity: O(1)
+     * @param value Value
+     */
+    void putDouble(double value);
+
+    /**
+     * @brief Appends a vector to the payload, preceded by its size
+     * @details Time complexity: O(k), where k is the size of the vector
+     * @param values Values
+     */
+    void putInts(const std::vector<int> &values);
+
+    /**
+     * @brief Appends raw bytes to the payload, preceded by their size
+     * @details Time complexity: O(k)
+     * @param data Bytes
+     * @param size Number of bytes
+     */
+    void putBytes(const void *data, std::size_t size);
+
+    /**
+     * @brief Reads the next value of the payload
+     * @details Time complexity: O(1)
+     * @return The value, or 0 past the end
+     */
+    int64_t getInt();
+
+    /**
+     * @brief Reads the next value of the payload
+     * @details Time complexity: O(1)
+     * @return The value, or 0 past the end
+     */
+    double getDouble();
+
+    /**
+     * @brief Reads the next vector of the payload
+     * @details Time complexity: O(k)
+     * @return The values
+     */
+    std::vector<int> getInts();
+
+    /**
+     * @brief Reads the next block of bytes of the payload
+     * @details Time complexity: O(k)
+     * @param data Buffer to store the bytes
+     * @param size Number of bytes expected
+     * @return True if a block of that size was read
+     */
+    bool getBytes(void *data, std::size_t size);
+
+    /**
+     * @brief Checks if every read so far was within the payload
+     * @details Time complexity: O(1)
+     * @return True if no read went past the end
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Writes the checkpoint, replacing the file atomically
+     * @details Time complexity: O(P), where P is the size of the payload
+     * @param filename File
+     * @return True if the file was written
+     */
+    bool save(const std::string &filename) const;
+
+    /**
+     * @brief Reads a checkpoint of the same solver and instance, replacing the payload
+     * @details Time complexity: O(P)
+     * @param filename File
+     * @return True if the file holds a matching checkpoint
+     */
+    bool load(const std::string &filename);
+
+    /**
+     * @brief Deletes a checkpoint file, once the search it belongs to is finished
+     * @details Time complexity: O(1)
+     * @param filename File
+     */
+    static void remove(const std::string &filename);
+
+private:
+    char kind[8];
+    uint64_t instanceHash;
+    std::vector<char> payload;
+    std::size_t readPosition = 0;
+    bool valid = true;
+};
+
+/**
+ * @brief Decides when a solver should save a checkpoint
+ * @details The clock is only read every few thousand steps, so the check costs next to nothing in the
+ * inner loop of a search.
+ */
+class CheckpointTimer {
+public:
+    /**
+     * @brief Constructs a timer for some options
+     * @details Time complexity: O(1)
+     * @param options Checkpoint options
+     */
+    explicit CheckpointTimer(const CheckpointOptions &options);
+
+    /**
+     * @brief Counts a step of the search and checks if a checkpoint is due
+     * @details Time complexity: O(1)
+     * @return True if a checkpoint should be saved now
+     */
+    bool step() {
+        if (!enabled || ++steps < STEPS_PER_CHECK) return false;
+        steps = 0;
+        return due();
+    }
+
+    /**
+     * @brief Checks the clock, regardless of the number of steps
+     * @details Restarts the interval when a checkpoint is due. Time complexity: O(1)
+     * @return True if a checkpoint should be saved now
+     */
+    bool due();
+
+    /**
+     * @brief Gets the number of checkpoints taken
+     * @details Time complexity: O(1)
+     * @return Number of times due() returned true
+     */
+    int getCount() const {
+        return count;
+    }
+
+private:
+    static const int STEPS_PER_CHECK = 1 << 14;
+    bool enabled;
+    double intervalSeconds;
+    int steps = 0;
+    int count = 0;
+    std::chrono::steady_clock::time_point last;
+};
+
+#endif //PROJ2_CHECKPOINT_H
@@ -0,0 +1,697 @@
+#include "Cli.h"
+#include "Benchmark.h"
+#include "Autotuner.h"
+#include "IslandModel.h"
+#include "GraphStatistics.h"
+#include "BenchCompare.h"
+#include <sstream>
+
+using namespace std;
+
+int Cli::run(int argc, char *argv[]) {
+    vector<string> args(argv + 1, argv + argc);
+    string command = args.front();
+    args.erase(args.begin());
+
+    if (command == "latency") return latency(args);
+    if (command == "compare-latency") return compareLatency(args);
+    if (command == "scaling") return scaling(args);
+    if (command == "calibrate") return calibrate(args);
+    if (command == "select") return select(args);
+    if (command == "tune") return tune(args);
+    if (command == "exact") return exact(args);
+    if (command == "island") return island(args);
+    if (command == "island-worker") return islandWorker(args);
+    if (command == "tour-eval") return tourEval(args);
+    if (command == "pool-bench") return poolBench(args);
+    if (command == "serve-sim") return serveSim(args);
+    if (command == "precedence") return precedence(args);
+    if (command == "stats") return stats(args);
+    if (command == "merge") return merge(args);
+    if (command == "backbone") return backbone(args);
+    if (command == "bench-compare") return benchCompare(args);
+    if (command == "nested") return nested(args);
+    if (command == "gls") return gls(args);
+    if (command == "tabu") return tabu(args);
+
+    printUsage();
+    return command == "help" ? 0 : 1;
+}
+
+void Cli::printUsage() {
+    cout << "Usage: proj2 [command] [arguments]" << endl;
+    cout << "Without a command the interactive menu is shown." << endl;
+    cout << "Datasets: shipping, stadiums, tourism, real1, real2, real3, 25, 50, 100, 200, ..., 900" << endl;
+    cout << "Commands:" << endl;
+    cout << "  latency <dataset> [repetitions] [output]    record query latency percentiles (.json: every run)" << endl;
+    cout << "  compare-latency <baseline> <candidate>      compare two files saved by latency" << endl;
+    cout << "  bench-compare <base> <cand> [alpha] [min]   significant changes between two JSON results" << endl;
+    cout << "  scaling [max-nodes] [repetitions] [budget]  fit empirical complexity across sizes" << endl;
+    cout << "  calibrate [output] [max-nodes]              measure pipelines for the algorithm selector" << endl;
+    cout << "  select <dataset> [budget]                   pick and run the best pipeline within budget" << endl;
+    cout << "  tune [output] [runs]                        tune local search per size class (F-race)" << endl;
+    cout << "  exact <dataset> <dp|bnb> [file] [interval] [limit] exact search with checkpoint, resume and Ctrl-C" << endl;
+    cout << "  island <dataset> [workers] [seconds] [port] island-model local search over TCP workers" << endl;
+    cout << "  island-worker <host> <port>                 join an island-model run as a worker" << endl;
+    cout << "  tour-eval <dataset> [tours] [threads]       batch tour cost throughput in hops/s" << endl;
+    cout << "  pool-bench [tasks] [max-threads]            thread pool overhead and scaling" << endl;
+    cout << "  serve-sim [requests] [workers] [ms] [rate]  many small solves under deadlines" << endl;
+    cout << "  precedence <dataset> [pairs|count] [start]  pickups before deliveries, from a file or random" << endl;
+    cout << "  stats <dataset>                             network statistics for capacity planning" << endl;
+    cout << "  merge <dataset> [tours]                     best tour over the edges of several heuristic tours" << endl;
+    cout << "  backbone <dataset> [runs]                   exact search after fixing edges common to good tours" << endl;
+    cout << "  nested [max-nodes] [repetitions]            sizes 25..900 as views of one edges_900 matrix" << endl;
+    cout << "  gls <dataset|extra> [seconds]               guided local search against 2-opt and ILS" << endl;
+    cout << "  tabu <dataset|extra> [seconds]              tabu search against ILS and GLS, in iterations/s" << endl;
+    cout << "  help                                        show this message" << endl;
+}
+
+int Cli::latency(const vector<string> &args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    int repetitions = args.size() > 1 ? stoi(args[1]) : 100;
+    Data d = Data(args[0]);
+    TspManager tspm(d);
+    Benchmark benchmark(tspm, args[0]);
+    benchmark.runLatency(repetitions);
+    benchmark.print();
+    if (args.size() < 3) return 0;
+    const string &output = args[2];
+    if (output.size() > 5 && output.compare(output.size() - 5, 5, ".json") == 0) {
+        // the JSON results keep every run, for bench-compare, and the load times of the dataset
+        benchmark.runLoader(min(repetitions, 5));
+        return benchmark.saveJson(output) ? 0 : 1;
+    }
+    return benchmark.save(output) ? 0 : 1;
+}
+
+int Cli::compareLatency(const vector<string> &args) {
+    if (args.size() < 2) {
+        printUsage();
+        return 1;
+    }
+    map<string, LatencyHistogram> baseline, candidate;
+    if (!Benchmark::load(args[0], baseline) || !Benchmark::load(args[1], candidate)) return 1;
+
+    cout << left << setw(22) << "query" << right << setw(12) << "p50 ratio" << setw(12) << "p99 ratio"
+         << setw(12) << "max ratio" << endl;
+    cout << fixed << setprecision(3);
+    for (const auto &b: baseline) {
+        auto c = candidate.find(b.first);
+        if (c == candidate.end()) continue;
+        auto ratio = [](uint64_t after, uint64_t before) {
+            return before == 0 ? 0.0 : (double) after / (double) before;
+        };
+        cout << left << setw(22) << b.first << right
+             << setw(12) << ratio(c->second.getPercentile(50), b.second.getPercentile(50))
+             << setw(12) << ratio(c->second.getPercentile(99), b.second.getPercentile(99))
+             << setw(12) << ratio(c->second.getMax(), b.second.getMax()) << endl;
+    }
+    return 0;
+}
+
+int Cli::scaling(const vector<string> &args) {
+    int maxNodes = args.size() > 0 ? stoi(args[0]) : 1600;
+    int repetitions = args.size() > 1 ? stoi(args[1]) : 3;
+    double budget = args.size() > 2 ? stod(args[2]) : 5.0;
+    vector<string> datasets;
+    for (int n: {25, 50, 100, 200, 300, 400, 500, 600, 700, 800, 900}) {
+        if (n <= maxNodes) datasets.push_back(to_string(n));
+    }
+    for (int n: {1200, 1600, 2400, 3200}) {
+        if (n <= maxNodes) datasets.push_back("random" + to_string(n));
+    }
+    Benchmark::scalingReport(datasets, repetitions, budget);
+    return 0;
+}
+
+int Cli::calibrate(const vector<string> &args) {
+    string output = args.size() > 0 ? args[0] : "calibration.csv";
+    int maxNodes = args.size() > 1 ? stoi(args[1]) : 900;
+    vector<string> datasets = {"tourism", "stadiums", "shipping"};
+    for (int n: {8, 10, 12, 13, 14, 16, 18, 20}) {
+        datasets.push_back("random" + to_string(n));
+    }
+    for (int n: {25, 50, 100, 200, 300, 400, 500, 600, 700, 800, 900}) {
+        if (n <= maxNodes) datasets.push_back(to_string(n));
+    }
+    if (!Benchmark::calibrate(datasets, output, 10.0)) return 1;
+    cout << "Calibration saved to " << output << endl;
+    return 0;
+}
+
+int Cli::select(const vector<string> &args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    double budget = args.size() > 1 ? stod(args[1]) : 1.0;
+    Data d = Data(args[0]);
+    TspManager tspm(d);
+    CancellationToken cancel;
+    InterruptScope interrupt(cancel);
+    tspm.setCancellation(&cancel);
+    tspm.automaticSelection(budget);
+    return 0;
+}
+
+int Cli::tune(const vector<string> &args) {
+    string output = args.size() > 0 ? args[0] : "tuning.csv";
+    int runs = args.size() > 1 ? stoi(args[1]) : 600;
+
+    // training instances are random vertex subsets of the fully connected extra graphs
+    vector<DistanceMatrix> sources;
+    for (int n: {25, 50, 100, 200, 300, 400, 500, 600, 700, 800, 900}) {
+        Data d = Data(to_string(n));
+        TspManager tspm(d);
+        if (tspm.getInstanceFeatures().complete) sources.push_back(tspm.getDistanceMatrix());
+    }
+    if (sources.empty()) {
+        cout << "No training data available" << endl;
+        return 1;
+    }
+
+    struct SizeClass {
+        int minVertices, maxVertices;
+        double budgetSeconds;
+    };
+    vector<SizeClass> classes = {{20, 50, 0.005}, {60, 200, 0.03}, {250, 900, 0.2}};
+    mt19937 rng(42);
+    vector<TunedConfig> configs;
+    for (const auto &c: classes) {
+        vector<DistanceMatrix> training;
+        for (int i = 0; i < 16; i++) {
+            int n = uniform_int_distribution<int>(c.minVertices, c.maxVertices)(rng);
+            vector<const DistanceMatrix *> large;
+            for (const auto &m: sources) {
+                if (m.size() >= n) large.push_back(&m);
+            }
+            if (large.empty()) continue;
+            const DistanceMatrix &source = *large[uniform_int_distribution<size_t>(0, large.size() - 1)(rng)];
+            training.push_back(Autotuner::sample(source, n, rng));
+        }
+        cout << "Size class up to " << c.maxVertices << " vertices (" << training.size()
+             << " instances, " << c.budgetSeconds << " s per run)" << endl;
+        Autotuner tuner(training, c.budgetSeconds);
+        LocalSearchConfig best = tuner.tune(runs);
+        cout << "  tuned: " << Autotuner::describe(best) << endl;
+        configs.push_back({c.maxVertices, best});
+    }
+    if (!Autotuner::saveConfigs(output, configs)) return 1;
+    cout << "Configurations saved to " << output << endl;
+    return 0;
+}
+
+int Cli::exact(const vector<string> &args) {
+    if (args.size() < 2 || (args[1] != "dp" && args[1] != "bnb")) {
+        printUsage();
+        return 1;
+    }
+    CheckpointOptions options;
+    options.filename = args.size() > 2 ? args[2] : args[0] + "_" + args[1] + ".ckpt";
+    options.intervalSeconds = args.size() > 3 ? stod(args[3]) : 60.0;
+    double timeLimit = args.size() > 4 ? stod(args[4]) : -1.0;
+    Data d = Data(args[0]);
+    TspManager tspm(d);
+    if (args[1] == "dp" && tspm.getInstanceFeatures().n > ExactSolver::MAX_DP_VERTICES) {
+        cout << "The dynamic programming solver accepts at most " << ExactSolver::MAX_DP_VERTICES << " vertices"
+             << endl;
+        return 1;
+    }
+    tspm.setCheckpoint(options);
+    if (ifstream(options.filename).good()) cout << "Resuming from " << options.filename << " if it matches" << endl;
+
+    // Ctrl-C or the time limit stop the search with a checkpoint to resume from
+    CancellationToken cancel;
+    cancel.setDeadline(timeLimit);
+    InterruptScope interrupt(cancel);
+    tspm.setCancellation(&cancel);
+    vector<int> tour;
+    auto start = chrono::steady_clock::now();
+    double cost = tspm.runPipeline(args[1] == "dp" ? Pipeline::ExactDP : Pipeline::BranchAndBound, tour);
+    chrono::duration<double> duration = chrono::steady_clock::now() - start;
+    if (tour.empty()) {
+        // nothing to print but the cost sentinel, which is not a weight
+        if (tspm.wasCancelled()) {
+            cout << "Stopped early, no tour found before the search was stopped; saved progress to "
+                 << options.filename << endl;
+        } else {
+            cout << "No tour visits every node" << endl;
+        }
+        cout << "Time taken by algorithm: " << to_string(duration.count()) << " seconds" << endl;
+        return 1;
+    }
+    if (tspm.wasCancelled()) {
+        cout << "Stopped early, saved progress to " << options.filename << "; the tour below is the best found"
+             << (args[1] == "dp" ? " by nearest neighbour" : " so far") << endl;
+    }
+    cout << "Best tour: ";
+    for (int i: tour) {
+        cout << i << " ";
+    }
+    cout << endl << "Total weight: " << fixed << setprecision(2) << cost << endl;
+    cout << "Time taken by algorithm: " << to_string(duration.count()) << " seconds" << endl;
+    return 0;
+}
+
+int Cli::island(const vector<string> &args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    IslandOptions options;
+    if (args.size() > 1) options.localWorkers = stoi(args[1]);
+    if (args.size() > 2) options.seconds = stod(args[2]);
+    if (args.size() > 3) options.port = stoi(args[3]);
+    Data d = Data(args[0]);
+    TspManager tspm(d);
+    if (!tspm.getInstanceFeatures().complete) {
+        cout << "The island model needs a fully connected graph" << endl;
+        return 1;
+    }
+    GraphSnapshot snapshot = GraphSnapshot::fromGraph(d.getGraph());
+
+    vector<int> tour;
+    CancellationToken cancel;
+    InterruptScope interrupt(cancel);
+    double cost = IslandModel::coordinate(snapshot, options, tour, &cancel);
+    if (tour.empty()) {
+        cout << "No worker reported a tour" << endl;
+        return 1;
+    }
+    cout << "Best tour: ";
+    for (int i: tour) {
+        cout << snapshot.getId(i) << " ";
+    }
+    cout << snapshot.getId(tour.front()) << endl;
+    cout << "Total weight: " << fixed << setprecision(2) << cost << endl;
+    return 0;
+}
+
+int Cli::islandWorker(const vector<string> &args) {
+    if (args.size() < 2) {
+        printUsage();
+        return 1;
+    }
+    return IslandModel::work(args[0], stoi(args[1]));
+}
+
+int Cli::tourEval(const vector<string> &args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    int tours = args.size() > 1 ? stoi(args[1]) : 10000;
+    unsigned threads = args.size() > 2 ? (unsigned) stoi(args[2]) : 0;
+    Data d = Data(args[0]);
+    TspManager tspm(d);
+    Benchmark::tourEvaluation(tspm.getDistanceMatrix(), tours, threads);
+    return 0;
+}
+
+int Cli::poolBench(const vector<string> &args) {
+    int tasks = args.size() > 0 ? stoi(args[0]) : 100000;
+    unsigned threads = args.size() > 1 ? (unsigned) stoi(args[1]) : 0;
+    Benchmark::threadPool(tasks, threads);
+    return 0;
+}
+
+int Cli::serveSim(const vector<string> &args) {
+    int requests = args.size() > 0 ? stoi(args[0]) : 2000;
+    unsigned workers = args.size() > 1 ? (unsigned) stoi(args[1]) : 4;
+    double deadline = args.size() > 2 ? stod(args[2]) / 1000.0 : 0.05;
+    double rate = args.size() > 3 ? stod(args[3]) : 0.0;
+    Benchmark::serveSimulation(requests, workers, deadline, rate);
+    return 0;
+}
+
+int Cli::precedence(const vector<string> &args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    Data d = Data(args[0]);
+    TspManager tspm(d);
+    CancellationToken cancel;
+    InterruptScope interrupt(cancel);
+    tspm.setCancellation(&cancel);
+    const auto &vertices = d.getGraph().getVertexSet();
+    if (vertices.empty()) return 1;
+    int start = args.size() > 2 ? stoi(args[2]) : vertices[0]->getInfo();
+
+    vector<pair<int, int>> pairs;
+    string source = args.size() > 1 ? args[1] : to_string(vertices.size() / 10);
+    if (!source.empty() && all_of(source.begin(), source.end(), ::isdigit)) {
+        // random pairs over distinct nodes other than the start
+        vector<int> ids;
+        for (auto v: vertices) {
+            if (v->getInfo() != start) ids.push_back(v->getInfo());
+        }
+        mt19937 rng(42);
+        shuffle(ids.begin(), ids.end(), rng);
+        size_t count = min((size_t) stoul(source), ids.size() / 2);
+        for (size_t i = 0; i < count; i++) {
+            pairs.emplace_back(ids[2 * i], ids[2 * i + 1]);
+        }
+    } else if (!Data::readPrecedencePairs(source, pairs)) {
+        return 1;
+    }
+
+    vector<int> free;
+    double freeCost = tspm.localSearchTour(start, free);
+    vector<int> tour;
+    auto begin = chrono::steady_clock::now();
+    double cost = tspm.precedenceTour(start, pairs, tour);
+    chrono::duration<double> duration = chrono::steady_clock::now() - begin;
+    if (tour.empty()) {
+        cout << "No tour respects the " << pairs.size() << " pairs: a node is unknown, the pairs form a cycle "
+             << "or the start is a delivery" << endl;
+        return 1;
+    }
+
+    unordered_map<int, size_t> position;
+    for (size_t i = 0; i + 1 < tour.size(); i++) {
+        position[tour[i]] = i;
+    }
+    size_t broken = 0;
+    for (const auto &p: pairs) {
+        if (position[p.first] > position[p.second]) broken++;
+    }
+    cout << "Best tour: ";
+    for (int i: tour) {
+        cout << i << " ";
+    }
+    cout << endl << "Pairs: " << pairs.size() << ", broken: " << broken << endl;
+    cout << fixed << setprecision(2) << "Total weight: " << cost << " (" << freeCost << " without the pairs)" << endl;
+    cout << "Time taken by algorithm: " << to_string(duration.count()) << " seconds" << endl;
+    return 0;
+}
+
+int Cli::stats(const vector<string> &args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    auto begin = chrono::steady_clock::now();
+    Data d = Data(args[0]);
+    GraphSnapshot snapshot = GraphSnapshot::fromGraph(d.getGraph());
+    chrono::duration<double> loading = chrono::steady_clock::now() - begin;
+    const GraphStatistics &s = snapshot.getStatistics();
+    begin = chrono::steady_clock::now();
+    snapshot.getStatistics();
+    chrono::duration<double> cached = chrono::steady_clock::now() - begin;
+
+    cout << fixed << setprecision(2);
+    cout << "Vertices: " << s.numVertices << ", edges: " << s.numEdges << " (directed), density: "
+         << setprecision(4) << s.density << setprecision(2) << endl;
+    cout << "Self-loops: " << s.selfLoops << ", one-way edges: " << s.oneWayEdges << ", asymmetric weights: "
+         << s.asymmetricEdges << endl;
+    cout << "Parallel edges removed at load: " << d.getCompaction().edgesRemoved << " of "
+         << d.getCompaction().edgesBefore << endl;
+    cout << "Out-degree: min " << s.minDegree << ", mean " << s.meanDegree << ", max " << s.maxDegree << endl;
+    for (size_t b = 0; b < s.degreeHistogram.size(); b++) {
+        if (s.degreeHistogram[b] == 0) continue;
+        string range = b == 0 ? "0" : to_string(1 << (b - 1)) + "-" + to_string((1 << b) - 1);
+        cout << "  " << left << setw(12) << range << right << setw(10) << s.degreeHistogram[b] << endl;
+    }
+    cout << "Components: " << s.componentSizes.size() << ", largest:";
+    for (size_t c = 0; c < s.componentSizes.size() && c < 5; c++) {
+        cout << " " << s.componentSizes[c];
+    }
+    cout << endl;
+    cout << "Weights: min " << s.minWeight << ", mean " << s.meanWeight << ", p50 " << s.weightP50 << ", p90 "
+         << s.weightP90 << ", p99 " << s.weightP99 << ", max " << s.maxWeight << endl;
+    cout << "Metricity violations: " << s.metricViolationRate * 100 << "% of " << s.sampledTriangles
+         << " sampled triangles" << endl;
+    cout << "Diameter: at least " << s.diameterHops << " edges (double-sweep BFS)" << endl;
+    cout << setprecision(3) << "Time: loading " << loading.count() << " s, statistics " << s.seconds
+         << " s on " << ThreadPool::shared().concurrency() << " threads, cached lookup "
+         << cached.count() * 1e6 << " us" << endl;
+    return 0;
+}
+
+int Cli::merge(const vector<string> &args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    Data d = Data(args[0]);
+    TspManager tspm(d);
+    CancellationToken cancel;
+    InterruptScope interrupt(cancel);
+    tspm.setCancellation(&cancel);
+    const auto &vertices = d.getGraph().getVertexSet();
+    if (vertices.empty()) return 1;
+    int runs = args.size() > 1 ? stoi(args[1]) : 8;
+
+    vector<vector<int>> tours;
+    vector<string> names;
+    vector<double> costs;
+    vector<int> tour;
+    for (int k = 0; k < runs; k++) {
+        // starts spread over the vertices, so the nearest neighbour constructions differ
+        int start = vertices[(size_t) k * vertices.size() / max(runs, 1)]->getInfo();
+        costs.push_back(tspm.localSearchTour(start, tour));
+        tours.push_back(tour);
+        names.push_back("local search from " + to_string(start));
+    }
+
+    TourMergeReport report;
+    vector<int> merged;
+    double cost = tspm.mergeTours(tours, merged, &report);
+    cout << fixed << setprecision(2);
+    for (size_t i = 0; i < tours.size(); i++) {
+        cout << "  " << left << setw(32) << names[i] << right << setw(14) << costs[i] << endl;
+    }
+    if (merged.empty()) {
+        cout << "No input tour visits every node once" << endl;
+        return 1;
+    }
+    double gain = max(0.0, toDouble(report.bestInputCost) - cost);
+    cout << "Best input: " << toDouble(report.bestInputCost) << ", merged: " << cost << " ("
+         << gain / toDouble(report.bestInputCost) * 100 << "% shorter)" << endl;
+    cout << "Union graph: " << report.unionEdges << " edges over " << report.inputTours << " tours, frontier up to "
+         << report.maxFrontier << " vertices, up to " << report.maxStates << " states per step" << endl;
+    cout << (report.exact ? "Best tour in the union graph" : "States were dropped, the tour may not be the best "
+                                                             "in the union graph") << endl;
+    cout << setprecision(3) << "Time taken by merge: " << report.seconds << " seconds" << endl;
+    return 0;
+}
+
+int Cli::backbone(const vector<string> &args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    Data d = Data(args[0]);
+    TspManager tspm(d);
+    CancellationToken cancel;
+    InterruptScope interrupt(cancel);
+    tspm.setCancellation(&cancel);
+    int n = tspm.getNumVertex();
+    if (n == 0) return 1;
+    int runs = args.size() > 1 ? stoi(args[1]) : 10;
+
+    BackboneReport report;
+    vector<int> tour;
+    double cost = tspm.backboneTour(runs, tour, &report);
+    cout << fixed << setprecision(2);
+    cout << "Local search: " << report.runs << " runs, best " << toDouble(report.heuristicCost) << endl;
+    if (!report.solved && cancel.isCancelled()) {
+        cout << "Interrupted, kept the best local search tour: " << cost << endl;
+        return 0;
+    }
+    cout << "Backbone: " << report.fixedEdges << " of " << n << " edges common to the best " << report.goodTours
+         << " tours, " << report.superNodes << " super-nodes (" << report.reduction * 100 << "% of the vertices)"
+         << endl;
+    if (report.solved) {
+        cout << "Exact over the super-nodes: " << cost << endl;
+    } else {
+        cout << "Too many super-nodes for the exact solver (at most " << Backbone::MAX_SUPER_NODES
+             << "), kept the best local search tour: " << cost << endl;
+    }
+    cout << setprecision(3) << "Time: " << report.heuristicSeconds << " s local search + " << report.exactSeconds
+         << " s exact = " << report.heuristicSeconds + report.exactSeconds << " s" << endl;
+
+    // the direct exact solve, or the size of its dynamic programming table when it cannot run
+    if (n <= ExactSolver::MAX_DP_VERTICES) {
+        vector<int> optimal;
+        auto begin = chrono::steady_clock::now();
+        double optimalCost = tspm.heldKarpTour(optimal);
+        chrono::duration<double> direct = chrono::steady_clock::now() - begin;
+        cout << setprecision(2) << "Direct Held-Karp: " << optimalCost << setprecision(3) << " in "
+             << direct.count() << " s" << endl;
+    } else {
+        double directStates = ldexp((double) (n - 1), n - 1);
+        double reducedStates = ldexp(2.0 * max(report.superNodes - 1, 0), max(report.superNodes - 1, 0));
+        cout << scientific << setprecision(2) << "Direct Held-Karp needs " << directStates << " states, the contracted instance "
+             << reducedStates << endl;
+    }
+    return 0;
+}
+
+int Cli::benchCompare(const vector<string> &args) {
+    if (args.size() < 2) {
+        printUsage();
+        return 1;
+    }
+    double alpha = args.size() > 2 ? stod(args[2]) : 0.05;
+    double threshold = args.size() > 3 ? stod(args[3]) : 0.05;
+    string baselineDataset, candidateDataset;
+    vector<BenchmarkCase> baseline, candidate;
+    if (!Benchmark::loadJson(args[0], baselineDataset, baseline) ||
+        !Benchmark::loadJson(args[1], candidateDataset, candidate)) {
+        return 1;
+    }
+    if (baselineDataset != candidateDataset) {
+        cout << "Warning: comparing dataset " << baselineDataset << " with " << candidateDataset << endl;
+    }
+
+    vector<CaseComparison> comparisons = BenchCompare::compare(baseline, candidate, alpha, threshold);
+    cout << left << setw(24) << "case" << setw(9) << "unit" << right << setw(12) << "baseline" << setw(12)
+         << "candidate" << setw(10) << "change" << setw(22) << "interval" << setw(10) << "p" << endl;
+    int regressions = 0, improvements = 0;
+    for (const auto &c: comparisons) {
+        auto percent = [](double ratio) {
+            ostringstream text;
+            text << fixed << setprecision(1) << showpos << (ratio - 1) * 100 << "%";
+            return text.str();
+        };
+        cout << left << setw(24) << c.name << setw(9) << c.unit << right << setprecision(4) << defaultfloat
+             << setw(12) << c.baselineMedian << setw(12) << c.candidateMedian << setw(10) << percent(c.ratio)
+             << setw(22) << "[" + percent(c.ratioLow) + ", " + percent(c.ratioHigh) + "]"
+             << setw(10) << fixed << setprecision(4) << c.pValue;
+        if (c.verdict < 0) cout << "  REGRESSION";
+        if (c.verdict > 0) cout << "  improved";
+        cout << endl;
+        if (c.verdict < 0) regressions++;
+        if (c.verdict > 0) improvements++;
+    }
+    for (const auto &b: baseline) {
+        auto sameName = [&](const BenchmarkCase &c) { return c.name == b.name; };
+        if (none_of(candidate.begin(), candidate.end(), sameName)) cout << "Only in the baseline: " << b.name << endl;
+    }
+    for (const auto &c: candidate) {
+        auto sameName = [&](const BenchmarkCase &b) { return b.name == c.name; };
+        if (none_of(baseline.begin(), baseline.end(), sameName)) cout << "Only in the candidate: " << c.name << endl;
+    }
+    cout << comparisons.size() << " cases compared at alpha " << defaultfloat << alpha << ": " << regressions
+         << " significant regressions, " << improvements << " significant improvements" << endl;
+    // a failing status lets scripts stop on a regression
+    return regressions > 0 ? 2 : 0;
+}
+
+int Cli::nested(const vector<string> &args) {
+    int maxNodes = args.size() > 0 ? stoi(args[0]) : 900;
+    int repetitions = max(1, args.size() > 1 ? stoi(args[1]) : 3);
+    const NestedExtraGraphs *graphs = Data::getNestedExtraGraphs();
+    if (!graphs) return 1;
+    cout << "Loaded nodes.csv and edges_900.csv once in " << fixed << setprecision(3) << graphs->loadSeconds
+         << " s; every size below is a view of the first n nodes (not the instances of edges_n.csv)" << endl;
+
+    cout << right << setw(6) << "n" << setw(12) << "view ns" << setw(16) << "nearest" << setw(16) << "local search"
+         << setw(12) << "seconds" << endl;
+    for (int n: {25, 50, 100, 200, 300, 400, 500, 600, 700, 800, 900}) {
+        if (n > maxNodes || n > graphs->matrix.size()) break;
+        auto begin = chrono::steady_clock::now();
+        DistanceMatrix m = graphs->matrix.leading(n);
+        chrono::duration<double, nano> view = chrono::steady_clock::now() - begin;
+
+        Cost nearest = m.tourCost(LocalSearch::nearestNeighbour(m, 0));
+        vector<double> times;
+        Cost cost = INFINITE_COST;
+        for (int r = 0; r < repetitions; r++) {
+            begin = chrono::steady_clock::now();
+            vector<int> tour = LocalSearch::solve(m, 0, Autotuner::getConfig(n), 42);
+            times.push_back(chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+            cost = m.tourCost(tour);
+        }
+        sort(times.begin(), times.end());
+        cout << setw(6) << n << setw(12) << setprecision(0) << view.count() << setprecision(2) << setw(16)
+             << toDouble(nearest) << setw(16) << toDouble(cost) << setprecision(4) << setw(12)
+             << times[times.size() / 2] << endl;
+    }
+    return 0;
+}
+
+int Cli::gls(const vector<string> &args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    double seconds = args.size() > 1 ? stod(args[1]) : 2.0;
+    vector<string> datasets = {args[0]};
+    if (args[0] == "extra") datasets = {"200", "300", "400", "500", "600", "700", "800", "900"};
+
+    cout << right << setw(6) << "n" << setw(14) << "2-opt" << setw(14) << "ILS" << setw(14) << "GLS 10%"
+         << setw(14) << "GLS 50%" << setw(14) << "GLS" << setw(12) << "vs ILS" << setw(12) << "minima/s" << endl;
+    for (const string &dataset: datasets) {
+        Data d = Data(dataset);
+        TspManager tspm(d);
+        if (tspm.getNumVertex() == 0) continue;
+        const DistanceMatrix &m = tspm.getDistanceMatrix();
+        vector<int> tour;
+        double twoOpt = tspm.localSearchTour(m.getId(0), tour);
+
+        // iterated local search with as many kicks as fit in the same time
+        LocalSearchConfig config = Autotuner::getConfig(m.size());
+        config.kicks = INT_MAX;
+        CancellationToken deadline;
+        deadline.setDeadline(seconds);
+        double iterated = toDouble(m.tourCost(LocalSearch::solve(m, 0, config, 42, &deadline)));
+
+        GuidedLocalSearchReport report;
+        double guided = tspm.guidedLocalSearchTour(m.getId(0), seconds, tour, &report);
+        auto costAt = [&](double time) {
+            Cost cost = report.initialCost;
+            for (const auto &point: report.trace) {
+                if (point.first <= time) cost = point.second;
+            }
+            return toDouble(cost);
+        };
+        cout << setw(6) << m.size() << fixed << setprecision(2) << setw(14) << twoOpt << setw(14) << iterated
+             << setw(14) << costAt(seconds / 10) << setw(14) << costAt(seconds / 2) << setw(14) << guided
+             << setw(11) << 100.0 * (guided - iterated) / iterated << "%" << setprecision(0) << setw(12)
+             << report.localMinima / max(report.seconds, 1e-9) << endl;
+    }
+    return 0;
+}
+
+int Cli::tabu(const vector<string> &args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+    double seconds = args.size() > 1 ? stod(args[1]) : 2.0;
+    vector<string> datasets = {args[0]};
+    if (args[0] == "extra") datasets = {"200", "300", "400", "500", "600", "700", "800", "900"};
+
+    cout << right << setw(6) << "n" << setw(14) << "2-opt" << setw(14) << "ILS" << setw(14) << "GLS"
+         << setw(14) << "tabu" << setw(12) << "vs ILS" << setw(12) << "iter/s" << setw(12) << "aspired"
+         << setw(10) << "restarts" << endl;
+    for (const string &dataset: datasets) {
+        Data d = Data(dataset);
+        TspManager tspm(d);
+        if (tspm.getNumVertex() == 0) continue;
+        const DistanceMatrix &m = tspm.getDistanceMatrix();
+        vector<int> tour;
+        double twoOpt = tspm.localSearchTour(m.getId(0), tour);
+
+        LocalSearchConfig config = Autotuner::getConfig(m.size());
+        config.kicks = INT_MAX;
+        CancellationToken deadline;
+        deadline.setDeadline(seconds);
+        double iterated = toDouble(m.tourCost(LocalSearch::solve(m, 0, config, 42, &deadline)));
+        double guided = tspm.guidedLocalSearchTour(m.getId(0), seconds, tour);
+
+        TabuSearchReport report;
+        double tabu = tspm.tabuSearchTour(m.getId(0), seconds, tour, &report);
+        cout << setw(6) << m.size() << fixed << setprecision(2) << setw(14) << twoOpt << setw(14) << iterated
+             << setw(14) << guided << setw(14) << tabu << setw(11) << 100.0 * (tabu - iterated) / iterated << "%"
+             << setprecision(0) << setw(12) << report.iterationsPerSecond << setw(12) << report.aspirations
+             << setw(10) << report.diversifications << endl;
+    }
+    return 0;
+}
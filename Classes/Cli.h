@@ -0,0 +1,198 @@
+#ifndef PROJ2_CLI_H
+#define PROJ2_CLI_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Non-interactive (batch) front end, used when the program is given command line arguments
+ */
+class Cli {
+public:
+    /**
+     * @brief Runs the command given on the command line
+     * @details Time complexity: that of the command
+     * @param argc Number of arguments
+     * @param argv Arguments, the first being the program name
+     * @return Exit status
+     */
+    static int run(int argc, char *argv[]);
+
+    /**
+     * @brief Prints the available commands
+     * @details Time complexity: O(1)
+     */
+    static void printUsage();
+
+private:
+    /**
+     * @brief Records the latency of repeated queries on a dataset
+     * @details Arguments: dataset [repetitions] [output file]. An output file ending in .json keeps every run
+     * and the load times of the dataset, for bench-compare
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int latency(const std::vector<std::string> &args);
+
+    /**
+     * @brief Compares two latency files saved by the latency command
+     * @details Arguments: baseline file, candidate file
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int compareLatency(const std::vector<std::string> &args);
+
+    /**
+     * @brief Reports how the running time of each algorithm grows across the extra graphs and larger random graphs
+     * @details Arguments: [maximum number of nodes] [repetitions] [budget in seconds]
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int scaling(const std::vector<std::string> &args);
+
+    /**
+     * @brief Measures every solver pipeline to build the calibration table of the algorithm selector
+     * @details Arguments: [output file] [maximum number of nodes]
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int calibrate(const std::vector<std::string> &args);
+
+    /**
+     * @brief Picks the best pipeline for a dataset and latency budget and runs it
+     * @details Arguments: dataset [budget in seconds]
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int select(const std::vector<std::string> &args);
+
+    /**
+     * @brief Tunes the local search knobs for each instance size class and saves them for the solvers
+     * @details Arguments: [output file] [runs per size class]
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int tune(const std::vector<std::string> &args);
+
+    /**
+     * @brief Runs an exact pipeline with checkpoints, resuming from the checkpoint file if it exists
+     * @details Arguments: dataset solver (dp or bnb) [checkpoint file] [interval in seconds] [time limit in
+     * seconds]. Ctrl-C or the time limit stop the search, save a checkpoint and print the best tour so far
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int exact(const std::vector<std::string> &args);
+
+    /**
+     * @brief Runs the island-model local search with worker processes on this machine
+     * @details Arguments: dataset [workers] [seconds] [port]
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int island(const std::vector<std::string> &args);
+
+    /**
+     * @brief Runs an island-model worker that joins a coordinator
+     * @details Arguments: host port
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int islandWorker(const std::vector<std::string> &args);
+
+    /**
+     * @brief Measures batch tour evaluation throughput on the distance matrix of a dataset
+     * @details Arguments: dataset [tours] [threads]
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int tourEval(const std::vector<std::string> &args);
+
+    /**
+     * @brief Measures the task overhead and the scaling of the work-stealing thread pool
+     * @details Arguments: [tasks] [maximum threads]
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int poolBench(const std::vector<std::string> &args);
+
+    /**
+     * @brief Simulates many small concurrent routing requests served by the cooperative scheduler
+     * @details Arguments: [requests] [workers] [deadline in milliseconds] [arrivals per second]
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int serveSim(const std::vector<std::string> &args);
+
+    /**
+     * @brief Solves a dataset with pickup and delivery pairs read from a file or drawn at random
+     * @details Arguments: dataset [pairs file or number of random pairs] [start node]
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int precedence(const std::vector<std::string> &args);
+
+    /**
+     * @brief Prints the statistics of a dataset: sizes, degrees, components, weights, metricity and diameter
+     * @details Arguments: dataset
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int stats(const std::vector<std::string> &args);
+
+    /**
+     * @brief Merges local search tours built from several starts
+     * @details Arguments: dataset, number of local search tours
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int merge(const std::vector<std::string> &args);
+
+    /**
+     * @brief Solves a dataset exactly after fixing the edges common to good tours, and compares it with solving
+     * it directly
+     * @details Arguments: dataset, number of local search runs
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int backbone(const std::vector<std::string> &args);
+
+    /**
+     * @brief Compares two JSON results saved by the latency command, case by case, with a Mann-Whitney test
+     * and a bootstrap interval of the ratio of medians
+     * @details Arguments: baseline file, candidate file, significance level, smallest relative change reported
+     * (0.05 by default, since timings drift by a few percent between runs). The exit status is 2 when some case
+     * regressed significantly
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int benchCompare(const std::vector<std::string> &args);
+
+    /**
+     * @brief Runs local search on the nested extra graphs, loaded once and served as leading views of the
+     * 900-vertex matrix
+     * @details Arguments: largest size, repetitions per size (the median time is kept)
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int nested(const std::vector<std::string> &args);
+
+    /**
+     * @brief Compares guided local search with 2-opt and with iterated local search given the same time
+     * @details Arguments: dataset, or "extra" for the extra graphs of 200 to 900 nodes, and seconds per run.
+     * The cost of guided local search is also shown at a tenth and at half of the budget
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int gls(const std::vector<std::string> &args);
+
+    /**
+     * @brief Compares tabu search with iterated and guided local search given the same time
+     * @details Arguments: dataset, or "extra" for the extra graphs of 200 to 900 nodes, and seconds per run.
+     * Also shows the iterations per second of tabu search and how often it used aspiration and diversification
+     * @param args Arguments of the command
+     * @return Exit status
+     */
+    static int tabu(const std::vector<std::string> &args);
+};
+
+#endif //PROJ2_CLI_H
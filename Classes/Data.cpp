@@ -1,8 +1,57 @@
 #include "Data.h"
+#include <random>
+#include <cctype>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include "Weight.h"
 
 using namespace std;
 
+namespace {
+    const string EXTRA_DIRECTORY = "../dataset/Extra_Fully_Connected_Graphs/";
+
+    /**
+     * @brief Rows of a nodes file as (id, (longitude, latitude)), parsed once per file and shared by every size
+     * of the extra graphs
+     * @param filename String indicating the filename
+     * @return The rows in file order, or null if the file cannot be opened
+     */
+    const vector<pair<int, pair<float, float>>> *nodeRows(const string &filename) {
+        static unordered_map<string, vector<pair<int, pair<float, float>>>> parsed;
+        auto it = parsed.find(filename);
+        if (it != parsed.end()) return &it->second;
+
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cerr << "There was an error opening file " << filename << endl;
+            return nullptr;
+        }
+        TraceSpan span("parseNodes");
+        vector<pair<int, pair<float, float>>> &rows = parsed[filename];
+        string line;
+        getline(file, line);
+        while (getline(file, line)) {
+            stringstream linestream(line);
+            string temp;
+            int id;
+            float value;
+            float value2;
+
+            getline(linestream, temp, ',');
+            id = stoi(temp);
+            getline(linestream, temp, ',');
+            value = stof(temp);
+            getline(linestream, temp, ',');
+            value2 = stof(temp);
+            rows.emplace_back(id, make_pair(value, value2));
+        }
+        return &rows;
+    }
+}
+
 Data::Data(const string &s) {
+    TraceSpan span("loadData");
     if (s == "shipping") {
         readToyGraphs("../dataset/Toy-Graphs/shipping.csv");
     } else if (s == "stadiums") {
@@ -55,9 +104,26 @@ Data::Data(const string &s) {
     } else if (s == "900") {
         readNodesExtra("../dataset/Extra_Fully_Connected_Graphs/nodes.csv", stoi(s));
         readExtraGraphs("../dataset/Extra_Fully_Connected_Graphs/edges_900.csv");
+    } else if (s.compare(0, 6, "random") == 0 && s.size() > 6) {
+        generateFullyConnected(stoi(s.substr(6)), 42);
+    }
+
+    TraceSpan compactSpan("compactEdges");
+    compaction = graph.compactEdges();
+    compactSpan.end();
+    if (compaction.edgesRemoved > 0) {
+        size_t after = compaction.edgesBefore - compaction.edgesRemoved;
+        cout << "Removed " << compaction.edgesRemoved << " parallel edges of " << compaction.edgesBefore << " ("
+             << fixed << setprecision(1) << 100.0 * compaction.edgesRemoved / compaction.edgesBefore
+             << "%), freeing " << compaction.bytesFreed / 1024 << " KiB; a full traversal now visits " << after
+             << " edges" << defaultfloat << endl;
     }
 }
 
+const EdgeCompaction &Data::getCompaction() const {
+    return compaction;
+}
+
 const unordered_map<int, pair<float, float>> &Data::getNodes() const {
     return this->nodesloc;
 }
@@ -83,18 +149,20 @@ void Data::readToyGraphsTourism(const string &filename) {
         return;
     }
 
+    AllocationScope alloc;
+    TraceSpan span("readToyGraphsTourism");
     string line;
     getline(file, line);
     while (getline(file, line)) {
         stringstream linestream(line);
         string temp;
         string vertex1_str, vertex2_str, label_origem, label_destino;
-        float distance;
+        double distance;
 
         getline(linestream, vertex1_str, ',');
         getline(linestream, vertex2_str, ',');
         getline(linestream, temp, ',');
-        distance = stof(temp);
+        distance = parseWeight(temp);
         getline(linestream, label_origem, ',');
         getline(linestream, label_destino, ',');
         int vertex1 = stoi(vertex1_str);
@@ -107,6 +175,7 @@ void Data::readToyGraphsTourism(const string &filename) {
         labels.insert(make_pair(vertex1, label_origem));
         labels.insert(make_pair(vertex2, label_destino));
     }
+    alloc.print("readToyGraphsTourism");
 }
 
 
@@ -119,22 +188,25 @@ void Data::readExtraGraphs(const string &filename) {
         return;
     }
 
+    AllocationScope alloc;
+    TraceSpan span("readExtraGraphs");
     string line;
     while (getline(file, line)) {
         stringstream linestream(line);
         string temp;
         string vertex1_str, vertex2_str;
-        float distance;
+        double distance;
 
         getline(linestream, vertex1_str, ',');
         getline(linestream, vertex2_str, ',');
         getline(linestream, temp, ',');
-        distance = stof(temp);
+        distance = parseWeight(temp);
         int vertex1 = stoi(vertex1_str);
         int vertex2 = stoi(vertex2_str);
         graph.addEdge(vertex1, vertex2, distance);
         graph.addEdge(vertex2, vertex1, distance);
     }
+    alloc.print("readExtraGraphs");
 }
 
 void Data::readToyGraphs(const string &filename) {
@@ -145,6 +217,8 @@ void Data::readToyGraphs(const string &filename) {
         return;
     }
 
+    AllocationScope alloc;
+    TraceSpan span("readToyGraphs");
     string line;
     getline(file, line);
     while (getline(file, line)) {
@@ -152,21 +226,21 @@ void Data::readToyGraphs(const string &filename) {
         string temp;
         int vertex1;
         int vertex2;
-        float distance;
+        double distance;
 
         getline(linestream, temp, ',');
         vertex1 = stoi(temp);
         getline(linestream, temp, ',');
         vertex2 = stoi(temp);
         getline(linestream, temp, ',');
-        distance = stof(temp);
+        distance = parseWeight(temp);
 
         graph.addVertex(vertex1);
         graph.addVertex(vertex2);
         graph.addEdge(vertex1, vertex2, distance);
         graph.addEdge(vertex2, vertex1, distance);
     }
-
+    alloc.print("readToyGraphs");
 }
 
 void Data::readGraphs(const string &filename) {
@@ -177,6 +251,8 @@ void Data::readGraphs(const string &filename) {
         return;
     }
 
+    AllocationScope alloc;
+    TraceSpan span("readGraphs");
     string line;
     getline(file, line);
     while (getline(file, line)) {
@@ -184,18 +260,19 @@ void Data::readGraphs(const string &filename) {
         string temp;
         int vertex1;
         int vertex2;
-        float distance;
+        double distance;
 
         getline(linestream, temp, ',');
         vertex1 = stoi(temp);
         getline(linestream, temp, ',');
         vertex2 = stoi(temp);
         getline(linestream, temp, ',');
-        distance = stof(temp);
+        distance = parseWeight(temp);
 
         graph.addEdge(vertex1, vertex2, distance);
         graph.addEdge(vertex2, vertex1, distance);
     }
+    alloc.print("readGraphs");
 }
 
 void Data::readNodes(const string &filename) {
@@ -206,6 +283,8 @@ void Data::readNodes(const string &filename) {
         return;
     }
 
+    AllocationScope alloc;
+    TraceSpan span("readNodes");
     string line;
     getline(file, line);
     while (getline(file, line)) {
@@ -225,39 +304,111 @@ void Data::readNodes(const string &filename) {
         graph.addVertex(id);
         nodesloc.insert(make_pair(id, make_pair(value, value2)));
     }
-
+    alloc.print("readNodes");
 }
 
 void Data::readNodesExtra(const string &filename, int limit) {
-    ifstream file(filename);
+    const vector<pair<int, pair<float, float>>> *rows = nodeRows(filename);
+    if (!rows) return;
+
+    AllocationScope alloc;
+    TraceSpan span("readNodesExtra");
+    for (int k = 0; k < limit && k < (int) rows->size(); k++) {
+        const auto &row = (*rows)[k];
+        graph.addVertex(row.first);
+        nodesloc.insert(row);
+    }
+    alloc.print("readNodesExtra");
+}
+
+const NestedExtraGraphs *Data::getNestedExtraGraphs() {
+    static unique_ptr<NestedExtraGraphs> nested;
+    static bool loaded = false;
+    if (loaded) return nested.get();
+    loaded = true;
 
+    auto begin = chrono::steady_clock::now();
+    const vector<pair<int, pair<float, float>>> *rows = nodeRows(EXTRA_DIRECTORY + "nodes.csv");
+    if (!rows) return nullptr;
+    string filename = EXTRA_DIRECTORY + "edges_900.csv";
+    ifstream file(filename);
     if (!file.is_open()) {
         cerr << "There was an error opening file " << filename << endl;
-        return;
+        return nullptr;
     }
 
+    AllocationScope alloc;
+    TraceSpan span("readNestedExtraGraphs");
+    // the vertices are the first 900 nodes in file order, so the first k rows of the matrix are the first k nodes
+    vector<int> ids;
+    unique_ptr<NestedExtraGraphs> result(new NestedExtraGraphs());
+    for (int k = 0; k < 900 && k < (int) rows->size(); k++) {
+        ids.push_back((*rows)[k].first);
+        result->nodes.insert((*rows)[k]);
+    }
+    result->matrix = DistanceMatrix(ids);
     string line;
-    getline(file, line);
-    while (getline(file, line) && limit > 0) {
+    while (getline(file, line)) {
         stringstream linestream(line);
         string temp;
-        int id;
-        float value;
-        float value2;
+        string vertex1_str, vertex2_str;
 
+        getline(linestream, vertex1_str, ',');
+        getline(linestream, vertex2_str, ',');
         getline(linestream, temp, ',');
-        id = stoi(temp);
-        getline(linestream, temp, ',');
-        value = stof(temp);
-        getline(linestream, temp, ',');
-        value2 = stof(temp);
+        int i = result->matrix.findIndex(stoi(vertex1_str));
+        int j = result->matrix.findIndex(stoi(vertex2_str));
+        if (i == -1 || j == -1 || i == j) continue;
+        Weight w = toWeight(parseWeight(temp));
+        result->matrix.set(i, j, w);
+        result->matrix.set(j, i, w);
+    }
+    alloc.print("readNestedExtraGraphs");
+    result->loadSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    nested = move(result);
+    return nested.get();
+}
 
+void Data::generateFullyConnected(int numNodes, unsigned seed) {
+    TraceSpan span("generateFullyConnected");
+    mt19937 rng(seed);
+    uniform_real_distribution<float> coordinate(0.0f, 100000.0f);
+    for (int id = 0; id < numNodes; id++) {
         graph.addVertex(id);
-        nodesloc.insert(make_pair(id, make_pair(value, value2)));
-        limit--;
+        nodesloc.insert(make_pair(id, make_pair(coordinate(rng), coordinate(rng))));
+    }
+    for (int u = 0; u < numNodes; u++) {
+        for (int v = u + 1; v < numNodes; v++) {
+            double dx = nodesloc[u].first - nodesloc[v].first;
+            double dy = nodesloc[u].second - nodesloc[v].second;
+            double distance = sqrt(dx * dx + dy * dy);
+            graph.addEdge(u, v, distance);
+            graph.addEdge(v, u, distance);
+        }
     }
 }
 
+bool Data::readPrecedencePairs(const string &filename, vector<pair<int, int>> &pairs) {
+    ifstream file(filename);
 
+    if (!file.is_open()) {
+        cerr << "There was an error opening file " << filename << endl;
+        return false;
+    }
 
-
+    string line;
+    bool first = true;
+    while (getline(file, line)) {
+        if (line.empty() || (first && !isdigit((unsigned char) line[0]))) {
+            first = false;
+            continue;
+        }
+        first = false;
+        stringstream linestream(line);
+        string pickup_str, delivery_str;
+        getline(linestream, pickup_str, ',');
+        getline(linestream, delivery_str, ',');
+        pairs.emplace_back(stoi(pickup_str), stoi(delivery_str));
+    }
+    return true;
+}
@@ -7,6 +7,21 @@
 #include <string>
 #include <fstream>
 #include "Graph.h"
+#include "DistanceMatrix.h"
+#include "AllocationTracker.h"
+#include "Trace.h"
+
+/**
+ * @brief The 900-vertex extra graph as one matrix, whose leading k x k views are the nested instances over its
+ * first k nodes
+ * @details These are not the instances of edges_k.csv: the smaller edge files weigh the same node pairs
+ * differently, so only the edges_900 family is nested.
+ */
+struct NestedExtraGraphs {
+    DistanceMatrix matrix;
+    std::unordered_map<int, std::pair<float, float>> nodes;
+    double loadSeconds = 0.0;
+};
 
 class Data {
 public:
@@ -28,6 +43,12 @@ public:
      */
     const Graph<int> &getGraph() const;
 
+    /**
+     * @brief Gets what the load-time compaction of parallel edges removed
+     * @return The compaction report
+     */
+    const EdgeCompaction &getCompaction() const;
+
     /**
      * @brief Reads the extra graphs from the given filename
      * @param filename String indicating the filename
@@ -65,6 +86,32 @@ public:
      */
     void readNodesExtra(const std::string &filename, int limit);
 
+    /**
+     * @brief Gets the nested extra graphs, parsing nodes.csv and edges_900.csv into a matrix on the first call
+     * @details Later calls return the same matrix, so every size is served by DistanceMatrix::leading() without
+     * reading a file. Time complexity: O(V^2) on the first call, O(1) afterwards
+     * @return The nested graphs, or null if the files cannot be read
+     */
+    static const NestedExtraGraphs *getNestedExtraGraphs();
+
+    /**
+     * @brief Generates a fully connected graph over random points in the plane
+     * @details Used by the "random<N>" systems to go beyond the sizes of the extra graphs.
+     * Time complexity: O(V^2), where V is the number of nodes
+     * @param numNodes Integer indicating the number of nodes
+     * @param seed Seed of the random generator
+     */
+    void generateFullyConnected(int numNodes, unsigned seed);
+
+    /**
+     * @brief Reads pickup and delivery pairs of node ids, one "pickup,delivery" line each
+     * @details A first line that does not start with a digit is taken as a header. Time complexity: O(P)
+     * @param filename String indicating the filename
+     * @param pairs Vector to store the pairs
+     * @return False if the file cannot be opened
+     */
+    static bool readPrecedencePairs(const std::string &filename, std::vector<std::pair<int, int>> &pairs);
+
     /**
      * @brief Gets the nodes location
      * @return Map of nodes location
@@ -82,9 +129,7 @@ private:
     Graph<int> graph;
     std::unordered_map<int, std::pair<float, float>> nodesloc;
     std::unordered_map<int, std::string> labels;
-
-
-
+    EdgeCompaction compaction;
 };
 
 #endif //PROJECT_2_DATA_H
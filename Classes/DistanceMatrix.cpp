@@ -0,0 +1,123 @@
+#include "DistanceMatrix.h"
+#include "Graph.h"
+#include "GraphSnapshot.h"
+#include "TourEvaluator.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+DistanceMatrix::DistanceMatrix() : n(0), stride(0), storage(make_shared<vector<Weight>>()), data(nullptr),
+                                   ids(make_shared<vector<int>>()), indexes(make_shared<unordered_map<int, int>>()) {}
+
+DistanceMatrix::DistanceMatrix(int n) : n(n), stride((size_t) n),
+                                        storage(make_shared<vector<Weight>>((size_t) n * n, MISSING_WEIGHT)),
+                                        data(storage->data()), ids(make_shared<vector<int>>(n)),
+                                        indexes(make_shared<unordered_map<int, int>>()) {
+    for (int i = 0; i < n; i++) {
+        (*ids)[i] = i;
+        (*indexes)[i] = i;
+        data[(size_t) i * n + i] = 0;
+    }
+}
+
+DistanceMatrix::DistanceMatrix(const vector<int> &ids) : DistanceMatrix((int) ids.size()) {
+    *this->ids = ids;
+    indexes->clear();
+    for (int i = 0; i < n; i++) {
+        (*indexes)[ids[i]] = i;
+    }
+}
+
+DistanceMatrix DistanceMatrix::leading(int k) const {
+    DistanceMatrix view(*this);
+    view.n = max(0, min(k, n));
+    return view;
+}
+
+void DistanceMatrix::detach() {
+    auto copy = make_shared<vector<Weight>>((size_t) n * n);
+    for (int i = 0; i < n; i++) {
+        copy_n(data + (size_t) i * stride, n, copy->data() + (size_t) i * n);
+    }
+    storage = copy;
+    data = storage->data();
+    stride = (size_t) n;
+}
+
+DistanceMatrix DistanceMatrix::fromGraph(const Graph<int> &g) {
+    vector<Vertex<int> *> vertices = g.getVertexSet();
+    DistanceMatrix m((int) vertices.size());
+    m.indexes->clear();
+    for (int i = 0; i < m.n; i++) {
+        (*m.ids)[i] = vertices[i]->getInfo();
+        (*m.indexes)[(*m.ids)[i]] = i;
+    }
+    vector<bool> seen(m.n);
+    for (int i = 0; i < m.n; i++) {
+        fill(seen.begin(), seen.end(), false);
+        for (auto e: vertices[i]->getAdj()) {
+            int j = (*m.indexes)[e->getDest()->getInfo()];
+            if (!seen[j]) {
+                seen[j] = true;
+                m.set(i, j, toWeight(e->getWeight()));
+            }
+        }
+    }
+    return m;
+}
+
+DistanceMatrix DistanceMatrix::fromSnapshot(const GraphSnapshot &snapshot) {
+    DistanceMatrix m(snapshot.getNumVertex());
+    m.indexes->clear();
+    for (int i = 0; i < m.n; i++) {
+        (*m.ids)[i] = snapshot.getId(i);
+        (*m.indexes)[(*m.ids)[i]] = i;
+    }
+    for (int i = 0; i < m.n; i++) {
+        for (size_t e = snapshot.edgeBegin(i); e < snapshot.edgeEnd(i); e++) {
+            m.set(i, snapshot.getTarget(e), toWeight(snapshot.getWeight(e)));
+        }
+    }
+    return m;
+}
+
+int DistanceMatrix::getId(int i) const {
+    return (*ids)[i];
+}
+
+int DistanceMatrix::findIndex(int id) const {
+    // a view shares the index of the whole matrix, whose vertices past the view are not in it
+    auto it = indexes->find(id);
+    return it == indexes->end() || it->second >= n ? -1 : it->second;
+}
+
+bool DistanceMatrix::isComplete() const {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i != j && at(i, j) == MISSING_WEIGHT) return false;
+        }
+    }
+    return true;
+}
+
+Cost DistanceMatrix::tourCost(const vector<int> &tour) const {
+    return TourEvaluator::tourCost(*this, tour.data(), tour.size());
+}
+
+double DistanceMatrix::haversineDistance(double lat1, double lon1, double lat2, double lon2) {
+    double lat1Rad = lat1 * M_PI / 180.0;
+    double lon1Rad = lon1 * M_PI / 180.0;
+    double lat2Rad = lat2 * M_PI / 180.0;
+    double lon2Rad = lon2 * M_PI / 180.0;
+
+    double dLat = lat2Rad - lat1Rad;
+    double dLon = lon2Rad - lon1Rad;
+    double a = sin(dLat / 2) * sin(dLat / 2) +
+               cos(lat1Rad) * cos(lat2Rad) *
+               sin(dLon / 2) * sin(dLon / 2);
+    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
+    double distance = 6371 * c;
+
+    return distance;
+}
@@ -0,0 +1,177 @@
+#ifndef PROJ2_DISTANCEMATRIX_H
+#define PROJ2_DISTANCEMATRIX_H
+
+#include <vector>
+#include <unordered_map>
+#include <limits>
+#include <memory>
+#include "Weight.h"
+
+template<class T>
+class Graph;
+
+class GraphSnapshot;
+
+/**
+ * @brief Dense n x n matrix of edge weights, indexed by the position of each vertex
+ * @details Gives O(1) weight lookups for the solvers that work on complete instances, instead of the
+ * linear adjacency scans of Graph::getEdgeWeight. Weights are stored as Weight (see Weight.h) and missing
+ * edges as MISSING_WEIGHT. Copies and leading views share the weights until one of them is changed with set(),
+ * which first gives that matrix its own copy (copy-on-write), so a change never shows through another matrix.
+ */
+class DistanceMatrix {
+public:
+    /**
+     * @brief Constructs an empty matrix
+     * @details Time complexity: O(1)
+     */
+    DistanceMatrix();
+
+    /**
+     * @brief Constructs a matrix with n vertices (ids 0..n-1) and no edges
+     * @details Time complexity: O(n^2)
+     * @param n Number of vertices
+     */
+    explicit DistanceMatrix(int n);
+
+    /**
+     * @brief Constructs a matrix with the given vertex ids, indexed in that order, and no edges
+     * @details Time complexity: O(n^2)
+     * @param ids Id of each vertex
+     */
+    explicit DistanceMatrix(const std::vector<int> &ids);
+
+    /**
+     * @brief Builds the matrix of a graph, keeping the first edge of each pair like Graph::getEdgeWeight
+     * @details Time complexity: O(V^2 + E)
+     * @param g Graph
+     * @return The matrix, with vertices in the order of the vertex set
+     */
+    static DistanceMatrix fromGraph(const Graph<int> &g);
+
+    /**
+     * @brief Builds the matrix of a snapshot
+     * @details Time complexity: O(V^2 + E)
+     * @param snapshot Snapshot
+     * @return The matrix, with vertices in the order of the snapshot indices
+     */
+    static DistanceMatrix fromSnapshot(const GraphSnapshot &snapshot);
+
+    /**
+     * @brief Gets the matrix of the first k vertices, without copying any weight
+     * @details The view shares the weights and ids of this matrix, so nested instances (a prefix of the vertex
+     * set of a larger one) are served in constant time. Time complexity: O(1)
+     * @param k Number of vertices, at most size()
+     * @return The leading k x k view
+     */
+    DistanceMatrix leading(int k) const;
+
+    /**
+     * @brief Gets the number of vertices
+     * @details Time complexity: O(1)
+     * @return Number of vertices
+     */
+    int size() const {
+        return n;
+    }
+
+    /**
+     * @brief Gets the distance between the starts of two rows in weights(), which is size() unless this is a view
+     * @details Time complexity: O(1)
+     * @return The row stride
+     */
+    std::size_t rowStride() const {
+        return stride;
+    }
+
+    /**
+     * @brief Gets the weight of the edge between two vertices
+     * @details Time complexity: O(1)
+     * @param i Index of the source
+     * @param j Index of the destination
+     * @return The weight, or MISSING_WEIGHT if there is no edge
+     */
+    Weight at(int i, int j) const {
+        return data[(std::size_t) i * stride + j];
+    }
+
+    /**
+     * @brief Sets the weight of the edge between two vertices
+     * @details Copies the weights first if they are shared with another matrix, so calls on a shared matrix
+     * must not run concurrently. Time complexity: O(1), or O(n^2) for the first call on a shared matrix
+     * @param i Index of the source
+     * @param j Index of the destination
+     * @param w Weight
+     */
+    void set(int i, int j, Weight w) {
+        if (storage.use_count() > 1) detach();
+        data[(std::size_t) i * stride + j] = w;
+    }
+
+    /**
+     * @brief Gets the weights, row by row, for kernels that index the matrix themselves
+     * @details The weight of the edge from i to j is at i * rowStride() + j. Time complexity: O(1)
+     * @return Pointer to the first weight
+     */
+    const Weight *weights() const {
+        return data;
+    }
+
+    /**
+     * @brief Gets the id of the vertex at an index
+     * @details Time complexity: O(1)
+     * @param i Index
+     * @return Id of the vertex
+     */
+    int getId(int i) const;
+
+    /**
+     * @brief Gets the index of the vertex with an id
+     * @details Time complexity: O(1) on average
+     * @param id Id of the vertex
+     * @return Index, or -1 if there is no such vertex
+     */
+    int findIndex(int id) const;
+
+    /**
+     * @brief Checks if every pair of distinct vertices has an edge
+     * @details Time complexity: O(n^2)
+     * @return True if complete
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief Calculates the cost of a closed tour
+     * @details Time complexity: O(n)
+     * @param tour Indices of the vertices in visiting order, without repeating the first one
+     * @return The cost, including the edge back to the first vertex, or INFINITE_COST if an edge is missing
+     */
+    Cost tourCost(const std::vector<int> &tour) const;
+
+    /**
+     * @brief Calculates the great-circle distance between two points with the haversine formula
+     * @details Time complexity: O(1)
+     * @param lat1 Latitude of the first point, in degrees
+     * @param lon1 Longitude of the first point, in degrees
+     * @param lat2 Latitude of the second point, in degrees
+     * @param lon2 Longitude of the second point, in degrees
+     * @return The distance in kilometres
+     */
+    static double haversineDistance(double lat1, double lon1, double lat2, double lon2);
+
+private:
+    int n;
+    std::size_t stride;
+    std::shared_ptr<std::vector<Weight>> storage; // shared with copies and views until set()
+    Weight *data;                                 // first weight of storage
+    std::shared_ptr<std::vector<int>> ids;
+    std::shared_ptr<std::unordered_map<int, int>> indexes; // may hold ids beyond a view, see findIndex()
+
+    /**
+     * @brief Replaces the shared weights by a private, unstrided copy of the n x n block of this matrix
+     * @details Time complexity: O(n^2)
+     */
+    void detach();
+};
+
+#endif //PROJ2_DISTANCEMATRIX_H
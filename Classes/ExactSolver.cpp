@@ -0,0 +1,218 @@
+#include "ExactSolver.h"
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+const int ExactSolver::MAX_DP_VERTICES;
+
+Cost ExactSolver::heldKarp(const DistanceMatrix &m, vector<int> &tour) {
+    return heldKarp(m, tour, CheckpointOptions());
+}
+
+Cost ExactSolver::heldKarp(const DistanceMatrix &m, vector<int> &tour, const CheckpointOptions &options,
+                           const CancellationToken *cancel) {
+    tour.clear();
+    int n = m.size();
+    const Cost inf = INFINITE_COST;
+    if (n == 0 || n > MAX_DP_VERTICES) return inf;
+    if (n == 1) {
+        tour.push_back(0);
+        return 0;
+    }
+
+    // vertex 0 is the start; bit v-1 of a mask stands for vertex v
+    int k = n - 1;
+    size_t numMasks = (size_t) 1 << k;
+    vector<Cost> cost(numMasks * k, inf);
+    vector<int8_t> parent(numMasks * k, -1);
+    auto nextMask = [](size_t mask) {
+        // next mask with the same number of bits (Gosper's hack)
+        size_t lowest = mask & (~mask + 1);
+        size_t ripple = mask + lowest;
+        return (((ripple ^ mask) >> 2) / lowest) | ripple;
+    };
+
+    int firstLayer = 1;
+    Checkpoint checkpoint("heldkarp", m);
+    if (!options.filename.empty() && options.resume && checkpoint.load(options.filename)) {
+        int layer = (int) checkpoint.getInt();
+        bool ok = layer >= 1 && layer <= k && checkpoint.getBytes(parent.data(), parent.size());
+        for (size_t mask = ((size_t) 1 << layer) - 1; ok && mask < numMasks; mask = nextMask(mask)) {
+            ok = checkpoint.getBytes(&cost[mask * k], k * sizeof(Cost));
+        }
+        if (ok && checkpoint.isValid()) {
+            firstLayer = layer;
+        } else {
+            fill(cost.begin(), cost.end(), inf);
+            fill(parent.begin(), parent.end(), -1);
+        }
+    }
+    if (firstLayer == 1) {
+        for (int v = 0; v < k; v++) {
+            if (m.at(0, v + 1) != MISSING_WEIGHT) cost[((size_t) 1 << v) * k + v] = m.at(0, v + 1);
+        }
+    }
+
+    auto saveLayer = [&](int layer) {
+        // a layer only needs the costs of its own subsets and the parents to rebuild the tour
+        Checkpoint snapshot("heldkarp", m);
+        snapshot.putInt(layer);
+        snapshot.putBytes(parent.data(), parent.size());
+        for (size_t mask = ((size_t) 1 << layer) - 1; mask < numMasks; mask = nextMask(mask)) {
+            snapshot.putBytes(&cost[mask * k], k * sizeof(Cost));
+        }
+        snapshot.save(options.filename);
+    };
+
+    CheckpointTimer timer(options);
+    CancellationCheck stop(cancel);
+    for (int layer = firstLayer; layer < k; layer++) {
+        // masks are visited in increasing order within a layer, as in a plain loop over all masks
+        for (size_t mask = ((size_t) 1 << layer) - 1; mask < numMasks; mask = nextMask(mask)) {
+            if (stop.step()) {
+                // the costs of this layer are complete, the next one is recomputed on resume
+                if (!options.filename.empty()) saveLayer(layer);
+                return inf;
+            }
+            for (int last = 0; last < k; last++) {
+                if (!(mask & ((size_t) 1 << last))) continue;
+                Cost current = cost[mask * k + last];
+                if (current == inf) continue;
+                for (int next = 0; next < k; next++) {
+                    if ((mask & ((size_t) 1 << next)) || m.at(last + 1, next + 1) == MISSING_WEIGHT) continue;
+                    Cost candidate = current + m.at(last + 1, next + 1);
+                    size_t state = (mask | ((size_t) 1 << next)) * k + next;
+                    if (candidate < cost[state]) {
+                        cost[state] = candidate;
+                        parent[state] = (int8_t) last;
+                    }
+                }
+            }
+        }
+        if (layer + 1 < k && timer.due()) saveLayer(layer + 1);
+    }
+    if (!options.filename.empty()) Checkpoint::remove(options.filename);
+
+    size_t full = numMasks - 1;
+    Cost best = inf;
+    int last = -1;
+    for (int v = 0; v < k; v++) {
+        if (cost[full * k + v] == inf || m.at(v + 1, 0) == MISSING_WEIGHT) continue;
+        Cost candidate = cost[full * k + v] + m.at(v + 1, 0);
+        if (candidate < best) {
+            best = candidate;
+            last = v;
+        }
+    }
+    if (last == -1) return inf;
+
+    size_t mask = full;
+    while (last != -1) {
+        tour.push_back(last + 1);
+        int previous = parent[mask * k + last];
+        mask &= ~((size_t) 1 << last);
+        last = previous;
+    }
+    tour.push_back(0);
+    std::reverse(tour.begin(), tour.end());
+    return best;
+}
+
+Cost ExactSolver::branchAndBound(const DistanceMatrix &m, int start, vector<int> &tour,
+                                 const CheckpointOptions &options, const CancellationToken *cancel) {
+    tour.clear();
+    int n = m.size();
+    const Cost inf = INFINITE_COST;
+    if (n == 0) return inf;
+    if (n == 1) {
+        tour.push_back(start);
+        return 0;
+    }
+
+    // path[d] is the vertex at depth d and nextChild[d] the first vertex still to try after it
+    vector<int> path = {start};
+    vector<int> nextChild = {0};
+    Cost bestCost = inf;
+    vector<int> bestTour;
+
+    Checkpoint checkpoint("bnb", m);
+    if (!options.filename.empty() && options.resume && checkpoint.load(options.filename)) {
+        vector<int> storedPath = checkpoint.getInts();
+        vector<int> storedNext = checkpoint.getInts();
+        Cost storedCost = inf;
+        checkpoint.getBytes(&storedCost, sizeof(storedCost));
+        vector<int> storedTour = checkpoint.getInts();
+        bool ok = checkpoint.isValid() && !storedPath.empty() && storedPath[0] == start &&
+                  storedPath.size() == storedNext.size() && (int) storedPath.size() <= n;
+        for (size_t d = 0; d < storedPath.size(); d++) {
+            ok = ok && storedPath[d] >= 0 && storedPath[d] < n &&
+                 (d == 0 || m.at(storedPath[d - 1], storedPath[d]) != MISSING_WEIGHT);
+        }
+        if (ok) {
+            path = storedPath;
+            nextChild = storedNext;
+            bestCost = storedCost;
+            bestTour = storedTour;
+        }
+    }
+
+    vector<bool> visited(n, false);
+    vector<Cost> prefix(path.size(), 0);
+    visited[path[0]] = true;
+    for (size_t d = 1; d < path.size(); d++) {
+        visited[path[d]] = true;
+        prefix[d] = prefix[d - 1] + m.at(path[d - 1], path[d]);
+    }
+
+    auto save = [&]() {
+        Checkpoint snapshot("bnb", m);
+        snapshot.putInts(path);
+        snapshot.putInts(nextChild);
+        snapshot.putBytes(&bestCost, sizeof(bestCost));
+        snapshot.putInts(bestTour);
+        snapshot.save(options.filename);
+    };
+
+    CheckpointTimer timer(options);
+    CancellationCheck stop(cancel);
+    while (!path.empty()) {
+        size_t d = path.size() - 1;
+        int last = path[d];
+        if ((int) path.size() == n) {
+            Weight back = m.at(last, start);
+            if (back != MISSING_WEIGHT && prefix[d] + back < bestCost) {
+                bestCost = prefix[d] + back;
+                bestTour = path;
+            }
+        } else {
+            int next = nextChild[d];
+            // bound: weights are non-negative, so a branch that already costs as much as the best tour is cut
+            while (next < n && (visited[next] || m.at(last, next) == MISSING_WEIGHT ||
+                                prefix[d] + m.at(last, next) >= bestCost)) {
+                next++;
+            }
+            if (next < n) {
+                nextChild[d] = next + 1;
+                visited[next] = true;
+                path.push_back(next);
+                nextChild.push_back(0);
+                prefix.push_back(prefix[d] + m.at(last, next));
+                if (timer.step()) save();
+                if (stop.step()) break;
+                continue;
+            }
+        }
+        visited[last] = false;
+        path.pop_back();
+        nextChild.pop_back();
+        prefix.pop_back();
+    }
+    if (!options.filename.empty()) {
+        if (stop.wasCancelled()) save();
+        else Checkpoint::remove(options.filename);
+    }
+
+    tour = bestTour;
+    return bestCost;
+}
@@ -0,0 +1,60 @@
+#ifndef PROJ2_EXACTSOLVER_H
+#define PROJ2_EXACTSOLVER_H
+
+#include <vector>
+#include "DistanceMatrix.h"
+#include "Checkpoint.h"
+#include "Cancellation.h"
+
+/**
+ * @brief Exact solvers over a distance matrix
+ */
+class ExactSolver {
+public:
+    /** Largest instance the dynamic programming solver accepts (its memory grows as 2^n * n) */
+    static const int MAX_DP_VERTICES = 20;
+
+    /**
+     * @brief Finds the optimal tour with the Held-Karp dynamic programming algorithm
+     * @details Missing edges (infinite weights) are never used. Time complexity: O(2^n * n^2), memory O(2^n * n)
+     * @param m Distance matrix with at most MAX_DP_VERTICES vertices
+     * @param tour Vector to store the tour, as matrix indices starting at index 0
+     * @return The cost of the tour, or INFINITE_COST if there is none
+     */
+    static Cost heldKarp(const DistanceMatrix &m, std::vector<int> &tour);
+
+    /**
+     * @brief Finds the optimal tour with Held-Karp, saving its progress to a checkpoint file
+     * @details Subsets are processed by size, and a checkpoint holds the parent table (one byte per state) and
+     * the costs of the next layer of subsets only, instead of the whole cost table.
+     * A matching checkpoint is resumed from and the file is deleted once the search ends. A cancelled search
+     * has no tour yet; it saves a checkpoint of the layer it stopped in, so running it again picks up from there.
+     * Time complexity: O(2^n * n^2)
+     * @param m Distance matrix with at most MAX_DP_VERTICES vertices
+     * @param tour Vector to store the tour, as matrix indices starting at index 0
+     * @param options Checkpoint file and interval
+     * @param cancel Token that stops the search, or null
+     * @return The cost of the tour, or INFINITE_COST if there is none or the search was cancelled
+     */
+    static Cost heldKarp(const DistanceMatrix &m, std::vector<int> &tour, const CheckpointOptions &options,
+                         const CancellationToken *cancel = nullptr);
+
+    /**
+     * @brief Finds the optimal tour by depth-first branch and bound
+     * @details Vertices are tried in index order and a branch is cut as soon as its cost reaches the best tour
+     * found. The search keeps an explicit stack, which is what a checkpoint stores together with the best tour,
+     * so a resumed search continues exactly where it stopped. A cancelled search returns the best tour found so
+     * far and saves a checkpoint. Time complexity: O(n!) in the worst case
+     * @param m Distance matrix
+     * @param start Index of the first vertex
+     * @param tour Vector to store the tour, as matrix indices starting at start
+     * @param options Checkpoint file and interval
+     * @param cancel Token that stops the search, or null
+     * @return The cost of the tour, or INFINITE_COST if there is none (or none was found before cancellation)
+     */
+    static Cost branchAndBound(const DistanceMatrix &m, int start, std::vector<int> &tour,
+                                 const CheckpointOptions &options = CheckpointOptions(),
+                                 const CancellationToken *cancel = nullptr);
+};
+
+#endif //PROJ2_EXACTSOLVER_H
@@ -1,13 +1,16 @@
 #ifndef DA_TP_CLASSES_GRAPH
 #define DA_TP_CLASSES_GRAPH
 
-#include <iostream>
 #include <vector>
+#include <string>
 #include <queue>
 #include <limits>
 #include <algorithm>
 #include <cmath>
 #include <stack>
+#include <unordered_map>
+#include "MutablePriorityQueue.h"
+#include "ThreadPool.h"
 
 
 template<class T>
@@ -57,6 +60,10 @@ public:
 
     void removeOutgoingEdges();
 
+    std::vector<Edge<T> *> removeParallelEdges();
+
+    void forgetRemovedEdges();
+
     //friend class MutablePriorityQueue<Vertex>;
     int queueIndex = 0;
 protected:
@@ -90,6 +97,8 @@ public:
 
     bool isSelected() const;
 
+    bool isRemoved() const;
+
     Vertex<T> *getOrig() const;
 
     Edge<T> *getReverse() const;
@@ -98,6 +107,8 @@ public:
 
     void setSelected(bool selected);
 
+    void setRemoved(bool removed);
+
     void setReverse(Edge<T> *reverse);
 
     void setFlow(double flow);
@@ -108,6 +119,7 @@ protected:
 
     // auxiliary fields
     bool selected = false;
+    bool removed = false; // set by Graph::compactEdges on the edges it is about to delete
 
     // used for bidirectional edges
     Vertex<T> *orig;
@@ -118,6 +130,15 @@ protected:
 
 /********************** Graph  ****************************/
 
+/*
+ * Outcome of Graph::compactEdges.
+ */
+struct EdgeCompaction {
+    std::size_t edgesBefore = 0;  // outgoing edges before the compaction
+    std::size_t edgesRemoved = 0; // parallel edges deleted
+    std::size_t bytesFreed = 0;   // edge objects and their entries in the outgoing and incoming lists
+};
+
 template<class T>
 class Graph {
 public:
@@ -168,9 +189,22 @@ public:
 
     std::vector<Edge<T>> kruskalMST(const T &source);
 
+    /*
+     * Computes the shortest distance from the source to every vertex, leaving it in the dist field
+     * and the last edge of the path in the path field (infinity / nullptr if unreachable).
+     * Returns false if the source does not exist.
+     */
+    bool dijkstra(const T &source);
+
 
     double getEdgeWeight(const T &source, const T &destination) const;
 
+    /*
+     * Keeps only the lightest edge between each ordered pair of vertices, sorting the outgoing edges of the
+     * vertices in parallel on a pool. The kept edges stay in their original order.
+     */
+    EdgeCompaction compactEdges(ThreadPool &pool = ThreadPool::shared());
+
 
 protected:
     std::vector<Vertex<T> *> vertexSet;    // vertex set
@@ -251,6 +285,64 @@ void Vertex<T>::removeOutgoingEdges() {
     }
 }
 
+/*
+ * Auxiliary function to keep a single outgoing edge, the lightest, to each destination of a vertex (this).
+ * The removed edges are returned without being deleted, and are still in the incoming lists of their destinations.
+ */
+template<class T>
+std::vector<Edge<T> *> Vertex<T>::removeParallelEdges() {
+    std::vector<Edge<T> *> removed;
+    // edges are grouped by destination address, which needs no lookups; ties keep the list order
+    std::vector<std::pair<Vertex<T> *, size_t>> order(adj.size());
+    for (size_t k = 0; k < adj.size(); k++) {
+        order[k] = std::make_pair(adj[k]->getDest(), k);
+    }
+    std::sort(order.begin(), order.end());
+    std::vector<bool> keep(adj.size(), true);
+    for (size_t first = 0; first < order.size();) {
+        size_t last = first + 1, lightest = order[first].second;
+        while (last < order.size() && order[last].first == order[first].first) {
+            if (adj[order[last].second]->getWeight() < adj[lightest]->getWeight()) lightest = order[last].second;
+            last++;
+        }
+        for (size_t k = first; k < last; k++) {
+            if (order[k].second != lightest) {
+                keep[order[k].second] = false;
+                adj[order[k].second]->setRemoved(true);
+                removed.push_back(adj[order[k].second]);
+            }
+        }
+        first = last;
+    }
+    if (removed.empty()) return removed;
+    size_t kept = 0;
+    for (size_t k = 0; k < adj.size(); k++) {
+        if (keep[k]) adj[kept++] = adj[k];
+    }
+    adj.resize(kept);
+    return removed;
+}
+
+/*
+ * Auxiliary function to drop the edges marked as removed from the incoming list of a vertex (this), and to point
+ * the reverse of its outgoing edges away from them.
+ */
+template<class T>
+void Vertex<T>::forgetRemovedEdges() {
+    incoming.erase(std::remove_if(incoming.begin(), incoming.end(), [](Edge<T> *e) {
+        return e->isRemoved();
+    }), incoming.end());
+    for (auto e: adj) {
+        if (e->getReverse() == nullptr || !e->getReverse()->isRemoved()) continue;
+        // the kept edge back from the destination takes over, if there is one
+        Edge<T> *reverse = nullptr;
+        for (auto back: e->getDest()->adj) {
+            if (back->getDest() == this) reverse = back;
+        }
+        e->setReverse(reverse);
+    }
+}
+
 template<class T>
 bool Vertex<T>::operator<(Vertex<T> &vertex) const {
     return this->dist < vertex.dist;
@@ -371,6 +463,11 @@ bool Edge<T>::isSelected() const {
     return this->selected;
 }
 
+template<class T>
+bool Edge<T>::isRemoved() const {
+    return this->removed;
+}
+
 template<class T>
 double Edge<T>::getFlow() const {
     return flow;
@@ -381,6 +478,11 @@ void Edge<T>::setSelected(bool selected) {
     this->selected = selected;
 }
 
+template<class T>
+void Edge<T>::setRemoved(bool removed) {
+    this->removed = removed;
+}
+
 template<class T>
 void Edge<T>::setReverse(Edge<T> *reverse) {
     this->reverse = reverse;
@@ -737,6 +839,39 @@ std::vector<Edge<T>> Graph<T>::kruskalMST(const T &source) {
     return result;
 }
 
+template<class T>
+bool Graph<T>::dijkstra(const T &source) {
+    auto s = findVertex(source);
+    if (s == nullptr) {
+        return false;
+    }
+    const double inf = std::numeric_limits<double>::infinity();
+    for (auto v: vertexSet) {
+        v->setDist(inf);
+        v->setPath(nullptr);
+    }
+    s->setDist(0);
+    MutablePriorityQueue<Vertex<T>> q;
+    q.insert(s);
+    while (!q.empty()) {
+        auto v = q.extractMin();
+        for (auto e: v->getAdj()) {
+            auto w = e->getDest();
+            double oldDist = w->getDist();
+            if (v->getDist() + e->getWeight() < oldDist) {
+                w->setDist(v->getDist() + e->getWeight());
+                w->setPath(e);
+                if (oldDist == inf) {
+                    q.insert(w);
+                } else {
+                    q.decreaseKey(w);
+                }
+            }
+        }
+    }
+    return true;
+}
+
 template<class T>
 double Graph<T>::getEdgeWeight(const T &source, const T &destination) const {
     Vertex<T> *v = findVertex(source);
@@ -752,6 +887,39 @@ double Graph<T>::getEdgeWeight(const T &source, const T &destination) const {
 
 }
 
+template<class T>
+EdgeCompaction Graph<T>::compactEdges(ThreadPool &pool) {
+    EdgeCompaction result;
+    std::vector<std::vector<Edge<T> *>> removed(vertexSet.size());
+    std::vector<size_t> degree(vertexSet.size());
+    // each vertex only rewrites its own outgoing list
+    pool.parallelFor(0, vertexSet.size(), 64, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            removed[i] = vertexSet[i]->removeParallelEdges();
+            degree[i] = vertexSet[i]->getAdj().size() + removed[i].size();
+        }
+    });
+    for (size_t i = 0; i < vertexSet.size(); i++) {
+        result.edgesBefore += degree[i];
+        result.edgesRemoved += removed[i].size();
+    }
+    result.bytesFreed = result.edgesRemoved * (sizeof(Edge<T>) + 2 * sizeof(Edge<T> *));
+    if (result.edgesRemoved == 0) return result;
+
+    // the marks are only read from here on, and each vertex rewrites its own incoming list
+    pool.parallelFor(0, vertexSet.size(), 64, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            vertexSet[i]->forgetRemovedEdges();
+        }
+    });
+    for (const auto &edges: removed) {
+        for (auto e: edges) {
+            delete e;
+        }
+    }
+    return result;
+}
+
 inline void deleteMatrix(int **m, int n) {
     if (m != nullptr) {
         for (int i = 0; i < n; i++)
@@ -0,0 +1,231 @@
+#include "GraphSnapshot.h"
+#include "Graph.h"
+#include "GraphStatistics.h"
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+void GraphDelta::setBidirectionalWeight(int u, int v, double w) {
+    weightUpdates.push_back(make_pair(make_pair(u, v), w));
+    weightUpdates.push_back(make_pair(make_pair(v, u), w));
+}
+
+bool GraphDelta::empty() const {
+    return addedVertices.empty() && weightUpdates.empty() && removedEdges.empty();
+}
+
+GraphSnapshot::GraphSnapshot() : version(0), offsets(1, 0) {}
+
+GraphSnapshot GraphSnapshot::fromGraph(const Graph<int> &g) {
+    GraphSnapshot snapshot;
+    vector<Vertex<int> *> vertices = g.getVertexSet();
+    for (auto v: vertices) {
+        snapshot.indexes[v->getInfo()] = (int) snapshot.ids.size();
+        snapshot.ids.push_back(v->getInfo());
+    }
+
+    vector<vector<pair<int, double>>> adjacency(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        for (auto e: vertices[i]->getAdj()) {
+            adjacency[i].push_back(make_pair(snapshot.indexes[e->getDest()->getInfo()], e->getWeight()));
+        }
+    }
+    snapshot.build(adjacency);
+    return snapshot;
+}
+
+GraphSnapshot GraphSnapshot::applyDelta(const GraphDelta &delta) const {
+    GraphSnapshot next;
+    next.version = version + 1;
+    next.ids = ids;
+    next.indexes = indexes;
+    for (int id: delta.addedVertices) {
+        if (next.indexes.find(id) == next.indexes.end()) {
+            next.indexes[id] = (int) next.ids.size();
+            next.ids.push_back(id);
+        }
+    }
+
+    vector<vector<pair<int, double>>> adjacency(next.ids.size());
+    for (int i = 0; i < getNumVertex(); i++) {
+        for (size_t e = edgeBegin(i); e < edgeEnd(i); e++) {
+            adjacency[i].push_back(make_pair(targets[e], weights[e]));
+        }
+    }
+
+    for (const auto &removed: delta.removedEdges) {
+        int u = next.findIndex(removed.first);
+        int v = next.findIndex(removed.second);
+        if (u == -1 || v == -1) continue;
+        auto &adj = adjacency[u];
+        adj.erase(remove_if(adj.begin(), adj.end(), [v](const pair<int, double> &p) {
+            return p.first == v;
+        }), adj.end());
+    }
+
+    for (const auto &update: delta.weightUpdates) {
+        int u = next.findIndex(update.first.first);
+        int v = next.findIndex(update.first.second);
+        if (u == -1 || v == -1) continue;
+        auto &adj = adjacency[u];
+        bool found = false;
+        for (auto &p: adj) {
+            if (p.first == v) {
+                p.second = update.second;
+                found = true;
+            }
+        }
+        if (!found) adj.push_back(make_pair(v, update.second));
+    }
+
+    next.build(adjacency);
+    return next;
+}
+
+void GraphSnapshot::build(vector<vector<pair<int, double>>> &adjacency) {
+    offsets.assign(1, 0);
+    targets.clear();
+    weights.clear();
+    for (auto &adj: adjacency) {
+        // parallel edges are collapsed, keeping the first one like Graph::getEdgeWeight does
+        stable_sort(adj.begin(), adj.end(), [](const pair<int, double> &a, const pair<int, double> &b) {
+            return a.first < b.first;
+        });
+        for (size_t k = 0; k < adj.size(); k++) {
+            if (k > 0 && adj[k].first == adj[k - 1].first) continue;
+            targets.push_back(adj[k].first);
+            weights.push_back(adj[k].second);
+        }
+        offsets.push_back(targets.size());
+    }
+}
+
+unsigned long GraphSnapshot::getVersion() const {
+    return version;
+}
+
+int GraphSnapshot::getNumVertex() const {
+    return (int) ids.size();
+}
+
+size_t GraphSnapshot::getNumEdges() const {
+    return targets.size();
+}
+
+int GraphSnapshot::getId(int index) const {
+    return ids[index];
+}
+
+int GraphSnapshot::findIndex(int id) const {
+    auto it = indexes.find(id);
+    if (it == indexes.end()) return -1;
+    return it->second;
+}
+
+size_t GraphSnapshot::edgeBegin(int index) const {
+    return offsets[index];
+}
+
+size_t GraphSnapshot::edgeEnd(int index) const {
+    return offsets[index + 1];
+}
+
+int GraphSnapshot::getTarget(size_t e) const {
+    return targets[e];
+}
+
+double GraphSnapshot::getWeight(size_t e) const {
+    return weights[e];
+}
+
+double GraphSnapshot::getEdgeWeight(int source, int dest) const {
+    auto first = targets.begin() + offsets[source];
+    auto last = targets.begin() + offsets[source + 1];
+    auto it = lower_bound(first, last, dest);
+    if (it == last || *it != dest) {
+        return numeric_limits<double>::infinity();
+    }
+    return weights[it - targets.begin()];
+}
+
+const GraphStatistics &GraphSnapshot::getStatistics() const {
+    shared_ptr<const GraphStatistics> cached = atomic_load(&statistics);
+    if (!cached) {
+        shared_ptr<const GraphStatistics> computed = make_shared<GraphStatistics>(GraphStatistics::compute(*this));
+        // a thread that lost the race returns the result of the winner
+        if (atomic_compare_exchange_strong(&statistics, &cached, computed)) cached = computed;
+    }
+    return *cached;
+}
+
+namespace {
+    const char SNAPSHOT_MAGIC[4] = {'P', '2', 'G', 'S'};
+    const uint32_t SNAPSHOT_FORMAT = 1;
+
+    template<class T>
+    void append(vector<char> &out, const T *values, size_t count) {
+        const char *bytes = (const char *) values;
+        out.insert(out.end(), bytes, bytes + count * sizeof(T));
+    }
+
+    template<class T>
+    bool extract(const vector<char> &in, size_t &position, T *values, size_t count) {
+        if (count > (in.size() - position) / sizeof(T)) return false;
+        memcpy(values, in.data() + position, count * sizeof(T));
+        position += count * sizeof(T);
+        return true;
+    }
+}
+
+vector<char> GraphSnapshot::serialize() const {
+    vector<char> out;
+    uint64_t numVertices = ids.size(), numEdges = targets.size(), v = version;
+    vector<uint64_t> wideOffsets(offsets.begin(), offsets.end());
+    append(out, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    append(out, &SNAPSHOT_FORMAT, 1);
+    append(out, &v, 1);
+    append(out, &numVertices, 1);
+    append(out, &numEdges, 1);
+    append(out, ids.data(), ids.size());
+    append(out, wideOffsets.data(), wideOffsets.size());
+    append(out, targets.data(), targets.size());
+    append(out, weights.data(), weights.size());
+    return out;
+}
+
+bool GraphSnapshot::deserialize(const vector<char> &data, GraphSnapshot &snapshot) {
+    size_t position = 0;
+    char magic[4];
+    uint32_t format;
+    uint64_t v, numVertices, numEdges;
+    if (!extract(data, position, magic, 4) || memcmp(magic, SNAPSHOT_MAGIC, 4) != 0) return false;
+    if (!extract(data, position, &format, 1) || format != SNAPSHOT_FORMAT) return false;
+    if (!extract(data, position, &v, 1) || !extract(data, position, &numVertices, 1) ||
+        !extract(data, position, &numEdges, 1)) return false;
+    if (numVertices > data.size() || numEdges > data.size()) return false;
+
+    GraphSnapshot result;
+    result.version = (unsigned long) v;
+    result.ids.resize(numVertices);
+    vector<uint64_t> wideOffsets(numVertices + 1);
+    result.targets.resize(numEdges);
+    result.weights.resize(numEdges);
+    if (!extract(data, position, result.ids.data(), numVertices) ||
+        !extract(data, position, wideOffsets.data(), numVertices + 1) ||
+        !extract(data, position, result.targets.data(), numEdges) ||
+        !extract(data, position, result.weights.data(), numEdges)) return false;
+    if (wideOffsets[0] != 0 || wideOffsets[numVertices] != numEdges) return false;
+    for (uint64_t i = 0; i < numVertices; i++) {
+        if (wideOffsets[i] > wideOffsets[i + 1]) return false;
+    }
+    for (int t: result.targets) {
+        if (t < 0 || (uint64_t) t >= numVertices) return false;
+    }
+    result.offsets.assign(wideOffsets.begin(), wideOffsets.end());
+    for (size_t i = 0; i < result.ids.size(); i++) {
+        result.indexes[result.ids[i]] = (int) i;
+    }
+    snapshot = move(result);
+    return true;
+}
@@ -0,0 +1,193 @@
+#ifndef PROJ2_GRAPHSNAPSHOT_H
+#define PROJ2_GRAPHSNAPSHOT_H
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+#include <memory>
+
+template<class T>
+class Graph;
+
+struct GraphStatistics;
+
+/**
+ * @brief Set of changes to be applied on top of a snapshot to build the next version
+ */
+struct GraphDelta {
+    /** Ids of the vertices (stops) to add */
+    std::vector<int> addedVertices;
+    /** Edges to insert or whose weight is to be replaced, as (source, destination, weight) */
+    std::vector<std::pair<std::pair<int, int>, double>> weightUpdates;
+    /** Edges to remove, as (source, destination) */
+    std::vector<std::pair<int, int>> removedEdges;
+
+    /**
+     * @brief Sets the weight of an edge in both directions
+     * @details Time complexity: O(1)
+     * @param u Id of the first vertex
+     * @param v Id of the second vertex
+     * @param w New weight
+     */
+    void setBidirectionalWeight(int u, int v, double w);
+
+    /**
+     * @brief Checks if the delta has no changes
+     * @details Time complexity: O(1)
+     * @return True if there is nothing to apply
+     */
+    bool empty() const;
+};
+
+/**
+ * @brief Immutable compressed (CSR) view of a graph
+ * @details Vertices are addressed by a dense index in [0, n). The outgoing edges of each vertex are
+ * stored contiguously and sorted by destination index, so lookups are O(log d). A snapshot is never
+ * modified after being built, so it can be read by any number of threads without synchronisation.
+ */
+class GraphSnapshot {
+public:
+    /**
+     * @brief Builds an empty snapshot
+     * @details Time complexity: O(1)
+     */
+    GraphSnapshot();
+
+    /**
+     * @brief Builds a snapshot with the vertices and edges of a graph
+     * @details Time complexity: O(V + ElogE), where V is the number of vertices and E is the number of edges
+     * @param g Graph to be copied
+     * @return The snapshot
+     */
+    static GraphSnapshot fromGraph(const Graph<int> &g);
+
+    /**
+     * @brief Builds the next version of this snapshot with a delta applied
+     * @details Time complexity: O(V + ElogE), this snapshot is left untouched
+     * @param delta Changes to apply
+     * @return The new snapshot, with version one above this one
+     */
+    GraphSnapshot applyDelta(const GraphDelta &delta) const;
+
+    /**
+     * @brief Gets the version of the snapshot
+     * @details Time complexity: O(1)
+     * @return Version number, starting at 0
+     */
+    unsigned long getVersion() const;
+
+    /**
+     * @brief Gets the number of vertices
+     * @details Time complexity: O(1)
+     * @return Number of vertices
+     */
+    int getNumVertex() const;
+
+    /**
+     * @brief Gets the number of directed edges
+     * @details Time complexity: O(1)
+     * @return Number of edges
+     */
+    std::size_t getNumEdges() const;
+
+    /**
+     * @brief Gets the id of the vertex with a given index
+     * @details Time complexity: O(1)
+     * @param index Dense index of the vertex
+     * @return Id of the vertex
+     */
+    int getId(int index) const;
+
+    /**
+     * @brief Gets the index of the vertex with a given id
+     * @details Time complexity: O(1) on average
+     * @param id Id of the vertex
+     * @return Dense index of the vertex, or -1 if it does not exist
+     */
+    int findIndex(int id) const;
+
+    /**
+     * @brief Gets the position of the first outgoing edge of a vertex
+     * @details Time complexity: O(1). The edges of vertex i are in [edgeBegin(i), edgeEnd(i))
+     * @param index Dense index of the vertex
+     * @return Edge position
+     */
+    std::size_t edgeBegin(int index) const;
+
+    /**
+     * @brief Gets the position after the last outgoing edge of a vertex
+     * @details Time complexity: O(1)
+     * @param index Dense index of the vertex
+     * @return Edge position
+     */
+    std::size_t edgeEnd(int index) const;
+
+    /**
+     * @brief Gets the destination index of the edge at a given position
+     * @details Time complexity: O(1)
+     * @param e Edge position
+     * @return Dense index of the destination vertex
+     */
+    int getTarget(std::size_t e) const;
+
+    /**
+     * @brief Gets the weight of the edge at a given position
+     * @details Time complexity: O(1)
+     * @param e Edge position
+     * @return Weight of the edge
+     */
+    double getWeight(std::size_t e) const;
+
+    /**
+     * @brief Gets the weight of the edge between two vertices given by index
+     * @details Time complexity: O(log d), where d is the out-degree of the source
+     * @param source Dense index of the source vertex
+     * @param dest Dense index of the destination vertex
+     * @return The weight of the edge, or infinity if there is no such edge
+     */
+    double getEdgeWeight(int source, int dest) const;
+
+    /**
+     * @brief Gets the statistics of the snapshot, computed on the shared thread pool on first use
+     * @details Later calls, from any thread, return the cached result. A version built by applyDelta() starts
+     * without one. Time complexity: that of GraphStatistics::compute() the first time, O(1) afterwards
+     * @return The statistics, valid as long as the snapshot
+     */
+    const GraphStatistics &getStatistics() const;
+
+    /**
+     * @brief Encodes the snapshot in a compact binary form
+     * @details The CSR arrays are written as they are, with fixed-width values in host byte order, so decoding
+     * is little more than a copy. Time complexity: O(V + E)
+     * @return The encoded snapshot
+     */
+    std::vector<char> serialize() const;
+
+    /**
+     * @brief Decodes a snapshot written by serialize()
+     * @details Time complexity: O(V + E)
+     * @param data Encoded snapshot
+     * @param snapshot Snapshot to store the result
+     * @return True if the data is a valid snapshot
+     */
+    static bool deserialize(const std::vector<char> &data, GraphSnapshot &snapshot);
+
+private:
+    unsigned long version;
+    std::vector<int> ids;
+    std::unordered_map<int, int> indexes;
+    std::vector<std::size_t> offsets;
+    std::vector<int> targets;
+    std::vector<double> weights;
+    mutable std::shared_ptr<const GraphStatistics> statistics; // read and set with the atomic shared_ptr functions
+
+    /**
+     * @brief Builds the CSR arrays from per-vertex adjacency lists
+     * @details Time complexity: O(V + ElogE)
+     * @param adjacency Outgoing (destination index, weight) pairs of each vertex, sorted in place
+     */
+    void build(std::vector<std::vector<std::pair<int, double>>> &adjacency);
+};
+
+#endif //PROJ2_GRAPHSNAPSHOT_H
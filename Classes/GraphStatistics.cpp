@@ -0,0 +1,253 @@
+#include "GraphStatistics.h"
+#include "GraphSnapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace std;
+
+namespace {
+    // results of the degree and weight pass over a chunk of vertices
+    struct EdgePass {
+        int minDegree = numeric_limits<int>::max();
+        int maxDegree = 0;
+        size_t selfLoops = 0;
+        size_t reversed = 0;  // pairs of opposite edges
+        size_t asymmetric = 0;
+        size_t finiteWeights = 0;
+        double minWeight = numeric_limits<double>::infinity();
+        double maxWeight = -numeric_limits<double>::infinity();
+        double weightSum = 0.0;
+        vector<size_t> histogram;
+    };
+
+    struct TriangleSample {
+        int sampled = 0;
+        int violations = 0;
+    };
+
+    int degreeBucket(int degree) {
+        int bucket = 0;
+        for (; degree > 0; degree >>= 1) {
+            bucket++;
+        }
+        return bucket;
+    }
+
+    int findRoot(vector<atomic<int>> &parent, int v) {
+        // path halving; a parent never has a larger index than its child, so concurrent updates keep the forest valid
+        while (true) {
+            int p = parent[v].load();
+            if (p == v) return v;
+            int grandparent = parent[p].load();
+            if (grandparent != p) parent[v].compare_exchange_weak(p, grandparent);
+            v = grandparent;
+        }
+    }
+
+    void unite(vector<atomic<int>> &parent, int u, int v) {
+        while (true) {
+            u = findRoot(parent, u);
+            v = findRoot(parent, v);
+            if (u == v) return;
+            if (u < v) swap(u, v);
+            // fails if another thread linked u meanwhile, in which case the roots are looked up again
+            int expected = u;
+            if (parent[u].compare_exchange_strong(expected, v)) return;
+        }
+    }
+
+    /**
+     * @brief Breadth-first search over the outgoing edges
+     * @param s Snapshot
+     * @param source Index of the first vertex
+     * @param hops Vector to store the number of edges to each vertex, -1 if unreachable
+     * @return The farthest vertex found
+     */
+    int farthestVertex(const GraphSnapshot &s, int source, vector<int> &hops) {
+        hops.assign(s.getNumVertex(), -1);
+        vector<int> frontier(1, source), next;
+        hops[source] = 0;
+        int last = source;
+        while (!frontier.empty()) {
+            next.clear();
+            for (int u: frontier) {
+                for (size_t e = s.edgeBegin(u); e < s.edgeEnd(u); e++) {
+                    int v = s.getTarget(e);
+                    if (hops[v] != -1) continue;
+                    hops[v] = hops[u] + 1;
+                    next.push_back(v);
+                }
+            }
+            if (!next.empty()) last = next.front();
+            frontier.swap(next);
+        }
+        return last;
+    }
+}
+
+GraphStatistics GraphStatistics::compute(const GraphSnapshot &snapshot, ThreadPool &pool, unsigned seed) {
+    auto begin = chrono::steady_clock::now();
+    GraphStatistics stats;
+    int n = snapshot.getNumVertex();
+    stats.numVertices = n;
+    stats.numEdges = snapshot.getNumEdges();
+    if (n == 0) return stats;
+    stats.density = n > 1 ? (double) stats.numEdges / ((double) n * (n - 1)) : 0.0;
+    const size_t grain = 1024;
+
+    // degrees, edge symmetry and weight range
+    EdgePass edges = pool.parallelReduce((size_t) 0, (size_t) n, grain, EdgePass(), [&](size_t first, size_t last) {
+        EdgePass pass;
+        for (int u = (int) first; u < (int) last; u++) {
+            int degree = (int) (snapshot.edgeEnd(u) - snapshot.edgeBegin(u));
+            pass.minDegree = min(pass.minDegree, degree);
+            pass.maxDegree = max(pass.maxDegree, degree);
+            size_t bucket = degreeBucket(degree);
+            if (pass.histogram.size() <= bucket) pass.histogram.resize(bucket + 1, 0);
+            pass.histogram[bucket]++;
+            for (size_t e = snapshot.edgeBegin(u); e < snapshot.edgeEnd(u); e++) {
+                int v = snapshot.getTarget(e);
+                double w = snapshot.getWeight(e);
+                if (v == u) pass.selfLoops++;
+                // each pair of opposite edges is looked up once, from its smaller end
+                if (v > u) {
+                    double reverse = snapshot.getEdgeWeight(v, u);
+                    if (!std::isinf(reverse)) pass.reversed++;
+                    if (!std::isinf(reverse) && reverse != w) pass.asymmetric += 2;
+                }
+                if (std::isinf(w)) continue;
+                pass.finiteWeights++;
+                pass.minWeight = min(pass.minWeight, w);
+                pass.maxWeight = max(pass.maxWeight, w);
+                pass.weightSum += w;
+            }
+        }
+        return pass;
+    }, [](EdgePass a, const EdgePass &b) {
+        a.minDegree = min(a.minDegree, b.minDegree);
+        a.maxDegree = max(a.maxDegree, b.maxDegree);
+        a.selfLoops += b.selfLoops;
+        a.reversed += b.reversed;
+        a.asymmetric += b.asymmetric;
+        a.finiteWeights += b.finiteWeights;
+        a.minWeight = min(a.minWeight, b.minWeight);
+        a.maxWeight = max(a.maxWeight, b.maxWeight);
+        a.weightSum += b.weightSum;
+        if (a.histogram.size() < b.histogram.size()) a.histogram.resize(b.histogram.size(), 0);
+        for (size_t i = 0; i < b.histogram.size(); i++) {
+            a.histogram[i] += b.histogram[i];
+        }
+        return a;
+    });
+    stats.minDegree = edges.minDegree;
+    stats.maxDegree = edges.maxDegree;
+    stats.meanDegree = (double) stats.numEdges / n;
+    stats.degreeHistogram = edges.histogram;
+    stats.selfLoops = edges.selfLoops;
+    // a snapshot has no parallel edges, so every edge outside a pair and not a loop is one-way
+    stats.oneWayEdges = stats.numEdges - edges.selfLoops - 2 * edges.reversed;
+    stats.asymmetricEdges = edges.asymmetric;
+
+    // weakly connected components
+    vector<atomic<int>> parent(n);
+    for (int v = 0; v < n; v++) {
+        parent[v].store(v);
+    }
+    pool.parallelFor(0, (size_t) n, grain, [&](size_t first, size_t last) {
+        for (int u = (int) first; u < (int) last; u++) {
+            for (size_t e = snapshot.edgeBegin(u); e < snapshot.edgeEnd(u); e++) {
+                unite(parent, u, snapshot.getTarget(e));
+            }
+        }
+    });
+    vector<int> size(n, 0);
+    for (int v = 0; v < n; v++) {
+        size[findRoot(parent, v)]++;
+    }
+    int largestRoot = 0;
+    for (int v = 0; v < n; v++) {
+        if (size[v] > 0) stats.componentSizes.push_back(size[v]);
+        if (size[v] > size[largestRoot]) largestRoot = v;
+    }
+    sort(stats.componentSizes.rbegin(), stats.componentSizes.rend());
+
+    // diameter: each double sweep goes from a random vertex of the largest component to the farthest vertex,
+    // and from there to the farthest again; the deepest second sweep is the bound
+    vector<int> members;
+    for (int v = 0; v < n; v++) {
+        if (findRoot(parent, v) == largestRoot) members.push_back(v);
+    }
+    const int sweeps = 4;
+    mt19937 rng(seed);
+    vector<int> starts(sweeps);
+    for (int &s: starts) {
+        s = members[uniform_int_distribution<size_t>(0, members.size() - 1)(rng)];
+    }
+    vector<int> depth(sweeps, 0);
+    pool.parallelFor(0, sweeps, 1, [&](size_t first, size_t last) {
+        vector<int> hops;
+        for (size_t i = first; i < last; i++) {
+            int far = farthestVertex(snapshot, starts[i], hops);
+            far = farthestVertex(snapshot, far, hops);
+            depth[i] = hops[far];
+        }
+    });
+    stats.diameterHops = *max_element(depth.begin(), depth.end());
+
+    // metricity: random pairs of edges u-i, u-k closed by an edge i-k, sampled in fixed chunks
+    const int chunks = 64, attemptsPerChunk = 2000;
+    TriangleSample triangles = pool.parallelReduce((size_t) 0, (size_t) chunks, 1, TriangleSample(),
+                                                   [&](size_t first, size_t) {
+        TriangleSample sample;
+        mt19937 chunkRng(seed + 1 + (unsigned) first);
+        uniform_int_distribution<int> pickVertex(0, n - 1);
+        for (int attempt = 0; attempt < attemptsPerChunk; attempt++) {
+            int u = pickVertex(chunkRng);
+            size_t degree = snapshot.edgeEnd(u) - snapshot.edgeBegin(u);
+            if (degree < 2) continue;
+            uniform_int_distribution<size_t> pickEdge(snapshot.edgeBegin(u), snapshot.edgeEnd(u) - 1);
+            size_t a = pickEdge(chunkRng), b = pickEdge(chunkRng);
+            int i = snapshot.getTarget(a), k = snapshot.getTarget(b);
+            if (i == k || i == u || k == u) continue;
+            double direct = snapshot.getEdgeWeight(i, k);
+            if (std::isinf(direct)) continue;
+            sample.sampled++;
+            if (direct > snapshot.getWeight(a) + snapshot.getWeight(b) + 1e-6) sample.violations++;
+        }
+        return sample;
+    }, [](TriangleSample a, const TriangleSample &b) {
+        a.sampled += b.sampled;
+        a.violations += b.violations;
+        return a;
+    });
+    stats.sampledTriangles = triangles.sampled;
+    if (triangles.sampled > 0) stats.metricViolationRate = (double) triangles.violations / triangles.sampled;
+
+    // weight distribution; each selection only looks at the part above the previous one
+    if (edges.finiteWeights > 0) {
+        stats.minWeight = edges.minWeight;
+        stats.maxWeight = edges.maxWeight;
+        stats.meanWeight = edges.weightSum / (double) edges.finiteWeights;
+        vector<double> weights;
+        weights.reserve(edges.finiteWeights);
+        for (size_t e = 0; e < stats.numEdges; e++) {
+            if (!std::isinf(snapshot.getWeight(e))) weights.push_back(snapshot.getWeight(e));
+        }
+        auto from = weights.begin();
+        double *targets[] = {&stats.weightP50, &stats.weightP90, &stats.weightP99};
+        double fractions[] = {0.50, 0.90, 0.99};
+        for (int p = 0; p < 3; p++) {
+            auto nth = weights.begin() + (ptrdiff_t) (fractions[p] * (double) (weights.size() - 1));
+            nth_element(from, nth, weights.end());
+            *targets[p] = *nth;
+            from = nth;
+        }
+    }
+
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    return stats;
+}
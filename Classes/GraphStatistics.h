@@ -0,0 +1,57 @@
+#ifndef PROJ2_GRAPHSTATISTICS_H
+#define PROJ2_GRAPHSTATISTICS_H
+
+#include <vector>
+#include <cstddef>
+#include "ThreadPool.h"
+
+class GraphSnapshot;
+
+/**
+ * @brief Summary of a network, used to size it up before picking algorithms
+ * @details Degrees count outgoing edges, and components treat every edge as undirected.
+ */
+struct GraphStatistics {
+    int numVertices = 0;
+    std::size_t numEdges = 0;        // directed edges
+    double density = 0.0;            // edges over n * (n - 1)
+    std::size_t selfLoops = 0;
+    std::size_t oneWayEdges = 0;     // edges without a reverse edge
+    std::size_t asymmetricEdges = 0; // edges whose reverse edge has another weight
+
+    int minDegree = 0;
+    int maxDegree = 0;
+    double meanDegree = 0.0;
+    std::vector<std::size_t> degreeHistogram; // entry 0 counts degree 0, entry b the degrees in [2^(b-1), 2^b)
+
+    std::vector<int> componentSizes; // weakly connected components, largest first
+
+    double minWeight = 0.0;
+    double maxWeight = 0.0;
+    double meanWeight = 0.0;
+    double weightP50 = 0.0;
+    double weightP90 = 0.0;
+    double weightP99 = 0.0;
+
+    int sampledTriangles = 0;
+    double metricViolationRate = 0.0; // share of sampled triangles u-i, u-k whose edge i-k is longer than the detour
+
+    int diameterHops = 0;   // lower bound on the diameter of the largest component, in edges, from double sweeps
+    double seconds = 0.0;   // time taken by compute()
+
+    /**
+     * @brief Computes the statistics of a snapshot, spreading every pass over the threads of a pool
+     * @details Components are found with a lock-free union-find, the diameter with a few double-sweep BFS run
+     * side by side, and metricity by sampling triangles in fixed chunks, so the result does not depend on the
+     * number of threads. Time complexity: O((V + E) / p + ElogD / p + E), the last term for the weight
+     * percentiles, where p is the number of threads and D the largest degree
+     * @param snapshot Snapshot
+     * @param pool Pool that runs the passes
+     * @param seed Seed of the triangle sampling and of the sweep starts
+     * @return The statistics
+     */
+    static GraphStatistics compute(const GraphSnapshot &snapshot, ThreadPool &pool = ThreadPool::shared(),
+                                   unsigned seed = 42);
+};
+
+#endif //PROJ2_GRAPHSTATISTICS_H
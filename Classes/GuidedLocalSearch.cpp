@@ -0,0 +1,126 @@
+#include "GuidedLocalSearch.h"
+#include "LocalSearch.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+
+using namespace std;
+
+vector<int> GuidedLocalSearch::solve(const DistanceMatrix &m, int start, const GuidedLocalSearchConfig &config,
+                                     const CancellationToken *cancel, GuidedLocalSearchReport *report) {
+    GuidedLocalSearchReport local;
+    GuidedLocalSearchReport &r = report ? *report : local;
+    r = GuidedLocalSearchReport();
+    int n = m.size();
+    auto begin = chrono::steady_clock::now();
+    auto elapsed = [&]() { return chrono::duration<double>(chrono::steady_clock::now() - begin).count(); };
+    if (n < 5) {
+        vector<int> tour = LocalSearch::solve(m, start, LocalSearchConfig(), 42);
+        r.initialCost = r.bestCost = m.tourCost(tour);
+        return tour;
+    }
+
+    // the start is a plain 2-opt local optimum, where the penalties are still all zero
+    vector<vector<int>> candidates = LocalSearch::candidateLists(m, max(1, config.candidates));
+    vector<int> tour = LocalSearch::nearestNeighbour(m, start);
+    r.moves = LocalSearch::twoOpt(m, candidates, tour);
+    Cost current = m.tourCost(tour);
+    r.initialCost = r.bestCost = current;
+    r.trace.emplace_back(elapsed(), current);
+    vector<int> best = tour;
+    if (current >= INFINITE_COST) {
+        // the start uses a missing edge, so lambda and the augmented costs would not be finite
+        r.seconds = elapsed();
+        return best;
+    }
+
+    PenaltyMatrix penalties(n);
+    const double lambda = config.alpha * (double) current / n;
+    const double epsilon = 1e-6;
+    auto augmented = [&](int i, int j) { return (double) m.at(i, j) + lambda * penalties.get(i, j); };
+
+    vector<int> position(n);
+    for (int k = 0; k < n; k++) {
+        position[tour[k]] = k;
+    }
+    // vertices whose don't-look bit is off
+    deque<int> active;
+    vector<bool> queued(n, false);
+    auto wake = [&](int city) {
+        if (!queued[city]) {
+            queued[city] = true;
+            active.push_back(city);
+        }
+    };
+
+    CancellationCheck stop(cancel);
+    long visits = 0;
+    bool outOfTime = false;
+    while (true) {
+        // 2-opt on the augmented cost, from the vertices woken up by the last penalties
+        while (!active.empty() && !stop.step()) {
+            // the budget is also checked here, like the token, in case the descent takes long to converge
+            if ((++visits & 1023) == 0 && elapsed() >= config.seconds) {
+                outOfTime = true;
+                break;
+            }
+            int a = active.front();
+            active.pop_front();
+            queued[a] = false;
+
+            bool improved = false;
+            for (int direction = 0; direction < 2 && !improved; direction++) {
+                int pa = position[a];
+                int b = direction == 0 ? tour[(pa + 1) % n] : tour[(pa - 1 + n) % n];
+                double removedAB = augmented(a, b);
+                for (int c: candidates[a]) {
+                    // the weight bounds the augmented cost from below, and the candidates only get farther
+                    if (removedAB - (double) m.at(a, c) <= epsilon) break;
+                    double gainFirst = removedAB - augmented(a, c);
+                    if (gainFirst <= epsilon) continue;
+                    int pc = position[c];
+                    int d = direction == 0 ? tour[(pc + 1) % n] : tour[(pc - 1 + n) % n];
+                    if (c == b || d == a) continue;
+                    if (gainFirst + augmented(c, d) - augmented(b, d) <= epsilon) continue;
+                    // a->b ... c->d becomes a->c ... b->d
+                    current += (Cost) m.at(a, c) + m.at(b, d) - m.at(a, b) - m.at(c, d);
+                    if (direction == 0) LocalSearch::reverse(tour, position, position[b], position[c]);
+                    else LocalSearch::reverse(tour, position, position[c], position[b]);
+                    r.moves++;
+                    wake(a);
+                    wake(b);
+                    wake(c);
+                    wake(d);
+                    improved = true;
+                    break;
+                }
+            }
+        }
+        if (stop.wasCancelled()) break;
+
+        if (!outOfTime) r.localMinima++;
+        if (current < r.bestCost - COST_EPSILON) {
+            r.bestCost = current;
+            best = tour;
+            r.trace.emplace_back(elapsed(), current);
+        }
+        if (outOfTime || stop.now() || elapsed() >= config.seconds) break;
+
+        // penalise the tour edges of largest utility and look around their ends again
+        double maxUtility = 0.0;
+        for (int k = 0; k < n; k++) {
+            int i = tour[k], j = tour[(k + 1) % n];
+            maxUtility = max(maxUtility, (double) m.at(i, j) / (1.0 + penalties.get(i, j)));
+        }
+        for (int k = 0; k < n; k++) {
+            int i = tour[k], j = tour[(k + 1) % n];
+            if ((double) m.at(i, j) / (1.0 + penalties.get(i, j)) < maxUtility) continue;
+            penalties.increment(i, j);
+            r.penalties++;
+            wake(i);
+            wake(j);
+        }
+    }
+    r.seconds = elapsed();
+    return best;
+}
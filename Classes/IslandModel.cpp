@@ -0,0 +1,328 @@
+#include "IslandModel.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <algorithm>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include "DistanceMatrix.h"
+#include "LocalSearch.h"
+#include "Trace.h"
+
+using namespace std;
+
+namespace {
+    enum MessageType : uint32_t {
+        SNAPSHOT = 1,
+        TOUR = 2,
+        BEST = 3,
+        STOP = 4
+    };
+
+    const double EPSILON = 1e-9;
+    // largest frame accepted, so a corrupt length cannot trigger a huge allocation
+    const uint64_t MAX_FRAME = (uint64_t) 1 << 32;
+
+    bool sendAll(int fd, const char *data, size_t size) {
+        while (size > 0) {
+            ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+            if (sent <= 0) return false;
+            data += sent;
+            size -= (size_t) sent;
+        }
+        return true;
+    }
+
+    bool receiveAll(int fd, char *data, size_t size) {
+        while (size > 0) {
+            ssize_t received = recv(fd, data, size, 0);
+            if (received <= 0) return false;
+            data += received;
+            size -= (size_t) received;
+        }
+        return true;
+    }
+
+    bool sendFrame(int fd, uint32_t type, const vector<char> &payload) {
+        char header[12];
+        uint64_t length = payload.size();
+        memcpy(header, &type, 4);
+        memcpy(header + 4, &length, 8);
+        return sendAll(fd, header, sizeof(header)) && sendAll(fd, payload.data(), payload.size());
+    }
+
+    bool receiveFrame(int fd, uint32_t &type, vector<char> &payload) {
+        char header[12];
+        uint64_t length;
+        if (!receiveAll(fd, header, sizeof(header))) return false;
+        memcpy(&type, header, 4);
+        memcpy(&length, header + 4, 8);
+        if (length > MAX_FRAME) return false;
+        payload.resize(length);
+        return receiveAll(fd, payload.data(), length);
+    }
+
+    vector<char> encodeTour(double cost, const vector<int> &tour) {
+        vector<char> payload(sizeof(double) + sizeof(uint32_t) + tour.size() * sizeof(int32_t));
+        uint32_t count = (uint32_t) tour.size();
+        memcpy(payload.data(), &cost, sizeof(double));
+        memcpy(payload.data() + sizeof(double), &count, sizeof(uint32_t));
+        for (size_t i = 0; i < tour.size(); i++) {
+            int32_t v = tour[i];
+            memcpy(payload.data() + sizeof(double) + sizeof(uint32_t) + i * sizeof(int32_t), &v, sizeof(int32_t));
+        }
+        return payload;
+    }
+
+    bool decodeTour(const vector<char> &payload, int n, double &cost, vector<int> &tour) {
+        uint32_t count;
+        if (payload.size() < sizeof(double) + sizeof(uint32_t)) return false;
+        memcpy(&cost, payload.data(), sizeof(double));
+        memcpy(&count, payload.data() + sizeof(double), sizeof(uint32_t));
+        if ((int) count != n || payload.size() != sizeof(double) + sizeof(uint32_t) + count * sizeof(int32_t)) {
+            return false;
+        }
+        // a tour must visit every vertex exactly once
+        tour.resize(count);
+        vector<bool> seen(n, false);
+        for (uint32_t i = 0; i < count; i++) {
+            int32_t v;
+            memcpy(&v, payload.data() + sizeof(double) + sizeof(uint32_t) + i * sizeof(int32_t), sizeof(int32_t));
+            if (v < 0 || v >= n || seen[v]) return false;
+            seen[v] = true;
+            tour[i] = v;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Connected worker, as seen by the coordinator
+     */
+    struct WorkerLink {
+        int fd;
+        int id;
+        int toursReceived;
+    };
+}
+
+double IslandModel::coordinate(const GraphSnapshot &snapshot, const IslandOptions &options, vector<int> &tour,
+                               const CancellationToken *cancel) {
+    TraceSpan span("islandCoordinate");
+    tour.clear();
+    const double inf = numeric_limits<double>::infinity();
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        cerr << "Could not create the coordinator socket" << endl;
+        return inf;
+    }
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((uint16_t) options.port);
+    socklen_t addressLength = sizeof(address);
+    if (bind(listener, (sockaddr *) &address, sizeof(address)) != 0 || listen(listener, 16) != 0 ||
+        getsockname(listener, (sockaddr *) &address, &addressLength) != 0) {
+        cerr << "Could not listen on port " << options.port << endl;
+        close(listener);
+        return inf;
+    }
+    int port = ntohs(address.sin_port);
+    cout << "Coordinator listening on port " << port << endl;
+
+    vector<pid_t> children;
+    string portArgument = to_string(port);
+    for (int w = 0; w < options.localWorkers; w++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(listener);
+            execl("/proc/self/exe", "proj2", "island-worker", "127.0.0.1", portArgument.c_str(), (char *) nullptr);
+            _exit(127);
+        }
+        if (pid > 0) children.push_back(pid);
+    }
+
+    DistanceMatrix m = DistanceMatrix::fromSnapshot(snapshot);
+    vector<char> encodedSnapshot = snapshot.serialize();
+    int n = m.size();
+    double bestCost = inf;
+    int nextId = 0, toursReceived = 0, migrations = 0;
+    vector<WorkerLink> workers;
+
+    auto start = chrono::steady_clock::now();
+    auto elapsed = [&start]() {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    // the poll wakes up at least every 100 ms, and a Ctrl-C interrupts it, so the token is seen promptly
+    while (elapsed() < options.seconds && !(cancel && cancel->isCancelled())) {
+        vector<pollfd> fds = {{listener, POLLIN, 0}};
+        for (const auto &w: workers) {
+            fds.push_back({w.fd, POLLIN, 0});
+        }
+        int timeout = (int) max(1.0, min(100.0, (options.seconds - elapsed()) * 1000));
+        if (poll(fds.data(), fds.size(), timeout) <= 0) continue;
+
+        size_t polled = workers.size();
+        vector<WorkerLink> joined;
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd >= 0) {
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+                WorkerLink link = {fd, nextId++, 0};
+                // every worker gets its own random stream
+                vector<char> payload(3 * sizeof(uint32_t));
+                uint32_t settings[3] = {(uint32_t) (1000 + link.id), (uint32_t) options.epochKicks,
+                                        (uint32_t) options.candidates};
+                memcpy(payload.data(), settings, sizeof(settings));
+                payload.insert(payload.end(), encodedSnapshot.begin(), encodedSnapshot.end());
+                bool ok = sendFrame(fd, SNAPSHOT, payload);
+                if (ok && bestCost < inf) ok = sendFrame(fd, BEST, encodeTour(bestCost, tour));
+                if (ok) {
+                    joined.push_back(link);
+                    cout << "Worker " << link.id << " joined" << endl;
+                } else close(fd);
+            }
+        }
+
+        vector<WorkerLink> alive;
+        int improvedBy = -1;
+        for (size_t i = 0; i < polled; i++) {
+            WorkerLink &w = workers[i];
+            short events = fds[i + 1].revents;
+            if (!(events & (POLLIN | POLLHUP | POLLERR))) {
+                alive.push_back(w);
+                continue;
+            }
+            uint32_t type;
+            vector<char> payload;
+            double cost;
+            vector<int> candidate;
+            if (!receiveFrame(w.fd, type, payload)) {
+                cout << "Worker " << w.id << " left" << endl;
+                close(w.fd);
+                continue;
+            }
+            alive.push_back(w);
+            if (type != TOUR || !decodeTour(payload, n, cost, candidate)) continue;
+            alive.back().toursReceived++;
+            toursReceived++;
+            // the reported cost is not trusted
+            cost = toDouble(m.tourCost(candidate));
+            if (cost < bestCost - EPSILON) {
+                bestCost = cost;
+                tour = candidate;
+                cout << fixed << setprecision(3) << "[" << elapsed() << " s] worker " << w.id << " improved the best to "
+                     << setprecision(2) << bestCost << endl;
+                improvedBy = w.id;
+            }
+        }
+        alive.insert(alive.end(), joined.begin(), joined.end());
+        workers = alive;
+        // one broadcast per round, once the workers that left are dropped and those that joined are added
+        if (improvedBy != -1) {
+            vector<char> best = encodeTour(bestCost, tour);
+            for (const auto &other: workers) {
+                if (other.id != improvedBy && sendFrame(other.fd, BEST, best)) migrations++;
+            }
+        }
+    }
+
+    for (const auto &w: workers) {
+        sendFrame(w.fd, STOP, vector<char>());
+        close(w.fd);
+    }
+    close(listener);
+    for (pid_t pid: children) {
+        waitpid(pid, nullptr, 0);
+    }
+    cout << "Workers: " << nextId << ", tours received: " << toursReceived << ", migrations sent: " << migrations
+         << endl;
+    return bestCost;
+}
+
+int IslandModel::work(const string &host, int port) {
+    addrinfo hints{}, *result = nullptr;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), to_string(port).c_str(), &hints, &result) != 0) {
+        cerr << "Could not resolve " << host << endl;
+        return 1;
+    }
+    int fd = -1;
+    for (addrinfo *a = result; a != nullptr && fd < 0; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(result);
+    if (fd < 0) {
+        cerr << "Could not connect to " << host << ":" << port << endl;
+        return 1;
+    }
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+    uint32_t type;
+    vector<char> payload;
+    uint32_t settings[3];
+    GraphSnapshot snapshot;
+    if (!receiveFrame(fd, type, payload) || type != SNAPSHOT || payload.size() < sizeof(settings)) {
+        close(fd);
+        return 1;
+    }
+    memcpy(settings, payload.data(), sizeof(settings));
+    if (!GraphSnapshot::deserialize(vector<char>(payload.begin() + sizeof(settings), payload.end()), snapshot)) {
+        cerr << "Invalid snapshot received" << endl;
+        close(fd);
+        return 1;
+    }
+
+    DistanceMatrix m = DistanceMatrix::fromSnapshot(snapshot);
+    int n = m.size();
+    mt19937 rng(settings[0]);
+    vector<vector<int>> candidates = LocalSearch::candidateLists(m, (int) settings[2]);
+    vector<int> tour = LocalSearch::nearestNeighbour(m, (int) (settings[0] % max(1, n)));
+    LocalSearch::twoOpt(m, candidates, tour);
+    double cost = toDouble(m.tourCost(tour));
+    double sentCost = numeric_limits<double>::infinity();
+
+    while (true) {
+        if (cost < sentCost - EPSILON) {
+            if (!sendFrame(fd, TOUR, encodeTour(cost, tour))) break;
+            sentCost = cost;
+        }
+        bool stop = false;
+        pollfd p = {fd, POLLIN, 0};
+        // tiny instances cannot be kicked, so just wait for the coordinator
+        int timeout = n < 8 ? -1 : 0;
+        while (!stop && poll(&p, 1, timeout) > 0) {
+            double bestCost;
+            vector<int> best;
+            if (!receiveFrame(fd, type, payload) || type == STOP) stop = true;
+            else if (type == BEST && decodeTour(payload, n, bestCost, best)) {
+                bestCost = toDouble(m.tourCost(best));
+                if (bestCost < cost - EPSILON) {
+                    tour = best;
+                    cost = bestCost;
+                    sentCost = cost;
+                }
+            }
+        }
+        if (stop) break;
+        cost = toDouble(LocalSearch::iterate(m, candidates, tour, (int) settings[1], rng));
+    }
+    close(fd);
+    return 0;
+}
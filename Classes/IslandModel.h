@@ -0,0 +1,57 @@
+#ifndef PROJ2_ISLANDMODEL_H
+#define PROJ2_ISLANDMODEL_H
+
+#include <string>
+#include <vector>
+#include "GraphSnapshot.h"
+#include "Cancellation.h"
+
+/**
+ * @brief Settings of an island-model run
+ */
+struct IslandOptions {
+    int localWorkers = 4;   // worker processes started on this machine
+    double seconds = 10.0;  // duration of the run
+    int port = 0;           // listening port, 0 lets the system choose
+    int epochKicks = 50;    // kicks a worker runs between two exchanges
+    int candidates = 10;    // candidate list length of the workers
+};
+
+/**
+ * @brief Island-model local search spread over worker processes connected by TCP
+ * @details The coordinator sends every worker the binary graph snapshot, and each worker runs iterated local
+ * search on its own random stream. Workers report their best tour after each epoch that improved it; the
+ * coordinator keeps the global best and sends it to the other workers, which adopt it when it beats
+ * their own (migration). Workers on other machines join with 'proj2 island-worker <host> <port>'.
+ *
+ * Messages are frames of a 4-byte type and an 8-byte length followed by the payload, in host byte order:
+ * SNAPSHOT (seed, epoch kicks, candidates, serialized snapshot), TOUR and BEST (cost, vertex count,
+ * tour as snapshot indices) and STOP.
+ */
+class IslandModel {
+public:
+    /**
+     * @brief Runs the coordinator, starting the local workers and exchanging tours until the time is up or the
+     * token fires
+     * @details Time complexity: O(W * (S + T * n)), where W is the number of workers, S the size of the snapshot
+     * and T the number of tours received
+     * @param snapshot Instance to solve, which must be complete
+     * @param options Settings of the run
+     * @param tour Vector to store the best tour, as snapshot indices
+     * @param cancel Token that ends the run before the time is up, or null
+     * @return The cost of the best tour, or infinity if no worker reported one
+     */
+    static double coordinate(const GraphSnapshot &snapshot, const IslandOptions &options, std::vector<int> &tour,
+                             const CancellationToken *cancel = nullptr);
+
+    /**
+     * @brief Runs a worker until the coordinator stops it or goes away
+     * @details Time complexity: O(n^2) to start, then O(n + k * m) per kick
+     * @param host Address of the coordinator
+     * @param port Port of the coordinator
+     * @return Exit status
+     */
+    static int work(const std::string &host, int port);
+};
+
+#endif //PROJ2_ISLANDMODEL_H
@@ -0,0 +1,127 @@
+#include "LatencyHistogram.h"
+#include <iomanip>
+#include <limits>
+#include <cmath>
+
+using namespace std;
+
+const int LatencyHistogram::SUB_BUCKETS;
+
+namespace {
+    const int SUB_BITS = 6; // log2(SUB_BUCKETS)
+    const int NUM_BUCKETS = (64 - SUB_BITS + 1) * LatencyHistogram::SUB_BUCKETS;
+
+    int highestBit(uint64_t value) {
+        return 63 - __builtin_clzll(value);
+    }
+}
+
+LatencyHistogram::LatencyHistogram() : counts(NUM_BUCKETS, 0), count(0), min(numeric_limits<uint64_t>::max()),
+                                       max(0), sum(0.0) {}
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < (uint64_t) SUB_BUCKETS) return (int) value;
+    int exponent = highestBit(value);
+    return (exponent - SUB_BITS + 1) * SUB_BUCKETS + (int) ((value >> (exponent - SUB_BITS)) - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < SUB_BUCKETS) return (uint64_t) index;
+    int exponent = index / SUB_BUCKETS + SUB_BITS - 1;
+    uint64_t sub = (uint64_t) (index % SUB_BUCKETS);
+    uint64_t lower = (SUB_BUCKETS + sub) << (exponent - SUB_BITS);
+    return lower + ((1ULL << (exponent - SUB_BITS)) - 1);
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    counts[bucketIndex(nanoseconds)]++;
+    count++;
+    sum += (double) nanoseconds;
+    if (nanoseconds < min) min = nanoseconds;
+    if (nanoseconds > max) max = nanoseconds;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < counts.size(); i++) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    if (other.min < min) min = other.min;
+    if (other.max > max) max = other.max;
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    return count;
+}
+
+uint64_t LatencyHistogram::getMin() const {
+    return count == 0 ? 0 : min;
+}
+
+uint64_t LatencyHistogram::getMax() const {
+    return max;
+}
+
+double LatencyHistogram::getMean() const {
+    return count == 0 ? 0.0 : sum / (double) count;
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    if (count == 0) return 0;
+    uint64_t rank = (uint64_t) ceil(percentile / 100.0 * (double) count);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            uint64_t bound = bucketUpperBound((int) i);
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
+
+void LatencyHistogram::print(const string &label) const {
+    ios state(nullptr);
+    state.copyfmt(cout);
+    cout << left << setw(22) << label << right << fixed << setprecision(3)
+         << " n=" << setw(6) << count
+         << " p50=" << setw(10) << getPercentile(50) / 1e3
+         << " p90=" << setw(10) << getPercentile(90) / 1e3
+         << " p99=" << setw(10) << getPercentile(99) / 1e3
+         << " p99.9=" << setw(10) << getPercentile(99.9) / 1e3
+         << " max=" << setw(10) << getMax() / 1e3 << " (us)" << endl;
+    cout.copyfmt(state);
+}
+
+void LatencyHistogram::write(ostream &out) const {
+    size_t nonEmpty = 0;
+    for (uint64_t c: counts) {
+        if (c != 0) nonEmpty++;
+    }
+    out << "histogram " << SUB_BUCKETS << " " << count << " " << getMin() << " " << max << " "
+        << setprecision(17) << sum << " " << nonEmpty << "\n";
+    for (size_t i = 0; i < counts.size(); i++) {
+        if (counts[i] != 0) out << i << " " << counts[i] << "\n";
+    }
+}
+
+bool LatencyHistogram::read(istream &in) {
+    string tag;
+    int subBuckets;
+    size_t nonEmpty;
+    LatencyHistogram h;
+    uint64_t minValue;
+    if (!(in >> tag >> subBuckets >> h.count >> minValue >> h.max >> h.sum >> nonEmpty)) return false;
+    if (tag != "histogram" || subBuckets != SUB_BUCKETS) return false;
+    h.min = h.count == 0 ? numeric_limits<uint64_t>::max() : minValue;
+    for (size_t k = 0; k < nonEmpty; k++) {
+        size_t index;
+        uint64_t c;
+        if (!(in >> index >> c) || index >= h.counts.size()) return false;
+        h.counts[index] = c;
+    }
+    *this = h;
+    return true;
+}
@@ -0,0 +1,123 @@
+#ifndef PROJ2_LATENCYHISTOGRAM_H
+#define PROJ2_LATENCYHISTOGRAM_H
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+/**
+ * @brief Histogram of latencies in nanoseconds with log-linear buckets
+ * @details Every power of two is split into SUB_BUCKETS linear buckets, so any recorded value is
+ * reported with a relative error below 1/SUB_BUCKETS, while the whole 64-bit range fits in a few
+ * thousand counters. Recording is not thread-safe: each thread records into its own histogram and
+ * the results are merged.
+ */
+class LatencyHistogram {
+public:
+    /** Number of linear buckets per power of two */
+    static const int SUB_BUCKETS = 64;
+
+    /**
+     * @brief Constructs an empty histogram
+     * @details Time complexity: O(B), where B is the number of buckets
+     */
+    LatencyHistogram();
+
+    /**
+     * @brief Records a value
+     * @details Time complexity: O(1)
+     * @param nanoseconds Latency to record
+     */
+    void record(uint64_t nanoseconds);
+
+    /**
+     * @brief Adds all the values of another histogram to this one
+     * @details Time complexity: O(B)
+     * @param other Histogram to merge
+     */
+    void merge(const LatencyHistogram &other);
+
+    /**
+     * @brief Gets the number of recorded values
+     * @details Time complexity: O(1)
+     * @return Number of values
+     */
+    uint64_t getCount() const;
+
+    /**
+     * @brief Gets the smallest recorded value
+     * @details Time complexity: O(1)
+     * @return Minimum, or 0 if empty
+     */
+    uint64_t getMin() const;
+
+    /**
+     * @brief Gets the largest recorded value
+     * @details Time complexity: O(1)
+     * @return Maximum, or 0 if empty
+     */
+    uint64_t getMax() const;
+
+    /**
+     * @brief Gets the mean of the recorded values
+     * @details Time complexity: O(1)
+     * @return Mean, or 0 if empty
+     */
+    double getMean() const;
+
+    /**
+     * @brief Gets the value below which a given percentage of the recorded values fall
+     * @details Time complexity: O(B). The result is the upper bound of the bucket, capped at the maximum
+     * @param percentile Percentage in [0, 100]
+     * @return The percentile, or 0 if empty
+     */
+    uint64_t getPercentile(double percentile) const;
+
+    /**
+     * @brief Prints a one-line summary with p50, p90, p99, p99.9 and max
+     * @details Time complexity: O(B)
+     * @param label Name of the measured query
+     */
+    void print(const std::string &label) const;
+
+    /**
+     * @brief Writes the histogram in a compact text format that read() understands
+     * @details Time complexity: O(B)
+     * @param out Output stream
+     */
+    void write(std::ostream &out) const;
+
+    /**
+     * @brief Reads a histogram written by write()
+     * @details Time complexity: O(B)
+     * @param in Input stream
+     * @return True if a histogram was read
+     */
+    bool read(std::istream &in);
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    double sum;
+
+    /**
+     * @brief Gets the bucket of a value
+     * @details Time complexity: O(1)
+     * @param value Value
+     * @return Index of the bucket
+     */
+    static int bucketIndex(uint64_t value);
+
+    /**
+     * @brief Gets the largest value that falls in a bucket
+     * @details Time complexity: O(1)
+     * @param index Index of the bucket
+     * @return Upper bound of the bucket
+     */
+    static uint64_t bucketUpperBound(int index);
+};
+
+#endif //PROJ2_LATENCYHISTOGRAM_H
@@ -0,0 +1,227 @@
+#include "LocalSearch.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+using namespace std;
+
+vector<int> LocalSearch::nearestNeighbour(const DistanceMatrix &m, int start) {
+    int n = m.size();
+    vector<int> tour;
+    if (n == 0) return tour;
+    vector<bool> visited(n, false);
+    tour.push_back(start);
+    visited[start] = true;
+    int current = start;
+    for (int step = 1; step < n; step++) {
+        Weight minDist = MISSING_WEIGHT;
+        int next = -1;
+        for (int j = 0; j < n; j++) {
+            if (!visited[j] && (next == -1 || m.at(current, j) < minDist)) {
+                minDist = m.at(current, j);
+                next = j;
+            }
+        }
+        tour.push_back(next);
+        visited[next] = true;
+        current = next;
+    }
+    return tour;
+}
+
+vector<vector<int>> LocalSearch::candidateLists(const DistanceMatrix &m, int k) {
+    int n = m.size();
+    k = min(k, n - 1);
+    vector<vector<int>> lists(n);
+    ThreadPool::shared().parallelFor(0, (size_t) n, 64, [&](size_t first, size_t last) {
+        vector<int> others;
+        for (int i = (int) first; i < (int) last; i++) {
+            others.clear();
+            for (int j = 0; j < n; j++) {
+                if (j != i) others.push_back(j);
+            }
+            partial_sort(others.begin(), others.begin() + k, others.end(), [&](int a, int b) {
+                return m.at(i, a) < m.at(i, b);
+            });
+            lists[i].assign(others.begin(), others.begin() + k);
+        }
+    });
+    return lists;
+}
+
+void LocalSearch::reverse(vector<int> &tour, vector<int> &position, int from, int to) {
+    int n = (int) tour.size();
+    int length = (to - from + n) % n + 1;
+    if (2 * length > n) {
+        // reversing the complement gives the same cycle with less work
+        int newFrom = (to + 1) % n;
+        to = (from - 1 + n) % n;
+        from = newFrom;
+        length = n - length;
+    }
+    for (int k = 0; k < length / 2; k++) {
+        int a = tour[from], b = tour[to];
+        tour[from] = b;
+        position[b] = from;
+        tour[to] = a;
+        position[a] = to;
+        from = (from + 1) % n;
+        to = (to - 1 + n) % n;
+    }
+}
+
+long LocalSearch::twoOpt(const DistanceMatrix &m, const vector<vector<int>> &candidates, vector<int> &tour) {
+    return twoOpt(m, candidates, tour, tour);
+}
+
+long LocalSearch::twoOpt(const DistanceMatrix &m, const vector<vector<int>> &candidates, vector<int> &tour,
+                         const vector<int> &start, const CancellationToken *cancel) {
+    if (tour.size() < 4) return 0;
+    TwoOptState state;
+    twoOptBegin(tour, start, state);
+    if (!cancel) {
+        twoOptStep(m, candidates, tour, state, numeric_limits<long>::max());
+        return state.moves;
+    }
+    // in slices, so that the token is polled without touching the inner loop
+    const long visitsPerCheck = 1 << 12;
+    while (!twoOptStep(m, candidates, tour, state, visitsPerCheck) && !cancel->isCancelled()) {}
+    return state.moves;
+}
+
+void LocalSearch::twoOptBegin(const vector<int> &tour, const vector<int> &start, TwoOptState &state) {
+    int n = (int) tour.size();
+    state.position.assign(n, 0);
+    for (int k = 0; k < n; k++) {
+        state.position[tour[k]] = k;
+    }
+    state.active.clear();
+    state.queued.assign(n, false);
+    state.moves = 0;
+    for (int city: start) {
+        if (!state.queued[city]) {
+            state.queued[city] = true;
+            state.active.push_back(city);
+        }
+    }
+}
+
+bool LocalSearch::twoOptStep(const DistanceMatrix &m, const vector<vector<int>> &candidates, vector<int> &tour,
+                             TwoOptState &state, long maxVisits) {
+    int n = (int) tour.size();
+    if (n < 4) return true;
+    // cities whose don't-look bit is off
+    deque<int> &active = state.active;
+    vector<bool> &queued = state.queued;
+    vector<int> &position = state.position;
+    auto wake = [&](int city) {
+        if (!queued[city]) {
+            queued[city] = true;
+            active.push_back(city);
+        }
+    };
+
+    for (long visits = 0; !active.empty() && visits < maxVisits; visits++) {
+        int a = active.front();
+        active.pop_front();
+        queued[a] = false;
+
+        bool improved = false;
+        for (int direction = 0; direction < 2 && !improved; direction++) {
+            int pa = position[a];
+            int b = direction == 0 ? tour[(pa + 1) % n] : tour[(pa - 1 + n) % n];
+            Cost removedAB = m.at(a, b);
+            for (int c: candidates[a]) {
+                Cost gainFirst = removedAB - m.at(a, c);
+                if (gainFirst <= COST_EPSILON) break;
+                int pc = position[c];
+                int d = direction == 0 ? tour[(pc + 1) % n] : tour[(pc - 1 + n) % n];
+                if (c == b || d == a) continue;
+                Cost gain = gainFirst + m.at(c, d) - m.at(b, d);
+                if (gain > COST_EPSILON) {
+                    // a->b ... c->d becomes a->c ... b->d
+                    if (direction == 0) reverse(tour, position, position[b], position[c]);
+                    else reverse(tour, position, position[c], position[b]);
+                    state.moves++;
+                    wake(a);
+                    wake(b);
+                    wake(c);
+                    wake(d);
+                    improved = true;
+                    break;
+                }
+            }
+        }
+    }
+    return active.empty();
+}
+
+vector<int> LocalSearch::doubleBridge(vector<int> &tour, mt19937 &rng) {
+    int n = (int) tour.size();
+    // three distinct cut points in 1..n-1 split the tour into four non-empty segments
+    vector<int> cuts;
+    while (cuts.size() < 3) {
+        int c = uniform_int_distribution<int>(1, n - 1)(rng);
+        if (find(cuts.begin(), cuts.end(), c) == cuts.end()) cuts.push_back(c);
+    }
+    sort(cuts.begin(), cuts.end());
+    int a = cuts[0], b = cuts[1], c = cuts[2];
+    vector<int> ends = {tour[0], tour[a - 1], tour[a], tour[b - 1], tour[b], tour[c - 1], tour[c], tour[n - 1]};
+
+    vector<int> result;
+    result.reserve(n);
+    result.insert(result.end(), tour.begin(), tour.begin() + a);
+    result.insert(result.end(), tour.begin() + b, tour.begin() + c);
+    result.insert(result.end(), tour.begin() + a, tour.begin() + b);
+    result.insert(result.end(), tour.begin() + c, tour.end());
+    tour.swap(result);
+    return ends;
+}
+
+vector<int> LocalSearch::solve(const DistanceMatrix &m, int start, const LocalSearchConfig &config, unsigned seed,
+                               const CancellationToken *cancel) {
+    int n = m.size();
+    if (n < 4) return nearestNeighbour(m, start);
+    vector<vector<int>> candidates = candidateLists(m, max(1, config.candidates));
+    mt19937 rng(seed);
+
+    // the restarts are independent; the first best one wins, as when they ran one after the other
+    int restarts = max(1, config.restarts);
+    vector<int> starts(restarts, start);
+    for (int r = 1; r < restarts; r++) {
+        starts[r] = uniform_int_distribution<int>(0, n - 1)(rng);
+    }
+    vector<vector<int>> tours(restarts);
+    vector<Cost> costs(restarts);
+    ThreadPool::shared().parallelFor(0, (size_t) restarts, 1, [&](size_t first, size_t last) {
+        for (size_t r = first; r < last; r++) {
+            tours[r] = nearestNeighbour(m, starts[r]);
+            twoOpt(m, candidates, tours[r], tours[r], cancel);
+            costs[r] = m.tourCost(tours[r]);
+        }
+    });
+    vector<int> best = move(tours[min_element(costs.begin(), costs.end()) - costs.begin()]);
+
+    iterate(m, candidates, best, config.kicks, rng, cancel);
+    return best;
+}
+
+Cost LocalSearch::iterate(const DistanceMatrix &m, const vector<vector<int>> &candidates, vector<int> &tour,
+                          int kicks, mt19937 &rng, const CancellationToken *cancel) {
+    Cost bestCost = m.tourCost(tour);
+    if (tour.size() < 8) return bestCost;
+    vector<int> trial;
+    CancellationCheck stop(cancel);
+    for (int k = 0; k < kicks && !stop.step(); k++) {
+        trial = tour;
+        vector<int> ends = doubleBridge(trial, rng);
+        twoOpt(m, candidates, trial, ends);
+        Cost cost = m.tourCost(trial);
+        if (cost < bestCost - COST_EPSILON) {
+            bestCost = cost;
+            tour.swap(trial);
+        }
+    }
+    return bestCost;
+}
@@ -0,0 +1,153 @@
+#ifndef PROJ2_LOCALSEARCH_H
+#define PROJ2_LOCALSEARCH_H
+
+#include <vector>
+#include <deque>
+#include <random>
+#include "DistanceMatrix.h"
+#include "Cancellation.h"
+
+/**
+ * @brief Knobs of the nearest neighbour + 2-opt pipeline, tuned per instance size by 'proj2 tune'
+ */
+struct LocalSearchConfig {
+    int candidates = 10; // length of the candidate list of each vertex
+    int restarts = 1;    // nearest neighbour tours built, the first one from the given start
+    int kicks = 0;       // double-bridge perturbations applied to the best tour (iterated local search)
+};
+
+/**
+ * @brief Progress of a 2-opt run that can be paused between vertices, see LocalSearch::twoOptStep()
+ */
+struct TwoOptState {
+    std::vector<int> position;  // position of each vertex in the tour
+    std::deque<int> active;     // vertices whose don't-look bit is off
+    std::vector<bool> queued;   // true for the vertices in active
+    long moves = 0;             // moves applied so far
+};
+
+/**
+ * @brief Construction heuristics and local search over a distance matrix
+ * @details Tours are vectors of matrix indices in visiting order, without repeating the first vertex.
+ * The improvement moves assume symmetric weights.
+ */
+class LocalSearch {
+public:
+    /**
+     * @brief Builds a tour by always moving to the closest unvisited vertex
+     * @details Time complexity: O(n^2)
+     * @param m Distance matrix
+     * @param start Index of the first vertex
+     * @return The tour
+     */
+    static std::vector<int> nearestNeighbour(const DistanceMatrix &m, int start);
+
+    /**
+     * @brief Builds the list of the k closest vertices of every vertex, closest first
+     * @details Time complexity: O(n^2logk)
+     * @param m Distance matrix
+     * @param k Length of each list
+     * @return Candidate list of each vertex
+     */
+    static std::vector<std::vector<int>> candidateLists(const DistanceMatrix &m, int k);
+
+    /**
+     * @brief Improves a tour with 2-opt moves until no improving move remains
+     * @details Only moves that add an edge to one of the candidates of a vertex are tried, and vertices whose
+     * surroundings did not change are skipped (don't-look bits). Time complexity: O(n * k) per pass
+     * @param m Distance matrix
+     * @param candidates Candidate lists, as built by candidateLists()
+     * @param tour Tour to improve, modified in place
+     * @return Number of moves applied
+     */
+    static long twoOpt(const DistanceMatrix &m, const std::vector<std::vector<int>> &candidates, std::vector<int> &tour);
+
+    /**
+     * @brief Improves a tour with 2-opt moves, starting from a few vertices only
+     * @details Used after a local perturbation, where only the vertices around the changed edges can have an
+     * improving move. When cancelled, the tour is left as improved so far. Time complexity: O(n + k * m), where m
+     * is the number of vertices woken up
+     * @param m Distance matrix
+     * @param candidates Candidate lists, as built by candidateLists()
+     * @param tour Tour to improve, modified in place
+     * @param active Vertices whose don't-look bit starts off
+     * @param cancel Token that stops the improvement, or null
+     * @return Number of moves applied
+     */
+    static long twoOpt(const DistanceMatrix &m, const std::vector<std::vector<int>> &candidates, std::vector<int> &tour,
+                       const std::vector<int> &active, const CancellationToken *cancel = nullptr);
+
+    /**
+     * @brief Prepares a 2-opt run that is carried out in slices by twoOptStep()
+     * @details Time complexity: O(n)
+     * @param tour Tour to improve
+     * @param active Vertices whose don't-look bit starts off
+     * @param state State to initialize
+     */
+    static void twoOptBegin(const std::vector<int> &tour, const std::vector<int> &active, TwoOptState &state);
+
+    /**
+     * @brief Continues a 2-opt run for at most a number of vertex visits
+     * @details Time complexity: O(V * k + moves * n), where V is the number of visits
+     * @param m Distance matrix
+     * @param candidates Candidate lists, as built by candidateLists()
+     * @param tour Tour being improved, modified in place; it must not change between slices
+     * @param state State prepared by twoOptBegin()
+     * @param maxVisits Largest number of vertices to visit in this slice
+     * @return True if no improving move remains
+     */
+    static bool twoOptStep(const DistanceMatrix &m, const std::vector<std::vector<int>> &candidates,
+                           std::vector<int> &tour, TwoOptState &state, long maxVisits);
+
+    /**
+     * @brief Applies a random double-bridge move, which 2-opt cannot undo in one step
+     * @details Splits the tour into A B C D and reconnects it as A C B D. Time complexity: O(n)
+     * @param tour Tour with at least 8 vertices, modified in place
+     * @param rng Random number generator
+     * @return The vertices at the ends of the changed edges
+     */
+    static std::vector<int> doubleBridge(std::vector<int> &tour, std::mt19937 &rng);
+
+    /**
+     * @brief Iterated local search: kicks the tour with double-bridge moves and keeps each improvement
+     * @details Stops early, with the best tour so far, when cancelled. Time complexity: O(K * (n + k * m)),
+     * where K is the number of kicks
+     * @param m Distance matrix
+     * @param candidates Candidate lists, as built by candidateLists()
+     * @param tour Tour, 2-optimal for the best results, replaced by the best tour found
+     * @param kicks Number of kicks
+     * @param rng Random number generator
+     * @param cancel Token that stops the kicks, or null
+     * @return The cost of the resulting tour
+     */
+    static Cost iterate(const DistanceMatrix &m, const std::vector<std::vector<int>> &candidates,
+                        std::vector<int> &tour, int kicks, std::mt19937 &rng, const CancellationToken *cancel = nullptr);
+
+    /**
+     * @brief Runs the whole pipeline: nearest neighbour restarts, 2-opt, then iterated local search
+     * @details With the default configuration this is a single nearest neighbour tour from start improved by
+     * 2-opt. Time complexity: O(n^2 * (r + logk) + K * (n + k * m)), where r is the number of restarts and
+     * K the number of kicks. Every stage stops early when cancelled, and the best tour so far is returned
+     * @param m Distance matrix
+     * @param start Index of the first vertex of the first construction
+     * @param config Knobs of the pipeline
+     * @param seed Seed of the restarts and kicks
+     * @param cancel Token that stops the search, or null
+     * @return The best tour found
+     */
+    static std::vector<int> solve(const DistanceMatrix &m, int start, const LocalSearchConfig &config, unsigned seed,
+                                  const CancellationToken *cancel = nullptr);
+
+    /**
+     * @brief Reverses the part of a tour between two positions (inclusive, wrapping around)
+     * @details The shorter side of the tour is reversed, which gives the same cyclic tour.
+     * Time complexity: O(n)
+     * @param tour Tour, modified in place
+     * @param position Position of each vertex in the tour, kept up to date
+     * @param from Position of the first vertex of the segment
+     * @param to Position of the last vertex of the segment
+     */
+    static void reverse(std::vector<int> &tour, std::vector<int> &position, int from, int to);
+};
+
+#endif //PROJ2_LOCALSEARCH_H
@@ -1,4 +1,5 @@
 #include "Menu.h"
+#include <functional>
 
 using namespace std;
 
@@ -24,6 +25,15 @@ void Menu::showMenu() {
     TspManager tspm;
     string system;
 
+    // Ctrl-C stops the running algorithm, which then shows the best result it found
+    CancellationToken interrupt;
+    auto interruptible = [&](const function<void()> &run) {
+        interrupt.reset();
+        InterruptScope scope(interrupt);
+        run();
+        if (interrupt.isCancelled()) cout << "Interrupted: the result above is the best found until then" << endl;
+    };
+
     while (mainMenu) {
         drawTop();
         cout << "| 1. Real World Graphs                             |" << endl;
@@ -272,6 +282,10 @@ void Menu::showMenu() {
             }
         }
 
+        InstanceFeatures features;
+        if (subMenu) features = tspm.getInstanceFeatures();
+        tspm.setCancellation(&interrupt);
+
         while (subMenu) {
             drawTop();
             cout << "| 1. Backtracking Algorithm                        |" << endl;
@@ -281,17 +295,22 @@ void Menu::showMenu() {
             cout << "| 5. Print Network Details                         |" << endl;
             cout << "| 6. Comparative Analysis                          |" << endl;
             cout << "| 7. Change Dataset                                |" << endl;
+            cout << "| 8. Live Updates Simulation                       |" << endl;
+            cout << "| 9. Latency Benchmark                             |" << endl;
+            cout << "| A. Automatic Algorithm Selection                 |" << endl;
+            cout << "| B. Tabu Search                                   |" << endl;
+            cout << "| C. Tour Merging                                  |" << endl;
             cout << "| Q. Exit                                          |" << endl;
             drawBottom();
             cout << "Choose an option: ";
             cin >> key;
             switch (key) {
                 case '1': {
-                    tspm.tspBacktracking();
+                    interruptible([&]() { tspm.tspBacktracking(); });
                     break;
                 }
                 case '2': {
-                    if (system != "shipping" && system != "real2" && system != "real3") {
+                    if (features.complete) {
                         drawTop();
                         cout << "| 1. Triangular Heuristic Approximation            |" << endl;
                         cout << "| 2. Triangular Heuristic Approximation Alternative|" << endl;
@@ -301,11 +320,11 @@ void Menu::showMenu() {
                         cin >> key;
                         switch (key) {
                             case '1': {
-                                tspm.tspTriangularHeuristicInput();
+                                interruptible([&]() { tspm.tspTriangularHeuristicInput(); });
                                 break;
                             }
                             case '2': {
-                                tspm.tspTriangularHeuristicAlternativeInput();
+                                interruptible([&]() { tspm.tspTriangularHeuristicAlternativeInput(); });
                                 break;
                             }
                             case 'Q' : {
@@ -322,12 +341,12 @@ void Menu::showMenu() {
                     break;
                 }
                 case '3': {
-                    if (system == "shipping") {
+                    if (!features.complete && !features.hasCoordinates) {
                         cout << "This option is not available for this dataset." << endl;
                         break;
                     }
-                    bool flag = (system == "real2" || system == "real3");
-                    tspm.tspPrim(flag);
+                    bool flag = !features.complete;
+                    interruptible([&]() { tspm.tspPrim(flag); });
                     break;
                 }
                 case '4': {
@@ -341,8 +360,8 @@ void Menu::showMenu() {
                 }
 
                 case '6': {
-                    if (system != "shipping" && system != "real2" && system != "real3") {
-                        tspm.compareAlgorithmsPerformance();
+                    if (features.complete) {
+                        interruptible([&]() { tspm.compareAlgorithmsPerformance(); });
                     }
                     else cout << "This option is not available for this dataset." << endl;
                     break;
@@ -353,6 +372,51 @@ void Menu::showMenu() {
                     subMenu = false;
                     break;
                 }
+                case '8': {
+                    tspm.liveUpdateSimulation(5.0);
+                    break;
+                }
+                case '9': {
+                    int repetitions;
+                    cout << "Enter the number of repetitions: ";
+                    cin >> repetitions;
+                    Benchmark benchmark(tspm, system);
+                    benchmark.runLatency(repetitions);
+                    benchmark.print();
+                    if (benchmark.save("latency_" + system + ".txt")) {
+                        cout << "Histograms saved to latency_" << system << ".txt" << endl;
+                    }
+                    break;
+                }
+                case 'A': {
+                    double budget;
+                    cout << "Enter the time budget in seconds: ";
+                    cin >> budget;
+                    interruptible([&]() { tspm.automaticSelection(budget); });
+                    break;
+                }
+                case 'B': {
+                    if (!features.complete && !features.hasCoordinates) {
+                        cout << "This option is not available for this dataset." << endl;
+                        break;
+                    }
+                    double seconds;
+                    cout << "Enter the time budget in seconds: ";
+                    cin >> seconds;
+                    interruptible([&]() { tspm.tspTabuSearch(seconds); });
+                    break;
+                }
+                case 'C': {
+                    if (!features.complete && !features.hasCoordinates) {
+                        cout << "This option is not available for this dataset." << endl;
+                        break;
+                    }
+                    double seconds;
+                    cout << "Enter the time budget in seconds: ";
+                    cin >> seconds;
+                    interruptible([&]() { tspm.tspTourMerging(seconds); });
+                    break;
+                }
                 case 'Q' : {
                     mainMenu = false;
                     subMenu = false;
@@ -4,6 +4,7 @@
 #include "Data.h"
 #include <iostream>
 #include "TspManager.h"
+#include "Benchmark.h"
 #include "Graph.h"
 
 class Menu {
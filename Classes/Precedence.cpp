@@ -0,0 +1,221 @@
+#include "Precedence.h"
+#include "Graph.h"
+#include "LocalSearch.h"
+#include <algorithm>
+#include <deque>
+
+using namespace std;
+
+bool PrecedenceConstraints::build(int n, const vector<pair<int, int>> &pairs) {
+    before.assign(n, {});
+    after.assign(n, {});
+    order.clear();
+    numPairs = 0;
+
+    Graph<int> dag;
+    for (int v = 0; v < n; v++) {
+        dag.addVertex(v);
+    }
+    for (const auto &p: pairs) {
+        if (p.first < 0 || p.first >= n || p.second < 0 || p.second >= n || p.first == p.second) return false;
+        dag.addEdge(p.first, p.second, 0);
+        after[p.first].push_back(p.second);
+        before[p.second].push_back(p.first);
+        numPairs++;
+    }
+    // topsort() returns nothing if the pairs contain a cycle
+    order = dag.topsort();
+    return (int) order.size() == n;
+}
+
+int PrecedenceConstraints::getNumPairs() const {
+    return numPairs;
+}
+
+const vector<int> &PrecedenceConstraints::getOrder() const {
+    return order;
+}
+
+const vector<int> &PrecedenceConstraints::getBefore(int v) const {
+    return before[v];
+}
+
+const vector<int> &PrecedenceConstraints::getAfter(int v) const {
+    return after[v];
+}
+
+bool PrecedenceConstraints::isFeasible(const vector<int> &tour) const {
+    vector<int> position(before.size(), -1);
+    for (size_t k = 0; k < tour.size(); k++) {
+        position[tour[k]] = (int) k;
+    }
+    for (size_t v = 0; v < after.size(); v++) {
+        for (int w: after[v]) {
+            if (position[v] == -1 || position[w] == -1 || position[v] > position[w]) return false;
+        }
+    }
+    return true;
+}
+
+bool PrecedenceConstraints::canRelocate(const vector<int> &position, int v, int afterPosition) const {
+    // the vertices between the old and the new place shift by one, which never reorders them, so v ends
+    // up behind everything up to afterPosition and ahead of everything past it
+    for (int p: before[v]) {
+        if (position[p] > afterPosition) return false;
+    }
+    for (int s: after[v]) {
+        if (position[s] <= afterPosition) return false;
+    }
+    return true;
+}
+
+bool PrecedenceConstraints::canSwap(const vector<int> &position, int u, int w) const {
+    // u moves forward to the place of w and w moves back to the place of u; the pickups of u and the
+    // deliveries of w were already on the right side of both places
+    for (int s: after[u]) {
+        if (position[s] <= position[w]) return false;
+    }
+    for (int p: before[w]) {
+        if (position[p] >= position[u]) return false;
+    }
+    return true;
+}
+
+vector<int> PrecedenceSearch::nearestNeighbour(const DistanceMatrix &m, int start,
+                                               const PrecedenceConstraints &constraints) {
+    int n = m.size();
+    vector<int> tour;
+    if (n == 0 || !constraints.getBefore(start).empty()) return tour;
+    // pickups not yet visited of each vertex
+    vector<int> waiting(n);
+    for (int v = 0; v < n; v++) {
+        waiting[v] = (int) constraints.getBefore(v).size();
+    }
+    vector<bool> visited(n, false);
+    int current = start;
+    while (true) {
+        tour.push_back(current);
+        visited[current] = true;
+        for (int s: constraints.getAfter(current)) {
+            waiting[s]--;
+        }
+        if ((int) tour.size() == n) break;
+        int next = -1;
+        for (int j = 0; j < n; j++) {
+            if (!visited[j] && waiting[j] == 0 && (next == -1 || m.at(current, j) < m.at(current, next))) next = j;
+        }
+        // the pairs are acyclic, so some unvisited vertex has all its pickups visited
+        current = next;
+    }
+    return tour;
+}
+
+long PrecedenceSearch::improve(const DistanceMatrix &m, const vector<vector<int>> &candidates,
+                               const PrecedenceConstraints &constraints, vector<int> &tour,
+                               const CancellationToken *cancel) {
+    int n = (int) tour.size();
+    if (n < 5) return 0;
+    vector<int> position(n);
+    for (int k = 0; k < n; k++) {
+        position[tour[k]] = k;
+    }
+    auto d = [&](int a, int b) { return (Cost) m.at(a, b); };
+    auto at = [&](int k) { return tour[(k + n) % n]; };
+
+    deque<int> active(tour.begin() + 1, tour.end());
+    vector<bool> queued(n, true);
+    queued[tour[0]] = false;
+    auto wake = [&](int v) {
+        if (v != tour[0] && !queued[v]) {
+            queued[v] = true;
+            active.push_back(v);
+        }
+    };
+    long moves = 0;
+
+    // replaces the edges leaving positions e1 and e2 by reversing the part between them, if that shortens the
+    // tour and no pair lies wholly inside that part; the check costs as much as the reversal it allows
+    auto tryTwoOpt = [&](int e1, int e2) {
+        e1 = (e1 + n) % n;
+        e2 = (e2 + n) % n;
+        int l = min(e1, e2) + 1, r = max(e1, e2);
+        if (r <= l) return false;
+        int x1 = tour[l - 1], x2 = tour[l], y1 = tour[r], y2 = at(r + 1);
+        Cost gain = d(x1, x2) + d(y1, y2) - d(x1, y1) - d(x2, y2);
+        if (!(gain > COST_EPSILON)) return false;
+        for (int k = l; k <= r; k++) {
+            for (int s: constraints.getAfter(tour[k])) {
+                if (position[s] <= r) return false;
+            }
+        }
+        std::reverse(tour.begin() + l, tour.begin() + r + 1);
+        for (int k = l; k <= r; k++) position[tour[k]] = k;
+        for (int w: {x1, x2, y1, y2}) wake(w);
+        return true;
+    };
+
+    // moves v to just after the vertex a if that shortens the tour and keeps it feasible
+    auto tryRelocate = [&](int v, int a) {
+        int i = position[v], j = position[a];
+        int prev = at(i - 1), next = at(i + 1), b = at(j + 1);
+        if (a == v || a == prev) return false;
+        Cost gain = d(prev, v) + d(v, next) - d(prev, next) - (d(a, v) + d(v, b) - d(a, b));
+        if (!(gain > COST_EPSILON) || !constraints.canRelocate(position, v, j)) return false;
+        if (j > i) {
+            rotate(tour.begin() + i, tour.begin() + i + 1, tour.begin() + j + 1);
+            for (int k = i; k <= j; k++) position[tour[k]] = k;
+        } else {
+            rotate(tour.begin() + j + 1, tour.begin() + i, tour.begin() + i + 1);
+            for (int k = j + 1; k <= i; k++) position[tour[k]] = k;
+        }
+        for (int w: {v, prev, next, a, b}) wake(w);
+        return true;
+    };
+
+    // exchanges the places of v and w if that shortens the tour and keeps it feasible
+    auto trySwap = [&](int v, int w) {
+        if (w == v || w == tour[0]) return false;
+        int u = position[v] < position[w] ? v : w;
+        w = u == v ? w : v;
+        int i = position[u], j = position[w];
+        int x = at(i - 1), y = at(j + 1);
+        Cost gain;
+        if (j == i + 1) {
+            gain = d(x, u) + d(u, w) + d(w, y) - (d(x, w) + d(w, u) + d(u, y));
+        } else {
+            int x2 = at(i + 1), y1 = at(j - 1);
+            gain = d(x, u) + d(u, x2) + d(y1, w) + d(w, y) - (d(x, w) + d(w, x2) + d(y1, u) + d(u, y));
+        }
+        if (!(gain > COST_EPSILON) || !constraints.canSwap(position, u, w)) return false;
+        swap(tour[i], tour[j]);
+        position[u] = j;
+        position[w] = i;
+        for (int z: {u, w, x, y, at(i + 1), at(j - 1)}) wake(z);
+        return true;
+    };
+
+    CancellationCheck stop(cancel);
+    while (!active.empty() && !stop.step()) {
+        int v = active.front();
+        active.pop_front();
+        queued[v] = false;
+        for (int c: candidates[v]) {
+            int pv = position[v], pc = position[c];
+            if (tryTwoOpt(pv, pc) || tryTwoOpt(pv - 1, pc - 1) || tryRelocate(v, c) || tryRelocate(v, at(pc - 1)) || trySwap(v, at(pc + 1)) ||
+                trySwap(v, at(pc - 1))) {
+                moves++;
+                break;
+            }
+        }
+    }
+    return moves;
+}
+
+vector<int> PrecedenceSearch::solve(const DistanceMatrix &m, int start, const PrecedenceConstraints &constraints,
+                                    int numCandidates, const CancellationToken *cancel) {
+    vector<int> tour = nearestNeighbour(m, start, constraints);
+    if (tour.size() < 5) return tour;
+    vector<vector<int>> candidates = LocalSearch::candidateLists(m, max(1, numCandidates));
+    improve(m, candidates, constraints, tour, cancel);
+    return tour;
+}
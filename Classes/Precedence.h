@@ -0,0 +1,141 @@
+#ifndef PROJ2_PRECEDENCE_H
+#define PROJ2_PRECEDENCE_H
+
+#include <vector>
+#include <utility>
+#include "DistanceMatrix.h"
+#include "Cancellation.h"
+
+/**
+ * @brief Pickup and delivery constraints: vertex a must be visited before vertex b, counted from the start
+ * @details The pairs form a directed graph over the matrix indices, which must be acyclic for any tour to
+ * respect them. A move is checked against the positions of the vertices it shifts and their constrained
+ * neighbours only, so with plain pickup and delivery pairs every check takes O(1).
+ */
+class PrecedenceConstraints {
+public:
+    /**
+     * @brief Builds the constraints from pickup and delivery pairs
+     * @details Time complexity: O(n + P), where P is the number of pairs
+     * @param n Number of vertices
+     * @param pairs Pairs of matrix indices, the first visited before the second
+     * @return False if an index is out of range or the pairs contain a cycle, which no tour can respect
+     */
+    bool build(int n, const std::vector<std::pair<int, int>> &pairs);
+
+    /**
+     * @brief Gets the number of pairs
+     * @details Time complexity: O(1)
+     * @return Number of pairs
+     */
+    int getNumPairs() const;
+
+    /**
+     * @brief Gets the vertices in an order that respects every pair, as found by Graph::topsort()
+     * @details Time complexity: O(1)
+     * @return Matrix indices
+     */
+    const std::vector<int> &getOrder() const;
+
+    /**
+     * @brief Gets the vertices that must come before a vertex
+     * @details Time complexity: O(1)
+     * @param v Matrix index
+     * @return The pickups of v
+     */
+    const std::vector<int> &getBefore(int v) const;
+
+    /**
+     * @brief Gets the vertices that must come after a vertex
+     * @details Time complexity: O(1)
+     * @param v Matrix index
+     * @return The deliveries of v
+     */
+    const std::vector<int> &getAfter(int v) const;
+
+    /**
+     * @brief Checks a whole tour
+     * @details Time complexity: O(n + P)
+     * @param tour Tour starting at the vertex the positions are counted from
+     * @return True if every pair is visited in order
+     */
+    bool isFeasible(const std::vector<int> &tour) const;
+
+    /**
+     * @brief Checks if a vertex can be moved to just after a position without breaking a pair
+     * @details The other vertices keep their relative order. Time complexity: O(d), where d is the number of
+     * pairs of v
+     * @param position Position of each vertex in a feasible tour
+     * @param v Vertex to move, not at position 0
+     * @param afterPosition Position of the vertex that will precede v
+     * @return True if the tour stays feasible
+     */
+    bool canRelocate(const std::vector<int> &position, int v, int afterPosition) const;
+
+    /**
+     * @brief Checks if two vertices can swap places without breaking a pair
+     * @details Time complexity: O(d), where d is the number of pairs of the two vertices
+     * @param position Position of each vertex in a feasible tour
+     * @param u Vertex at the smaller position, not 0
+     * @param w Vertex at the larger position
+     * @return True if the tour stays feasible
+     */
+    bool canSwap(const std::vector<int> &position, int u, int w) const;
+
+private:
+    std::vector<std::vector<int>> before;
+    std::vector<std::vector<int>> after;
+    std::vector<int> order;
+    int numPairs = 0;
+};
+
+/**
+ * @brief Construction and local search for tours that respect precedence constraints
+ * @details A 2-opt move reverses a whole segment, which breaks every pair inside it, so it is only taken when
+ * the segment holds no whole pair. The search also relocates a vertex next to one of its candidates and swaps
+ * two vertices, moves that keep the order of the other vertices and are checked in O(1) per pair. 2-opt
+ * assumes symmetric weights, while relocate and swap moves are priced correctly on asymmetric ones.
+ */
+class PrecedenceSearch {
+public:
+    /**
+     * @brief Builds a tour by always moving to the closest vertex whose pickups were all visited
+     * @details Time complexity: O(n^2 + P)
+     * @param m Distance matrix
+     * @param start Index of the first vertex, which must not be a delivery
+     * @param constraints Constraints
+     * @return The tour, or an empty tour if the start is a delivery
+     */
+    static std::vector<int> nearestNeighbour(const DistanceMatrix &m, int start, const PrecedenceConstraints &constraints);
+
+    /**
+     * @brief Improves a feasible tour with 2-opt, relocate and swap moves until no improving move remains
+     * @details Only moves that put a vertex next to one of its candidates are tried, and vertices whose
+     * surroundings did not change are skipped (don't-look bits). Applying a move costs O(n) to shift the
+     * tour, while rejecting a relocate or swap move costs O(1). The first vertex stays in place.
+     * @param m Distance matrix
+     * @param candidates Candidate lists, as built by LocalSearch::candidateLists()
+     * @param constraints Constraints
+     * @param tour Feasible tour to improve, modified in place
+     * @param cancel Token that stops the search early, leaving a feasible tour, or null
+     * @return Number of moves applied
+     */
+    static long improve(const DistanceMatrix &m, const std::vector<std::vector<int>> &candidates,
+                        const PrecedenceConstraints &constraints, std::vector<int> &tour,
+                        const CancellationToken *cancel = nullptr);
+
+    /**
+     * @brief Builds a feasible tour and improves it
+     * @details Time complexity: O(n^2logk) for the construction and candidate lists, plus the local search
+     * @param m Distance matrix
+     * @param start Index of the first vertex
+     * @param constraints Constraints
+     * @param numCandidates Length of the candidate lists
+     * @param cancel Token that stops the improvement early, or null
+     * @return The tour, or an empty tour if the start is a delivery
+     */
+    static std::vector<int> solve(const DistanceMatrix &m, int start, const PrecedenceConstraints &constraints,
+                                  int numCandidates, const CancellationToken *cancel = nullptr);
+};
+
+#endif //PROJ2_PRECEDENCE_H
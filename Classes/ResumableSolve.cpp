@@ -0,0 +1,178 @@
+#include "ResumableSolve.h"
+#include "ExactSolver.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    size_t nextMask(size_t mask) {
+        // next mask with the same number of bits (Gosper's hack)
+        size_t lowest = mask & (~mask + 1);
+        size_t ripple = mask + lowest;
+        return (((ripple ^ mask) >> 2) / lowest) | ripple;
+    }
+}
+
+ResumableSolve::ResumableSolve(DistanceMatrix m) : m(move(m)) {}
+
+const vector<int> &ResumableSolve::getTour() const {
+    return best;
+}
+
+Cost ResumableSolve::getCost() const {
+    return bestCost;
+}
+
+const DistanceMatrix &ResumableSolve::getMatrix() const {
+    return m;
+}
+
+void ResumableSolve::offer(const vector<int> &tour, int start) {
+    Cost cost = m.tourCost(tour);
+    if (tour.empty() || cost >= bestCost) return;
+    bestCost = cost;
+    best = tour;
+    auto first = find(best.begin(), best.end(), start);
+    if (first != best.end()) rotate(best.begin(), first, best.end());
+}
+
+LocalSearchSolve::LocalSearchSolve(DistanceMatrix m, int start, const LocalSearchConfig &config, unsigned seed)
+        : ResumableSolve(move(m)), start(start), config(config), rng(seed) {
+    // an answer for a deadline that comes before the first descent ends
+    offer(LocalSearch::nearestNeighbour(this->m, start), start);
+}
+
+bool LocalSearchSolve::resume(long steps) {
+    int n = m.size();
+    // a phase that ends returns early, which keeps the slices short without counting every operation
+    while (steps > 0) {
+        switch (phase) {
+            case Phase::Construct: {
+                if (n < 4) {
+                    phase = Phase::Done;
+                    return true;
+                }
+                if (candidates.empty()) candidates = LocalSearch::candidateLists(m, max(1, config.candidates));
+                int s = restartsDone == 0 ? start : uniform_int_distribution<int>(0, n - 1)(rng);
+                current = LocalSearch::nearestNeighbour(m, s);
+                LocalSearch::twoOptBegin(current, current, state);
+                phase = Phase::Descent;
+                steps -= n;
+                break;
+            }
+            case Phase::Descent: {
+                if (!LocalSearch::twoOptStep(m, candidates, current, state, steps)) return false;
+                // the first best restart is kept, as in LocalSearch::solve()
+                Cost cost = m.tourCost(current);
+                if (cost < incumbentCost) {
+                    incumbent = current;
+                    incumbentCost = cost;
+                    offer(current, start);
+                }
+                restartsDone++;
+                if (restartsDone < max(1, config.restarts)) phase = Phase::Construct;
+                else phase = config.kicks > 0 && n >= 8 ? Phase::Kick : Phase::Done;
+                return phase == Phase::Done;
+            }
+            case Phase::Kick: {
+                current = incumbent;
+                vector<int> ends = LocalSearch::doubleBridge(current, rng);
+                LocalSearch::twoOptBegin(current, ends, state);
+                phase = Phase::KickDescent;
+                steps -= n;
+                break;
+            }
+            case Phase::KickDescent: {
+                if (!LocalSearch::twoOptStep(m, candidates, current, state, steps)) return false;
+                Cost cost = m.tourCost(current);
+                if (cost < incumbentCost - COST_EPSILON) {
+                    incumbent = current;
+                    incumbentCost = cost;
+                    offer(current, start);
+                }
+                kicksDone++;
+                phase = kicksDone < config.kicks ? Phase::Kick : Phase::Done;
+                return phase == Phase::Done;
+            }
+            case Phase::Done:
+                return true;
+        }
+    }
+    return phase == Phase::Done;
+}
+
+HeldKarpSolve::HeldKarpSolve(DistanceMatrix m, int start) : ResumableSolve(move(m)), start(start) {
+    int n = this->m.size();
+    offer(LocalSearch::nearestNeighbour(this->m, start), start);
+    k = n - 1;
+    if (n <= 1 || n > ExactSolver::MAX_DP_VERTICES) {
+        finished = true;
+        return;
+    }
+    // same recurrence as ExactSolver::heldKarp: vertex 0 is the start, bit v-1 of a mask stands for vertex v
+    numMasks = (size_t) 1 << k;
+    cost.assign(numMasks * k, INFINITE_COST);
+    parent.assign(numMasks * k, -1);
+    for (int v = 0; v < k; v++) {
+        if (this->m.at(0, v + 1) != MISSING_WEIGHT) cost[((size_t) 1 << v) * k + v] = this->m.at(0, v + 1);
+    }
+    layer = 1;
+    mask = 1;
+    if (layer >= k) finish();
+}
+
+bool HeldKarpSolve::resume(long steps) {
+    while (!finished && steps > 0) {
+        for (int last = 0; last < k; last++) {
+            if (!(mask & ((size_t) 1 << last))) continue;
+            Cost current = cost[mask * k + last];
+            if (current == INFINITE_COST) continue;
+            for (int next = 0; next < k; next++) {
+                if ((mask & ((size_t) 1 << next)) || m.at(last + 1, next + 1) == MISSING_WEIGHT) continue;
+                Cost candidate = current + m.at(last + 1, next + 1);
+                size_t state = (mask | ((size_t) 1 << next)) * k + next;
+                if (candidate < cost[state]) {
+                    cost[state] = candidate;
+                    parent[state] = (int8_t) last;
+                }
+            }
+        }
+        steps -= (long) k * k;
+        mask = nextMask(mask);
+        if (mask >= numMasks) {
+            layer++;
+            if (layer >= k) finish();
+            else mask = ((size_t) 1 << layer) - 1;
+        }
+    }
+    return finished;
+}
+
+void HeldKarpSolve::finish() {
+    finished = true;
+    size_t full = numMasks - 1;
+    Cost optimum = INFINITE_COST;
+    int last = -1;
+    for (int v = 0; v < k; v++) {
+        if (cost[full * k + v] == INFINITE_COST || m.at(v + 1, 0) == MISSING_WEIGHT) continue;
+        if (cost[full * k + v] + m.at(v + 1, 0) < optimum) {
+            optimum = cost[full * k + v] + m.at(v + 1, 0);
+            last = v;
+        }
+    }
+    if (last != -1) {
+        vector<int> tour;
+        for (size_t set = full; last != -1;) {
+            tour.push_back(last + 1);
+            int previous = parent[set * k + last];
+            set &= ~((size_t) 1 << last);
+            last = previous;
+        }
+        tour.push_back(0);
+        std::reverse(tour.begin(), tour.end());
+        offer(tour, start);
+    }
+    // the table is no longer needed, and thousands of solves may be waiting for their result
+    vector<Cost>().swap(cost);
+    vector<int8_t>().swap(parent);
+}
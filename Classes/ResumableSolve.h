@@ -0,0 +1,132 @@
+#ifndef PROJ2_RESUMABLESOLVE_H
+#define PROJ2_RESUMABLESOLVE_H
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "DistanceMatrix.h"
+#include "LocalSearch.h"
+
+/**
+ * @brief Solver written as a state machine that runs in slices, so that many solves can share a few threads
+ * @details Each call to resume() does a bounded amount of work and returns; all the progress is kept in the
+ * object. Once a first tour is known it is always available through getTour(), so a solve cut short by a
+ * deadline still has an answer.
+ */
+class ResumableSolve {
+public:
+    virtual ~ResumableSolve() = default;
+
+    /**
+     * @brief Continues the solve
+     * @details A step is a small unit of work of the solver, in the order of n or k weight lookups
+     * @param steps Work allowed in this slice
+     * @return True if the solve has finished
+     */
+    virtual bool resume(long steps) = 0;
+
+    /**
+     * @brief Gets the best tour found so far
+     * @details Time complexity: O(1)
+     * @return Matrix indices in visiting order, starting at the requested vertex, or an empty tour if none is known
+     */
+    const std::vector<int> &getTour() const;
+
+    /**
+     * @brief Gets the cost of the best tour found so far
+     * @details Time complexity: O(1)
+     * @return The cost, or INFINITE_COST if no tour is known
+     */
+    Cost getCost() const;
+
+    /**
+     * @brief Gets the matrix being solved
+     * @details Time complexity: O(1)
+     * @return The matrix
+     */
+    const DistanceMatrix &getMatrix() const;
+
+protected:
+    explicit ResumableSolve(DistanceMatrix m);
+
+    DistanceMatrix m;
+    std::vector<int> best;
+    Cost bestCost = INFINITE_COST;
+
+    /**
+     * @brief Keeps a tour if it is better than the best one
+     * @param tour Tour
+     * @param start Vertex the stored tour is rotated to start at
+     */
+    void offer(const std::vector<int> &tour, int start);
+};
+
+/**
+ * @brief Nearest neighbour restarts, 2-opt and double-bridge kicks, as LocalSearch::solve(), in slices
+ */
+class LocalSearchSolve : public ResumableSolve {
+public:
+    /**
+     * @brief Prepares the solve, with the nearest neighbour tour from the start as the first answer
+     * @details Time complexity: O(n^2)
+     * @param m Distance matrix, owned by the solve
+     * @param start Index of the vertex the tour starts at
+     * @param config Restarts, kicks and candidate list length
+     * @param seed Seed of the random choices
+     */
+    LocalSearchSolve(DistanceMatrix m, int start, const LocalSearchConfig &config, unsigned seed);
+
+    bool resume(long steps) override;
+
+private:
+    enum class Phase {
+        Construct, Descent, Kick, KickDescent, Done
+    };
+
+    Phase phase = Phase::Construct;
+    int start;
+    LocalSearchConfig config;
+    std::mt19937 rng;
+    std::vector<std::vector<int>> candidates;
+    std::vector<int> incumbent;  // best improved tour as found, before the rotation to the start
+    Cost incumbentCost = INFINITE_COST;
+    std::vector<int> current;
+    TwoOptState state;
+    int restartsDone = 0;
+    int kicksDone = 0;
+};
+
+/**
+ * @brief Held-Karp dynamic programming, as ExactSolver::heldKarp(), in slices
+ * @details Starts from the nearest neighbour tour, which is returned if the solve is cut short.
+ * Memory: O(2^n * n), so it is only meant for small instances
+ */
+class HeldKarpSolve : public ResumableSolve {
+public:
+    /**
+     * @brief Prepares the solve
+     * @details Time complexity: O(2^n * n)
+     * @param m Distance matrix with at most ExactSolver::MAX_DP_VERTICES vertices, owned by the solve
+     * @param start Index of the vertex the tour starts at
+     */
+    HeldKarpSolve(DistanceMatrix m, int start);
+
+    bool resume(long steps) override;
+
+private:
+    int start;
+    int k;
+    std::size_t numMasks;
+    std::size_t mask = 0;
+    int layer = 0;
+    bool finished = false;
+    std::vector<Cost> cost;
+    std::vector<int8_t> parent;
+
+    /**
+     * @brief Rebuilds the optimal tour from the parents once every layer is done
+     */
+    void finish();
+};
+
+#endif //PROJ2_RESUMABLESOLVE_H
@@ -0,0 +1,129 @@
+#include "RoutingEngine.h"
+#include <unordered_set>
+#include <algorithm>
+#include <limits>
+#include "ExactSolver.h"
+
+using namespace std;
+
+namespace {
+    /** Largest instance the automatic choice solves exactly */
+    const int AUTO_EXACT_VERTICES = 16;
+}
+
+RoutingEngine::RoutingEngine() = default;
+
+bool RoutingEngine::uniqueIds(const int *ids, size_t n) {
+    unordered_set<int> seen;
+    for (size_t i = 0; i < n; i++) {
+        if (!seen.insert(ids[i]).second) return false;
+    }
+    return true;
+}
+
+RoutingStatus RoutingEngine::loadCoordinates(const int *ids, const double *latitudes, const double *longitudes,
+                                             size_t n) {
+    if ((n > 0 && (ids == nullptr || latitudes == nullptr || longitudes == nullptr)) || !uniqueIds(ids, n)) {
+        return RoutingStatus::InvalidInput;
+    }
+    matrix = DistanceMatrix(vector<int>(ids, ids + n));
+    tourBuffer.clear();
+    return fillMissingEdges(latitudes, longitudes);
+}
+
+RoutingStatus RoutingEngine::loadEdges(const int *ids, size_t n, const int *sources, const int *targets,
+                                       const double *weights, size_t m, bool undirected) {
+    if (n > 0 && ids == nullptr) return RoutingStatus::InvalidInput;
+    if (m > 0 && (sources == nullptr || targets == nullptr || weights == nullptr)) return RoutingStatus::InvalidInput;
+    if (!uniqueIds(ids, n)) return RoutingStatus::InvalidInput;
+
+    DistanceMatrix result(vector<int>(ids, ids + n));
+    // keep the first edge of each pair, like the graph loaded from files
+    vector<bool> assigned((size_t) n * n, false);
+    auto assign = [&](int i, int j, double w) {
+        if (i == j || assigned[(size_t) i * n + j]) return;
+        assigned[(size_t) i * n + j] = true;
+        result.set(i, j, toWeight(w));
+    };
+    for (size_t e = 0; e < m; e++) {
+        int i = result.findIndex(sources[e]), j = result.findIndex(targets[e]);
+        if (i == -1 || j == -1 || !(weights[e] >= 0)) return RoutingStatus::InvalidInput;
+        assign(i, j, weights[e]);
+        if (undirected) assign(j, i, weights[e]);
+    }
+    matrix = move(result);
+    tourBuffer.clear();
+    return RoutingStatus::Ok;
+}
+
+RoutingStatus RoutingEngine::fillMissingEdges(const double *latitudes, const double *longitudes) {
+    int n = matrix.size();
+    if (n > 0 && (latitudes == nullptr || longitudes == nullptr)) return RoutingStatus::InvalidInput;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i != j && matrix.at(i, j) == MISSING_WEIGHT) {
+                matrix.set(i, j, toWeight(1000.0 * DistanceMatrix::haversineDistance(latitudes[i], longitudes[i],
+                                                                                     latitudes[j], longitudes[j])));
+            }
+        }
+    }
+    return RoutingStatus::Ok;
+}
+
+void RoutingEngine::setLocalSearchConfig(const LocalSearchConfig &config) {
+    this->config = config;
+}
+
+void RoutingEngine::setCheckpoint(const CheckpointOptions &options) {
+    checkpoint = options;
+}
+
+RoutingStatus RoutingEngine::solve(RoutingSolver solver, int startId, Span<const int> &tour, double &cost) {
+    tour = Span<const int>();
+    cost = numeric_limits<double>::infinity();
+    int n = matrix.size();
+    if (n == 0) return RoutingStatus::NotLoaded;
+    int start = matrix.findIndex(startId);
+    if (start == -1) return RoutingStatus::InvalidInput;
+    if (solver == RoutingSolver::Auto) {
+        solver = n <= AUTO_EXACT_VERTICES ? RoutingSolver::ExactDP : RoutingSolver::LocalSearch;
+    }
+
+    vector<int> indices;
+    Cost total = INFINITE_COST;
+    switch (solver) {
+        case RoutingSolver::ExactDP:
+            if (n > ExactSolver::MAX_DP_VERTICES) return RoutingStatus::TooLarge;
+            total = ExactSolver::heldKarp(matrix, indices, checkpoint);
+            // the dynamic programming tour starts at index 0, rotate it to the requested start
+            rotate(indices.begin(), find(indices.begin(), indices.end(), start), indices.end());
+            break;
+        case RoutingSolver::BranchAndBound:
+            total = ExactSolver::branchAndBound(matrix, start, indices, checkpoint);
+            break;
+        case RoutingSolver::LocalSearch:
+        case RoutingSolver::Auto:
+            indices = LocalSearch::solve(matrix, start, config, 42);
+            rotate(indices.begin(), find(indices.begin(), indices.end(), start), indices.end());
+            total = matrix.tourCost(indices);
+            break;
+    }
+    if (indices.empty() || total == INFINITE_COST) return RoutingStatus::NoTour;
+    cost = toDouble(total);
+
+    tourBuffer.clear();
+    for (int i: indices) {
+        tourBuffer.push_back(matrix.getId(i));
+    }
+    tourBuffer.push_back(tourBuffer.front());
+    tour = Span<const int>(tourBuffer.data(), tourBuffer.size());
+    return RoutingStatus::Ok;
+}
+
+size_t RoutingEngine::size() const {
+    return (size_t) matrix.size();
+}
+
+const DistanceMatrix &RoutingEngine::getMatrix() const {
+    return matrix;
+}
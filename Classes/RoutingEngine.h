@@ -0,0 +1,173 @@
+#ifndef PROJ2_ROUTINGENGINE_H
+#define PROJ2_ROUTINGENGINE_H
+
+#include <cstddef>
+#include <vector>
+#include "DistanceMatrix.h"
+#include "LocalSearch.h"
+#include "Checkpoint.h"
+
+/**
+ * @brief Non-owning view of a contiguous sequence, for handing out results without copying them
+ */
+template<class T>
+class Span {
+public:
+    Span() : ptr(nullptr), length(0) {}
+
+    Span(T *ptr, std::size_t length) : ptr(ptr), length(length) {}
+
+    T *begin() const {
+        return ptr;
+    }
+
+    T *end() const {
+        return ptr + length;
+    }
+
+    T *data() const {
+        return ptr;
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+    bool empty() const {
+        return length == 0;
+    }
+
+    T &operator[](std::size_t i) const {
+        return ptr[i];
+    }
+
+private:
+    T *ptr;
+    std::size_t length;
+};
+
+/**
+ * @brief Solvers available through the routing engine
+ */
+enum class RoutingSolver {
+    Auto,            // exact dynamic programming on small instances, local search otherwise
+    ExactDP,         // Held-Karp, up to ExactSolver::MAX_DP_VERTICES vertices
+    BranchAndBound,  // exact depth-first search with cost bound
+    LocalSearch      // nearest neighbour + 2-opt, with the configured restarts and kicks
+};
+
+/**
+ * @brief Result of a routing engine call
+ */
+enum class RoutingStatus {
+    Ok,
+    InvalidInput,  // bad sizes, duplicate ids, unknown edge endpoints or negative weights
+    NotLoaded,     // no instance has been loaded
+    TooLarge,      // the instance is too large for the chosen solver
+    NoTour         // there is no tour visiting every vertex with the known edges
+};
+
+/**
+ * @brief Embeddable entry point of the routing_core library
+ * @details Instances are built straight from caller arrays into a distance matrix, without files, parsing or
+ * console output. Tours are returned as views into a buffer owned by the engine, valid until the next call
+ * that changes it. An engine is not meant to be used by several threads at once.
+ */
+class RoutingEngine {
+public:
+    /**
+     * @brief Constructs an engine with no instance
+     * @details Time complexity: O(1)
+     */
+    RoutingEngine();
+
+    /**
+     * @brief Loads a complete instance priced by great-circle distance in metres
+     * @details Time complexity: O(n^2)
+     * @param ids Id of each vertex
+     * @param latitudes Latitude of each vertex, in degrees
+     * @param longitudes Longitude of each vertex, in degrees
+     * @param n Number of vertices
+     * @return Ok, or InvalidInput
+     */
+    RoutingStatus loadCoordinates(const int *ids, const double *latitudes, const double *longitudes, std::size_t n);
+
+    /**
+     * @brief Loads an instance from an edge list
+     * @details When an edge is given more than once the first one is kept. Time complexity: O(n^2 + m)
+     * @param ids Id of each vertex
+     * @param n Number of vertices
+     * @param sources Id of the source of each edge
+     * @param targets Id of the destination of each edge
+     * @param weights Weight of each edge
+     * @param m Number of edges
+     * @param undirected True if every edge also goes the other way
+     * @return Ok, or InvalidInput
+     */
+    RoutingStatus loadEdges(const int *ids, std::size_t n, const int *sources, const int *targets,
+                            const double *weights, std::size_t m, bool undirected = true);
+
+    /**
+     * @brief Prices the pairs without an edge by great-circle distance in metres
+     * @details Time complexity: O(n^2)
+     * @param latitudes Latitude of each vertex, in the order of the loaded ids
+     * @param longitudes Longitude of each vertex, in the order of the loaded ids
+     * @return Ok, or NotLoaded
+     */
+    RoutingStatus fillMissingEdges(const double *latitudes, const double *longitudes);
+
+    /**
+     * @brief Sets the knobs of the local search solver
+     * @details Time complexity: O(1)
+     * @param config Configuration
+     */
+    void setLocalSearchConfig(const LocalSearchConfig &config);
+
+    /**
+     * @brief Makes the exact solvers save checkpoints and resume from them
+     * @details Time complexity: O(1)
+     * @param options Checkpoint file and interval
+     */
+    void setCheckpoint(const CheckpointOptions &options);
+
+    /**
+     * @brief Finds a tour
+     * @details Time complexity: that of the solver
+     * @param solver Solver to run
+     * @param startId Id of the vertex the tour starts and ends at
+     * @param tour View to store the tour as vertex ids, closed by repeating the start
+     * @param cost Variable to store the cost of the tour
+     * @return Ok, NotLoaded, InvalidInput for an unknown start, TooLarge or NoTour
+     */
+    RoutingStatus solve(RoutingSolver solver, int startId, Span<const int> &tour, double &cost);
+
+    /**
+     * @brief Gets the number of vertices of the loaded instance
+     * @details Time complexity: O(1)
+     * @return Number of vertices
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Gets the distance matrix of the loaded instance
+     * @details Time complexity: O(1)
+     * @return The matrix
+     */
+    const DistanceMatrix &getMatrix() const;
+
+private:
+    DistanceMatrix matrix;
+    LocalSearchConfig config;
+    CheckpointOptions checkpoint;
+    std::vector<int> tourBuffer;
+
+    /**
+     * @brief Checks that ids are unique
+     * @param ids Ids
+     * @param n Number of ids
+     * @return True if no id repeats
+     */
+    static bool uniqueIds(const int *ids, std::size_t n);
+};
+
+#endif //PROJ2_ROUTINGENGINE_H
@@ -0,0 +1,94 @@
+#include "SolveScheduler.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    // steps between two looks at the clock inside a slice
+    const long STEPS_PER_CHECK = 256;
+}
+
+const int SolveScheduler::MAX_EXACT_VERTICES;
+
+SolveScheduler::SolveScheduler(unsigned numWorkers, double sliceSeconds)
+        : slice(chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(sliceSeconds))) {
+    for (unsigned w = 0; w < max(1u, numWorkers); w++) {
+        workers.emplace_back(&SolveScheduler::workerLoop, this);
+    }
+}
+
+SolveScheduler::~SolveScheduler() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (auto &w: workers) {
+        w.join();
+    }
+    while (!jobs.empty()) {
+        answer(*jobs.top(), false);
+        jobs.pop();
+    }
+}
+
+future<ScheduledResult> SolveScheduler::submit(unique_ptr<ResumableSolve> solve, double deadlineSeconds) {
+    unique_ptr<Job> job(new Job());
+    job->solve = move(solve);
+    job->submitted = chrono::steady_clock::now();
+    job->deadline = job->submitted +
+                    chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(deadlineSeconds));
+    future<ScheduledResult> result = job->result.get_future();
+    {
+        lock_guard<std::mutex> lock(mutex);
+        job->sequence = nextSequence++;
+        jobs.push(move(job));
+    }
+    ready.notify_one();
+    return result;
+}
+
+unique_ptr<ResumableSolve> SolveScheduler::makeSolve(DistanceMatrix m, int start, const LocalSearchConfig &config) {
+    if (m.size() <= MAX_EXACT_VERTICES) return unique_ptr<ResumableSolve>(new HeldKarpSolve(move(m), start));
+    return unique_ptr<ResumableSolve>(new LocalSearchSolve(move(m), start, config, 42));
+}
+
+void SolveScheduler::workerLoop() {
+    while (true) {
+        unique_ptr<Job> job;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            // the queue only hands out const references, and the job is popped right after
+            job = move(const_cast<unique_ptr<Job> &>(jobs.top()));
+            jobs.pop();
+        }
+
+        auto now = chrono::steady_clock::now();
+        auto sliceEnd = now + slice;
+        bool finished = false;
+        while (!finished && now < sliceEnd && now < job->deadline) {
+            finished = job->solve->resume(STEPS_PER_CHECK);
+            now = chrono::steady_clock::now();
+        }
+        if (finished || now >= job->deadline) {
+            answer(*job, finished);
+            continue;
+        }
+        {
+            lock_guard<std::mutex> lock(mutex);
+            jobs.push(move(job));
+        }
+        ready.notify_one();
+    }
+}
+
+void SolveScheduler::answer(Job &job, bool finished) {
+    ScheduledResult result;
+    result.tour = job.solve->getTour();
+    result.cost = job.solve->getCost();
+    result.finished = finished;
+    result.latencySeconds = chrono::duration<double>(chrono::steady_clock::now() - job.submitted).count();
+    job.result.set_value(move(result));
+}
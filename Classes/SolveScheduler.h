@@ -0,0 +1,109 @@
+#ifndef PROJ2_SOLVESCHEDULER_H
+#define PROJ2_SOLVESCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "ResumableSolve.h"
+
+/**
+ * @brief Outcome of a scheduled solve
+ */
+struct ScheduledResult {
+    std::vector<int> tour;  // matrix indices, starting at the requested vertex; empty if no tour was found
+    Cost cost = INFINITE_COST;
+    bool finished = false;  // false if the deadline cut the solve short and tour is the best found until then
+    double latencySeconds = 0.0;  // time from submission to the result
+};
+
+/**
+ * @brief Runs many small resumable solves on a few threads, earliest deadline first
+ * @details A worker takes the solve with the earliest deadline and runs it for one time slice, then puts it
+ * back, so a newly arrived solve with a closer deadline waits at most one slice. A solve whose deadline has
+ * passed is answered with its best tour so far. The workers are separate from the ThreadPool, whose tasks
+ * run to completion in no particular order.
+ */
+class SolveScheduler {
+public:
+    /**
+     * @brief Starts the workers
+     * @details Time complexity: O(W)
+     * @param numWorkers Number of worker threads
+     * @param sliceSeconds Time a solve runs before the worker picks again
+     */
+    explicit SolveScheduler(unsigned numWorkers, double sliceSeconds = 0.001);
+
+    /**
+     * @brief Answers the waiting solves with their best tours and stops the workers
+     */
+    ~SolveScheduler();
+
+    SolveScheduler(const SolveScheduler &) = delete;
+
+    SolveScheduler &operator=(const SolveScheduler &) = delete;
+
+    /**
+     * @brief Queues a solve
+     * @details Time complexity: O(logQ), where Q is the number of queued solves
+     * @param solve Solve
+     * @param deadlineSeconds Time from now after which the best tour so far is returned
+     * @return Future of the result
+     */
+    std::future<ScheduledResult> submit(std::unique_ptr<ResumableSolve> solve, double deadlineSeconds);
+
+    /**
+     * @brief Builds the usual solve for an instance: Held-Karp on small instances, local search otherwise
+     * @details Time complexity: O(1), or O(2^n * n) for Held-Karp
+     * @param m Distance matrix
+     * @param start Index of the vertex the tour starts at
+     * @param config Knobs of the local search
+     * @return The solve
+     */
+    static std::unique_ptr<ResumableSolve> makeSolve(DistanceMatrix m, int start, const LocalSearchConfig &config);
+
+    /** Largest instance makeSolve() solves exactly */
+    static const int MAX_EXACT_VERTICES = 12;
+
+private:
+    struct Job {
+        std::unique_ptr<ResumableSolve> solve;
+        std::promise<ScheduledResult> result;
+        std::chrono::steady_clock::time_point submitted;
+        std::chrono::steady_clock::time_point deadline;
+        std::uint64_t sequence;
+    };
+
+    struct LaterDeadline {
+        bool operator()(const std::unique_ptr<Job> &a, const std::unique_ptr<Job> &b) const {
+            return a->deadline != b->deadline ? a->deadline > b->deadline : a->sequence > b->sequence;
+        }
+    };
+
+    std::priority_queue<std::unique_ptr<Job>, std::vector<std::unique_ptr<Job>>, LaterDeadline> jobs;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool stopping = false;
+    std::uint64_t nextSequence = 0;
+    std::chrono::steady_clock::duration slice;
+
+    /**
+     * @brief Main loop of a worker thread
+     */
+    void workerLoop();
+
+    /**
+     * @brief Fulfils the future of a job with its best tour
+     * @param job Job
+     * @param finished True if the solve ran to the end
+     */
+    static void answer(Job &job, bool finished);
+};
+
+#endif //PROJ2_SOLVESCHEDULER_H
@@ -0,0 +1,164 @@
+#include "TabuSearch.h"
+#include "LocalSearch.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+TabuList::TabuList(size_t capacity) {
+    size_t size = 1024;
+    while (size < 64 * capacity) size <<= 1;
+    slots.assign(size, Slot());
+    mask = size - 1;
+}
+
+vector<int> TabuSearch::solve(const DistanceMatrix &m, int start, const TabuSearchConfig &config,
+                              const CancellationToken *cancel, TabuSearchReport *report) {
+    TabuSearchReport local;
+    TabuSearchReport &r = report ? *report : local;
+    r = TabuSearchReport();
+    int n = m.size();
+    auto begin = chrono::steady_clock::now();
+    auto elapsed = [&]() { return chrono::duration<double>(chrono::steady_clock::now() - begin).count(); };
+    if (n < 8) {
+        vector<int> tour = LocalSearch::solve(m, start, LocalSearchConfig(), config.seed);
+        r.initialCost = r.bestCost = m.tourCost(tour);
+        return tour;
+    }
+
+    vector<vector<int>> candidates = LocalSearch::candidateLists(m, max(1, config.candidates));
+    vector<int> tour = LocalSearch::nearestNeighbour(m, start);
+    LocalSearch::twoOpt(m, candidates, tour);
+    Cost current = m.tourCost(tour);
+    r.initialCost = r.bestCost = current;
+    vector<int> best = tour;
+    if (current >= INFINITE_COST) {
+        // the start uses a missing edge, and moves priced against it would not be finite
+        r.seconds = elapsed();
+        return best;
+    }
+
+    const int sample = max(1, min(config.sample, n));
+    const long tenure = max(1, config.tenure);
+    const long stall = max(1, config.stall);
+    TabuList tabu((size_t) 2 * tenure);
+    mt19937 rng(config.seed);
+    uniform_int_distribution<int> anyVertex(0, n - 1);
+
+    vector<int> position(n);
+    auto locate = [&]() {
+        for (int k = 0; k < n; k++) {
+            position[tour[k]] = k;
+        }
+    };
+    locate();
+    auto next = [&](int city) { return tour[(position[city] + 1) % n]; };
+    auto previous = [&](int city) { return tour[(position[city] - 1 + n) % n]; };
+
+    // the ends of the last few moves are evaluated every iteration, since that is where the tour has changed
+    const int RECENT = 16;
+    vector<int> recent(RECENT, -1);
+    int recentNext = 0;
+    auto touch = [&](int city) {
+        recent[recentNext] = city;
+        recentNext = (recentNext + 1) % RECENT;
+    };
+
+    enum Kind { NONE, TWO_OPT, SWAP };
+    CancellationCheck stop(cancel);
+    long lastImprovement = 0;
+    for (long iteration = 0;; iteration++) {
+        if (stop.step()) break;
+        if ((iteration & 255) == 0 && (stop.now() || elapsed() >= config.seconds)) break;
+
+        // best admissible move among those from the sampled vertices to their candidates
+        Kind kind = NONE;
+        Cost bestDelta = 0;
+        bool aspiration = false;
+        int moveA = -1, moveB = -1, moveC = -1, moveD = -1, direction = 0;
+        auto consider = [&](Kind k, Cost delta, bool isTabu, int a, int b, int c, int d, int dir) {
+            if (kind != NONE && delta >= bestDelta) return;
+            bool aspires = isTabu && current + delta < r.bestCost - COST_EPSILON;
+            if (isTabu && !aspires) return;
+            kind = k;
+            bestDelta = delta;
+            aspiration = isTabu;
+            moveA = a, moveB = b, moveC = c, moveD = d, direction = dir;
+        };
+        for (int s = 0; s < sample + RECENT; s++) {
+            int a = s < sample ? anyVertex(rng) : recent[s - sample];
+            if (a == -1) continue;
+            int pa = previous(a), na = next(a);
+            for (int c: candidates[a]) {
+                int pc = previous(c), nc = next(c);
+                // 2-opt: a->b ... c->d becomes a->c ... b->d, in either direction around the tour
+                for (int dir = 0; dir < 2; dir++) {
+                    int b = dir == 0 ? na : pa;
+                    int d = dir == 0 ? nc : pc;
+                    if (c == b || d == a) continue;
+                    Cost delta = (Cost) m.at(a, c) + m.at(b, d) - m.at(a, b) - m.at(c, d);
+                    consider(TWO_OPT, delta, tabu.isTabu(a, c, iteration) || tabu.isTabu(b, d, iteration),
+                             a, b, c, d, dir);
+                }
+                // swap: a and c trade places, which needs them not to be neighbours
+                if (c == na || c == pa) continue;
+                Cost delta = (Cost) m.at(pa, c) + m.at(c, na) + m.at(pc, a) + m.at(a, nc)
+                             - m.at(pa, a) - m.at(a, na) - m.at(pc, c) - m.at(c, nc);
+                bool isTabu = tabu.isTabu(pa, c, iteration) || tabu.isTabu(c, na, iteration) ||
+                              tabu.isTabu(pc, a, iteration) || tabu.isTabu(a, nc, iteration);
+                consider(SWAP, delta, isTabu, a, -1, c, -1, 0);
+            }
+        }
+        r.iterations++;
+
+        if (kind == TWO_OPT) {
+            touch(moveA), touch(moveB), touch(moveC), touch(moveD);
+            tabu.add(moveA, moveB, iteration + tenure);
+            tabu.add(moveC, moveD, iteration + tenure);
+            if (direction == 0) LocalSearch::reverse(tour, position, position[moveB], position[moveC]);
+            else LocalSearch::reverse(tour, position, position[moveC], position[moveB]);
+            r.twoOptMoves++;
+        } else if (kind == SWAP) {
+            int a = moveA, c = moveC;
+            touch(previous(a)), touch(a), touch(previous(c)), touch(c);
+            tabu.add(previous(a), a, iteration + tenure);
+            tabu.add(a, next(a), iteration + tenure);
+            tabu.add(previous(c), c, iteration + tenure);
+            tabu.add(c, next(c), iteration + tenure);
+            swap(tour[position[a]], tour[position[c]]);
+            swap(position[a], position[c]);
+            r.swapMoves++;
+        }
+        if (kind != NONE) {
+            current += bestDelta;
+            if (aspiration) r.aspirations++;
+        }
+
+        if (current < r.bestCost - COST_EPSILON) {
+            r.bestCost = current;
+            best = tour;
+            lastImprovement = iteration;
+        } else if (iteration - lastImprovement >= stall) {
+            // diversify: leave the region around the best tour with a kick, then descend again
+            tour = best;
+            vector<int> ends = LocalSearch::doubleBridge(tour, rng);
+            LocalSearch::twoOpt(m, candidates, tour, ends);
+            current = m.tourCost(tour);
+            locate();
+            lastImprovement = iteration;
+            r.diversifications++;
+            if (current < r.bestCost - COST_EPSILON) {
+                r.bestCost = current;
+                best = tour;
+            }
+        }
+    }
+    r.seconds = elapsed();
+    r.iterationsPerSecond = r.seconds > 0 ? r.iterations / r.seconds : 0.0;
+
+    // report the best tour from the requested start, like the other solvers
+    auto first = find(best.begin(), best.end(), start);
+    if (first != best.end()) rotate(best.begin(), first, best.end());
+    return best;
+}
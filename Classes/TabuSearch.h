@@ -0,0 +1,126 @@
+#ifndef PROJ2_TABUSEARCH_H
+#define PROJ2_TABUSEARCH_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "DistanceMatrix.h"
+#include "Cancellation.h"
+
+/**
+ * @brief Knobs of a tabu search, see TabuSearch::solve()
+ */
+struct TabuSearchConfig {
+    int candidates = 8;     // length of the candidate list of each vertex
+    int sample = 8;         // random vertices whose moves are evaluated per iteration
+    int tenure = 10;        // iterations during which a removed edge may not be added back
+    int stall = 30;         // iterations without a new best tour before diversifying
+    double seconds = 1.0;   // time budget
+    unsigned seed = 42;
+};
+
+/**
+ * @brief What a tabu search did, see TabuSearch::solve()
+ */
+struct TabuSearchReport {
+    long iterations = 0;
+    long twoOptMoves = 0;
+    long swapMoves = 0;
+    long aspirations = 0;        // tabu moves taken because they gave a new best tour
+    long diversifications = 0;   // restarts from the best tour with a double-bridge kick
+    Cost initialCost = INFINITE_COST; // 2-opt local optimum the search started from
+    Cost bestCost = INFINITE_COST;
+    double seconds = 0.0;
+    double iterationsPerSecond = 0.0;
+};
+
+/**
+ * @brief Tabu memory of undirected edges, keyed by a hash of their ends
+ * @details Direct-mapped: each edge has one slot holding its key and the iteration its tabu status ends, so
+ * a lookup is a single probe. Two edges that share a slot overwrite each other, which only shortens the
+ * tabu status of the older one; with a table of a few thousand slots per tenure this is rare.
+ */
+class TabuList {
+public:
+    /**
+     * @brief Constructs a list with room for about the given number of edges
+     * @details Time complexity: O(capacity)
+     * @param capacity Expected number of edges tabu at once
+     */
+    explicit TabuList(std::size_t capacity);
+
+    /**
+     * @brief Makes an edge tabu until an iteration
+     * @details Time complexity: O(1)
+     * @param i One end
+     * @param j The other end
+     * @param until First iteration the edge is no longer tabu
+     */
+    void add(int i, int j, long until) {
+        Slot &slot = slots[slotOf(key(i, j))];
+        slot.key = key(i, j);
+        slot.until = until;
+    }
+
+    /**
+     * @brief Checks if an edge is tabu at an iteration
+     * @details Time complexity: O(1)
+     * @param i One end
+     * @param j The other end
+     * @param iteration Current iteration
+     * @return True if the edge may not be added
+     */
+    bool isTabu(int i, int j, long iteration) const {
+        const Slot &slot = slots[slotOf(key(i, j))];
+        return slot.key == key(i, j) && slot.until > iteration;
+    }
+
+private:
+    struct Slot {
+        uint64_t key = UINT64_MAX;
+        long until = 0;
+    };
+
+    std::vector<Slot> slots;
+    std::size_t mask;
+
+    static uint64_t key(int i, int j) {
+        if (i > j) std::swap(i, j);
+        return (uint64_t) (uint32_t) i << 32 | (uint32_t) j;
+    }
+
+    std::size_t slotOf(uint64_t k) const {
+        // Fibonacci hashing spreads consecutive ids over the table
+        return (std::size_t) ((k * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    }
+};
+
+/**
+ * @brief Tabu search over 2-opt and swap moves
+ * @details Each iteration takes the best move among those of a random sample of vertices towards their
+ * candidates, even if it makes the tour longer, so the search walks out of local optima. The ends of the last
+ * few moves are evaluated as well, since that is where the tour has just changed. The edges a move
+ * removes become tabu: a move that would add one back is skipped for tenure iterations, unless it gives a
+ * tour better than the best so far (aspiration). After stall iterations without a new best tour the search
+ * restarts from the best tour with a double-bridge kick (diversification). The weights are assumed to be
+ * symmetric, like in the 2-opt search.
+ */
+class TabuSearch {
+public:
+    /**
+     * @brief Runs tabu search from a 2-opt local optimum until the time budget or the token ends it
+     * @details A start tour that uses a missing edge is returned as it is. Time complexity: O(n^2logk) for the
+     * start, then O(s * k) to evaluate an iteration plus O(n) for a 2-opt move, where s is the sample size,
+     * against O(n^2) for the full neighbourhood
+     * @param m Distance matrix
+     * @param start Index of the first vertex of the start tour
+     * @param config Knobs of the search
+     * @param cancel Token that stops the search early, or null
+     * @param report Report to fill in, if not null
+     * @return The best tour found
+     */
+    static std::vector<int> solve(const DistanceMatrix &m, int start, const TabuSearchConfig &config,
+                                  const CancellationToken *cancel = nullptr, TabuSearchReport *report = nullptr);
+};
+
+#endif //PROJ2_TABUSEARCH_H
@@ -0,0 +1,264 @@
+#include "ThreadPool.h"
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+namespace {
+    // pool whose worker is running on this thread, and the index of that worker
+    thread_local ThreadPool *currentPool = nullptr;
+    thread_local int currentWorker = -1;
+
+    uint32_t nextRandom(uint32_t &state) {
+        // xorshift32, only used to spread the steal attempts
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+}
+
+WorkStealingDeque::Buffer::Buffer(int64_t capacity) : capacity(capacity), slots(new atomic<PoolTask *>[capacity]) {}
+
+PoolTask *WorkStealingDeque::Buffer::get(int64_t i) const {
+    return slots[i & (capacity - 1)].load(memory_order_relaxed);
+}
+
+void WorkStealingDeque::Buffer::put(int64_t i, PoolTask *task) {
+    slots[i & (capacity - 1)].store(task, memory_order_relaxed);
+}
+
+WorkStealingDeque::WorkStealingDeque(int64_t capacity) : top(0), bottom(0) {
+    buffers.emplace_back(new Buffer(capacity));
+    buffer.store(buffers.back().get(), memory_order_relaxed);
+}
+
+WorkStealingDeque::~WorkStealingDeque() {
+    // tasks left behind belong to a pool that is shutting down
+    for (int64_t i = top.load(); i < bottom.load(); i++) {
+        delete buffer.load()->get(i);
+    }
+}
+
+void WorkStealingDeque::push(PoolTask *task) {
+    int64_t b = bottom.load(memory_order_relaxed);
+    int64_t t = top.load(memory_order_acquire);
+    Buffer *a = buffer.load(memory_order_relaxed);
+    if (b - t > a->capacity - 1) {
+        Buffer *grown = new Buffer(a->capacity * 2);
+        for (int64_t i = t; i < b; i++) {
+            grown->put(i, a->get(i));
+        }
+        buffers.emplace_back(grown);
+        buffer.store(grown, memory_order_release);
+        a = grown;
+    }
+    a->put(b, task);
+    // publishes the task to the thieves, which read bottom with acquire
+    bottom.store(b + 1, memory_order_release);
+}
+
+PoolTask *WorkStealingDeque::take() {
+    int64_t b = bottom.load(memory_order_relaxed) - 1;
+    Buffer *a = buffer.load(memory_order_relaxed);
+    bottom.store(b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = top.load(memory_order_relaxed);
+    if (t > b) {
+        bottom.store(b + 1, memory_order_relaxed);
+        return nullptr;
+    }
+    PoolTask *task = a->get(b);
+    if (t == b) {
+        // last task: race the thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) task = nullptr;
+        bottom.store(b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+PoolTask *WorkStealingDeque::steal() {
+    int64_t t = top.load(memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = bottom.load(memory_order_acquire);
+    if (t >= b) return nullptr;
+    PoolTask *task = buffer.load(memory_order_acquire)->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) return nullptr;
+    return task;
+}
+
+TaskGroup::TaskGroup(ThreadPool &pool) : pool(pool), pending(0), cancelled(false) {}
+
+TaskGroup::TaskGroup() : TaskGroup(ThreadPool::shared()) {}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+void TaskGroup::run(function<void()> task) {
+    pending.fetch_add(1, memory_order_relaxed);
+    pool.submit(new PoolTask{move(task), this});
+}
+
+void TaskGroup::wait() {
+    while (pending.load(memory_order_acquire) > 0) {
+        if (!pool.runFromGroup(*this)) this_thread::yield();
+    }
+}
+
+void TaskGroup::cancel() {
+    cancelled.store(true, memory_order_relaxed);
+}
+
+bool TaskGroup::isCancelled() const {
+    return cancelled.load(memory_order_relaxed);
+}
+
+ThreadPool::ThreadPool(unsigned numWorkers) : injectedCount(0), queued(0), sleeping(0), stopping(false) {
+    for (unsigned w = 0; w < numWorkers; w++) {
+        deques.emplace_back(new WorkStealingDeque());
+    }
+    for (unsigned w = 0; w < numWorkers; w++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, (int) w);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto &w: workers) {
+        w.join();
+    }
+    for (PoolTask *task: injected) {
+        delete task;
+    }
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool([]() {
+        const char *value = getenv("PROJ2_THREADS");
+        int threads = value != nullptr ? atoi(value) : (int) thread::hardware_concurrency();
+        return (unsigned) max(0, threads - 1);
+    }());
+    return pool;
+}
+
+unsigned ThreadPool::concurrency() const {
+    return (unsigned) workers.size() + 1;
+}
+
+void ThreadPool::submit(PoolTask *task) {
+    if (currentPool == this) {
+        deques[currentWorker]->push(task);
+    } else {
+        lock_guard<mutex> lock(injectedMutex);
+        injected.push_back(task);
+        injectedCount.fetch_add(1, memory_order_relaxed);
+    }
+    queued.fetch_add(1, memory_order_seq_cst);
+    // a worker going to sleep counts itself before checking queued, so one of the two sides sees the other
+    if (sleeping.load(memory_order_seq_cst) > 0) {
+        lock_guard<mutex> lock(sleepMutex);
+        wakeUp.notify_one();
+    }
+}
+
+PoolTask *ThreadPool::findTask(int self, uint32_t &seed) {
+    PoolTask *task = nullptr;
+    if (self >= 0) task = deques[self]->take();
+    if (task == nullptr && injectedCount.load(memory_order_relaxed) > 0) {
+        lock_guard<mutex> lock(injectedMutex);
+        if (!injected.empty()) {
+            task = injected.front();
+            injected.pop_front();
+            injectedCount.fetch_sub(1, memory_order_relaxed);
+        }
+    }
+    int n = (int) deques.size();
+    for (int attempt = 0; task == nullptr && attempt < 2 * n; attempt++) {
+        int victim = (int) (nextRandom(seed) % (uint32_t) n);
+        if (victim != self) task = deques[victim]->steal();
+    }
+    if (task != nullptr) queued.fetch_sub(1, memory_order_relaxed);
+    return task;
+}
+
+void ThreadPool::execute(PoolTask *task) {
+    TaskGroup *group = task->group;
+    if (!group->isCancelled()) task->run();
+    delete task;
+    group->pending.fetch_sub(1, memory_order_release);
+}
+
+bool ThreadPool::runFromGroup(TaskGroup &group) {
+    PoolTask *task = nullptr;
+    if (currentPool == this) {
+        // the newest tasks of the deque are the ones the waiting task spawned
+        task = deques[currentWorker]->take();
+        if (task != nullptr && task->group != &group) {
+            deques[currentWorker]->push(task);
+            task = nullptr;
+        }
+    } else if (injectedCount.load(memory_order_relaxed) > 0) {
+        lock_guard<mutex> lock(injectedMutex);
+        auto it = find_if(injected.begin(), injected.end(), [&group](PoolTask *t) { return t->group == &group; });
+        if (it != injected.end()) {
+            task = *it;
+            injected.erase(it);
+            injectedCount.fetch_sub(1, memory_order_relaxed);
+        }
+    }
+    if (task == nullptr) return false;
+    queued.fetch_sub(1, memory_order_relaxed);
+    execute(task);
+    return true;
+}
+
+void ThreadPool::workerLoop(int self) {
+    currentPool = this;
+    currentWorker = self;
+    uint32_t seed = 2463534242u + 97u * (uint32_t) self;
+    while (true) {
+        PoolTask *task = findTask(self, seed);
+        if (task != nullptr) {
+            execute(task);
+            continue;
+        }
+        unique_lock<mutex> lock(sleepMutex);
+        sleeping.fetch_add(1, memory_order_seq_cst);
+        wakeUp.wait(lock, [this]() {
+            return stopping || queued.load(memory_order_seq_cst) > 0;
+        });
+        sleeping.fetch_sub(1, memory_order_relaxed);
+        if (stopping) return;
+    }
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain, const function<void(size_t, size_t)> &body,
+                             TaskGroup *group) {
+    if (begin >= end) return;
+    if (grain == 0) grain = 1;
+    if (group != nullptr) {
+        splitRange(begin, end, grain, body, *group);
+        group->wait();
+    } else {
+        TaskGroup own(*this);
+        splitRange(begin, end, grain, body, own);
+        own.wait();
+    }
+}
+
+void ThreadPool::splitRange(size_t begin, size_t end, size_t grain, const function<void(size_t, size_t)> &body,
+                            TaskGroup &group) {
+    while (end - begin > grain) {
+        size_t middle = begin + (end - begin) / 2;
+        group.run([this, middle, end, grain, &body, &group]() {
+            splitRange(middle, end, grain, body, group);
+        });
+        end = middle;
+    }
+    if (!group.isCancelled()) body(begin, end);
+}
@@ -0,0 +1,283 @@
+#ifndef PROJ2_THREADPOOL_H
+#define PROJ2_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @brief Task of a thread pool
+ */
+struct PoolTask {
+    std::function<void()> run;
+    class TaskGroup *group;
+};
+
+/**
+ * @brief Chase-Lev work-stealing deque of tasks
+ * @details The owning worker pushes and takes at the bottom, other threads steal from the top. The buffer
+ * doubles when full; replaced buffers are kept until the deque is destroyed, since a thief may still be
+ * reading one.
+ */
+class WorkStealingDeque {
+public:
+    /**
+     * @brief Constructs an empty deque
+     * @details Time complexity: O(C), where C is the initial capacity
+     * @param capacity Initial capacity, a power of two
+     */
+    explicit WorkStealingDeque(std::int64_t capacity = 256);
+
+    ~WorkStealingDeque();
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    /**
+     * @brief Adds a task at the bottom; only called by the owner
+     * @details Time complexity: O(1) amortized
+     * @param task Task
+     */
+    void push(PoolTask *task);
+
+    /**
+     * @brief Removes the most recently pushed task; only called by the owner
+     * @details Time complexity: O(1)
+     * @return The task, or nullptr if the deque is empty or a thief took the last task
+     */
+    PoolTask *take();
+
+    /**
+     * @brief Removes the oldest task; called by any thread
+     * @details Time complexity: O(1)
+     * @return The task, or nullptr if the deque is empty or another thread won the race for it
+     */
+    PoolTask *steal();
+
+private:
+    struct Buffer {
+        std::int64_t capacity;
+        std::unique_ptr<std::atomic<PoolTask *>[]> slots;
+
+        explicit Buffer(std::int64_t capacity);
+
+        PoolTask *get(std::int64_t i) const;
+
+        void put(std::int64_t i, PoolTask *task);
+    };
+
+    std::atomic<std::int64_t> top;
+    std::atomic<std::int64_t> bottom;
+    std::atomic<Buffer *> buffer;
+    std::vector<std::unique_ptr<Buffer>> buffers;
+};
+
+/**
+ * @brief Set of tasks that can be waited for and cancelled together
+ * @details Tasks of a cancelled group that have not started are skipped; running tasks can poll
+ * isCancelled() to stop early. A group must outlive its tasks, so wait() before destroying it.
+ */
+class TaskGroup {
+public:
+    /**
+     * @brief Constructs a group whose tasks run on a pool
+     * @details Time complexity: O(1)
+     * @param pool Pool, which must outlive the group
+     */
+    explicit TaskGroup(ThreadPool &pool);
+
+    /**
+     * @brief Constructs a group whose tasks run on the shared pool, see ThreadPool::shared()
+     * @details Time complexity: O(1)
+     */
+    TaskGroup();
+
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup &) = delete;
+
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    /**
+     * @brief Schedules a task
+     * @details Time complexity: O(1) amortized
+     * @param task Function to run
+     */
+    void run(std::function<void()> task);
+
+    /**
+     * @brief Waits until every task has finished or been skipped, running pool tasks meanwhile
+     * @details Time complexity: that of the tasks
+     */
+    void wait();
+
+    /**
+     * @brief Skips the tasks that have not started yet
+     * @details Time complexity: O(1)
+     */
+    void cancel();
+
+    /**
+     * @brief Checks if the group was cancelled
+     * @details Time complexity: O(1)
+     * @return True if cancel() was called
+     */
+    bool isCancelled() const;
+
+private:
+    friend class ThreadPool;
+
+    ThreadPool &pool;
+    std::atomic<int> pending;
+    std::atomic<bool> cancelled;
+};
+
+/**
+ * @brief Work-stealing task scheduler shared by the parallel parts of the solvers
+ * @details Each worker owns a Chase-Lev deque: it runs its own tasks newest first and, when it runs out,
+ * steals the oldest task of a random worker. Tasks scheduled from threads outside the pool go through a
+ * shared queue. A thread that waits for a group runs the queued tasks of that group instead of blocking, so
+ * parallel loops can nest.
+ * The shared pool has one worker less than the hardware threads, since the waiting thread works too; the
+ * PROJ2_THREADS environment variable overrides the total.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Constructs a pool
+     * @details Time complexity: O(W)
+     * @param numWorkers Number of worker threads, besides the threads that wait for tasks
+     */
+    explicit ThreadPool(unsigned numWorkers);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Gets the pool shared by the whole program, creating it on first use
+     * @details Time complexity: O(W) on the first call, O(1) after
+     * @return The shared pool
+     */
+    static ThreadPool &shared();
+
+    /**
+     * @brief Gets the number of threads that run tasks, counting the waiting thread
+     * @details Time complexity: O(1)
+     * @return Number of workers plus one
+     */
+    unsigned concurrency() const;
+
+    /**
+     * @brief Runs body over [begin, end), split into chunks of about grain indices that run in parallel
+     * @details The range is halved recursively, so idle workers steal large pieces first.
+     * Time complexity: O((end - begin) / p) plus the body, where p is the concurrency
+     * @param begin First index
+     * @param end One past the last index
+     * @param grain Largest chunk run without splitting
+     * @param body Function called with the bounds of each chunk
+     * @param group Group the chunks belong to, so that they can be cancelled; nullptr for a private group
+     */
+    void parallelFor(std::size_t begin, std::size_t end, std::size_t grain,
+                     const std::function<void(std::size_t, std::size_t)> &body, TaskGroup *group = nullptr);
+
+    /**
+     * @brief Maps fixed chunks of [begin, end) in parallel and combines the results in chunk order
+     * @details The chunks do not depend on the number of threads, so the result is the same on any machine.
+     * Time complexity: O((end - begin) / p) plus the map and combine calls
+     * @param begin First index
+     * @param end One past the last index
+     * @param grain Number of indices per chunk
+     * @param identity Result of an empty range
+     * @param map Function giving the result of the chunk [b, e)
+     * @param combine Function combining two results
+     * @return The combined result
+     */
+    template<class T, class Map, class Combine>
+    T parallelReduce(std::size_t begin, std::size_t end, std::size_t grain, T identity, Map map, Combine combine) {
+        if (grain == 0) grain = 1;
+        std::size_t numChunks = end > begin ? (end - begin + grain - 1) / grain : 0;
+        std::vector<T> partial(numChunks, identity);
+        parallelFor(0, numChunks, 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t c = first; c < last; c++) {
+                std::size_t b = begin + c * grain;
+                partial[c] = map(b, std::min(end, b + grain));
+            }
+        });
+        T result = identity;
+        for (auto &p: partial) {
+            result = combine(result, p);
+        }
+        return result;
+    }
+
+private:
+    friend class TaskGroup;
+
+    std::vector<std::unique_ptr<WorkStealingDeque>> deques;
+    std::vector<std::thread> workers;
+    std::deque<PoolTask *> injected;
+    std::atomic<int> injectedCount;
+    std::mutex injectedMutex;
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<int> queued;
+    std::atomic<int> sleeping;
+    std::atomic<bool> stopping;
+
+    /**
+     * @brief Queues a task on the deque of the calling worker, or on the shared queue
+     * @param task Task
+     */
+    void submit(PoolTask *task);
+
+    /**
+     * @brief Finds a task: own deque first, then the shared queue, then the other deques
+     * @param self Index of the calling worker, or -1 for other threads
+     * @param seed Random state used to pick the victims
+     * @return The task, or nullptr if none was found
+     */
+    PoolTask *findTask(int self, std::uint32_t &seed);
+
+    /**
+     * @brief Runs a task, or skips it if its group was cancelled, and deletes it
+     * @param task Task
+     */
+    static void execute(PoolTask *task);
+
+    /**
+     * @brief Runs one queued task of a group on the calling thread
+     * @details Only tasks of the group are run, so a thread waiting inside a task does not pick up unrelated
+     * work, which would delay the task and skew any time it measures
+     * @param group Group being waited for
+     * @return True if a task was run
+     */
+    bool runFromGroup(TaskGroup &group);
+
+    /**
+     * @brief Main loop of a worker thread
+     * @param self Index of the worker
+     */
+    void workerLoop(int self);
+
+    /**
+     * @brief Runs a chunk of a parallel loop, handing its upper half to the pool while it is above the grain
+     */
+    void splitRange(std::size_t begin, std::size_t end, std::size_t grain,
+                    const std::function<void(std::size_t, std::size_t)> &body, TaskGroup &group);
+};
+
+#endif //PROJ2_THREADPOOL_H
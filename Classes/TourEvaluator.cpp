@@ -0,0 +1,116 @@
+#include "TourEvaluator.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PROJ2_GATHER_KERNEL
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+    // tours priced by one task, so that short tours do not drown in scheduling
+    const size_t TOURS_PER_CHUNK = 64;
+    // beyond this size row * n + column no longer fits the 32-bit gather indices
+    const int MAX_GATHER_VERTICES = 46340;
+
+#ifdef PROJ2_GATHER_KERNEL
+#ifdef FIXED_POINT_WEIGHTS
+    __attribute__((target("avx2")))
+    Cost gatherTourCost(const Weight *weights, int n, const int *tour, size_t length) {
+        // eight hops per step: weights of tour[k] -> tour[k + 1], widened to 64 bits before summing
+        const __m256i rowLength = _mm256_set1_epi32(n);
+        const __m256i missingWeight = _mm256_set1_epi32(MISSING_WEIGHT);
+        __m256i sum = _mm256_setzero_si256();
+        __m256i missing = _mm256_setzero_si256();
+        size_t k = 0;
+        for (; k + 8 < length; k += 8) {
+            __m256i from = _mm256_loadu_si256((const __m256i *) (tour + k));
+            __m256i to = _mm256_loadu_si256((const __m256i *) (tour + k + 1));
+            __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(from, rowLength), to);
+            __m256i w = _mm256_i32gather_epi32((const int *) weights, index, 4);
+            missing = _mm256_or_si256(missing, _mm256_cmpeq_epi32(w, missingWeight));
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(w)));
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(w, 1)));
+        }
+        if (!_mm256_testz_si256(missing, missing)) return INFINITE_COST;
+        int64_t lanes[4];
+        _mm256_storeu_si256((__m256i *) lanes, sum);
+        Cost cost = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        for (; k < length; k++) {
+            Weight w = weights[(size_t) tour[k] * n + tour[k + 1 < length ? k + 1 : 0]];
+            if (w == MISSING_WEIGHT) return INFINITE_COST;
+            cost += w;
+        }
+        return cost;
+    }
+#else
+    __attribute__((target("avx2")))
+    Cost gatherTourCost(const Weight *weights, int n, const int *tour, size_t length) {
+        // four hops per step; a missing edge is infinity, which the sum carries to the result
+        const __m128i rowLength = _mm_set1_epi32(n);
+        __m256d sum = _mm256_setzero_pd();
+        size_t k = 0;
+        for (; k + 4 < length; k += 4) {
+            __m128i from = _mm_loadu_si128((const __m128i *) (tour + k));
+            __m128i to = _mm_loadu_si128((const __m128i *) (tour + k + 1));
+            __m128i index = _mm_add_epi32(_mm_mullo_epi32(from, rowLength), to);
+            // the masked form, from zeros, since the plain one starts from an undefined register that GCC warns about
+            __m256d hops = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), weights, index,
+                                                    _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+            sum = _mm256_add_pd(sum, hops);
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, sum);
+        Cost cost = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        for (; k < length; k++) {
+            cost += weights[(size_t) tour[k] * n + tour[k + 1 < length ? k + 1 : 0]];
+        }
+        return cost;
+    }
+#endif
+
+    bool hasAvx2() {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+#endif
+}
+
+Cost TourEvaluator::tourCost(const DistanceMatrix &m, const int *tour, size_t length) {
+#ifdef PROJ2_GATHER_KERNEL
+    // the kernel indexes rows by the stride, which is larger than the size on a leading view
+    if (length > 0 && m.rowStride() <= (size_t) MAX_GATHER_VERTICES && hasAvx2()) {
+        return gatherTourCost(m.weights(), (int) m.rowStride(), tour, length);
+    }
+#endif
+    return scalarTourCost(m, tour, length);
+}
+
+Cost TourEvaluator::scalarTourCost(const DistanceMatrix &m, const int *tour, size_t length) {
+    if (length == 0) return 0;
+    Cost cost = 0;
+    for (size_t k = 0; k < length; k++) {
+        Weight w = m.at(tour[k], tour[k + 1 < length ? k + 1 : 0]);
+        if (w == MISSING_WEIGHT) return INFINITE_COST;
+        cost += w;
+    }
+    return cost;
+}
+
+void TourEvaluator::evaluate(const DistanceMatrix &m, const vector<vector<int>> &tours, vector<Cost> &costs,
+                             ThreadPool &pool) {
+    costs.assign(tours.size(), 0);
+    pool.parallelFor(0, tours.size(), TOURS_PER_CHUNK, [&](size_t first, size_t last) {
+        for (size_t t = first; t < last; t++) {
+            costs[t] = tourCost(m, tours[t].data(), tours[t].size());
+        }
+    });
+}
+
+bool TourEvaluator::usesGathers() {
+#ifdef PROJ2_GATHER_KERNEL
+    return hasAvx2();
+#else
+    return false;
+#endif
+}
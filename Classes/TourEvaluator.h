@@ -0,0 +1,57 @@
+#ifndef PROJ2_TOUREVALUATOR_H
+#define PROJ2_TOUREVALUATOR_H
+
+#include <vector>
+#include <cstddef>
+#include "DistanceMatrix.h"
+#include "ThreadPool.h"
+
+/**
+ * @brief Computes the costs of many tours against a distance matrix at once
+ * @details Meant for population-based and multi-start solvers, which price thousands of tours. On x86-64
+ * processors with AVX2 the hops of a tour are priced with gather instructions, checked at run time, and a
+ * batch is split across the threads of a pool. Tours are vectors of matrix indices without repeating the
+ * first vertex, like in LocalSearch.
+ */
+class TourEvaluator {
+public:
+    /**
+     * @brief Calculates the cost of a closed tour
+     * @details Time complexity: O(n)
+     * @param m Distance matrix
+     * @param tour Indices of the vertices in visiting order
+     * @param length Number of vertices in the tour
+     * @return The cost, including the edge back to the first vertex, or INFINITE_COST if an edge is missing
+     */
+    static Cost tourCost(const DistanceMatrix &m, const int *tour, std::size_t length);
+
+    /**
+     * @brief Calculates the cost of a closed tour one hop at a time, without vector instructions
+     * @details Time complexity: O(n)
+     * @param m Distance matrix
+     * @param tour Indices of the vertices in visiting order
+     * @param length Number of vertices in the tour
+     * @return The cost, including the edge back to the first vertex, or INFINITE_COST if an edge is missing
+     */
+    static Cost scalarTourCost(const DistanceMatrix &m, const int *tour, std::size_t length);
+
+    /**
+     * @brief Calculates the costs of a batch of tours
+     * @details Time complexity: O(T * n / p), where T is the number of tours and p the number of threads
+     * @param m Distance matrix
+     * @param tours Tours
+     * @param costs Vector to store the cost of each tour, in the same order
+     * @param pool Pool that runs the batch
+     */
+    static void evaluate(const DistanceMatrix &m, const std::vector<std::vector<int>> &tours,
+                         std::vector<Cost> &costs, ThreadPool &pool = ThreadPool::shared());
+
+    /**
+     * @brief Checks if tourCost() uses the AVX2 kernel on this processor
+     * @details Time complexity: O(1)
+     * @return True if AVX2 gathers are used
+     */
+    static bool usesGathers();
+};
+
+#endif //PROJ2_TOUREVALUATOR_H
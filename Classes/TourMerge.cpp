@@ -0,0 +1,355 @@
+#include "TourMerge.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+    // codes of the frontier vertices in a state; any larger code labels a path end, shared with its other end
+    const unsigned char FREE = 0;  // no chosen edge yet
+    const unsigned char DONE = 1;  // both edges chosen
+    const int MAX_FRONTIER = 250;
+
+    // how a state was reached: the state of the previous step and the edges chosen to the new vertex
+    struct Back {
+        int parent;
+        int first;
+        int second;
+    };
+
+    struct State {
+        string codes;
+        Cost cost;
+    };
+
+    bool isPermutation(const vector<int> &tour, int n) {
+        if ((int) tour.size() != n) return false;
+        vector<bool> seen(n, false);
+        for (int v: tour) {
+            if (v < 0 || v >= n || seen[v]) return false;
+            seen[v] = true;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Measures the largest frontier of the dynamic program when adding the vertices in an order
+     * @param adj Union graph
+     * @param order Vertex order
+     * @param position Vector to store the position of each vertex in the order
+     * @return The largest number of added vertices with edges to vertices not added yet
+     */
+    int frontierWidth(const vector<vector<int>> &adj, const vector<int> &order, vector<int> &position) {
+        int n = (int) order.size();
+        for (int k = 0; k < n; k++) {
+            position[order[k]] = k;
+        }
+        // each vertex joins the frontier when added and leaves once its last neighbour is added
+        vector<int> delta(n + 1, 0);
+        for (int v = 0; v < n; v++) {
+            int last = position[v];
+            for (int w: adj[v]) last = max(last, position[w]);
+            delta[position[v]]++;
+            delta[last]--;
+        }
+        int width = 0, best = 0;
+        for (int k = 0; k < n; k++) {
+            width += delta[k];
+            best = max(best, width);
+        }
+        return best;
+    }
+
+    /**
+     * @brief Renumbers the path labels in order of first appearance, so equal states get equal codes
+     * @param codes Codes of a state, modified in place
+     */
+    void canonicalize(string &codes) {
+        unsigned char renamed[256] = {};
+        unsigned char next = DONE + 1;
+        for (char &c: codes) {
+            auto code = (unsigned char) c;
+            if (code <= DONE) continue;
+            if (renamed[code] == 0) renamed[code] = next++;
+            c = (char) renamed[code];
+        }
+    }
+
+    /**
+     * @brief Runs the dynamic program over the union graph of some tours
+     * @param m Distance matrix
+     * @param tours Tours of matrix indices
+     * @param maxStates Largest number of states kept at one step
+     * @param r Report to fill in, except for the time
+     * @param stop Check of the token that stops the merge
+     * @return The merged tour, or an empty tour if no input tour is valid
+     */
+    vector<int> mergeUnion(const DistanceMatrix &m, const vector<vector<int>> &tours, size_t maxStates,
+                           TourMergeReport &r, CancellationCheck &stop) {
+        r = TourMergeReport();
+        int n = m.size();
+
+        vector<int> best;
+        vector<vector<int>> adj(n);
+        for (const auto &tour: tours) {
+            if (!isPermutation(tour, n)) continue;
+            r.inputTours++;
+            Cost cost = m.tourCost(tour);
+            if (best.empty() || cost < r.bestInputCost) {
+                best = tour;
+                r.bestInputCost = cost;
+            }
+            for (int k = 0; k < n; k++) {
+                int u = tour[k], v = tour[(k + 1) % n];
+                if (u != v && m.at(u, v) != MISSING_WEIGHT && m.at(v, u) != MISSING_WEIGHT) {
+                    adj[u].push_back(v);
+                    adj[v].push_back(u);
+                }
+            }
+        }
+        if (best.empty() || n < 4) return best;
+        for (auto &a: adj) {
+            sort(a.begin(), a.end());
+            a.erase(unique(a.begin(), a.end()), a.end());
+            r.unionEdges += a.size();
+        }
+        r.unionEdges /= 2;
+
+        // vertices are added in the order of one of the tours, from the rotation with the narrowest frontier; a
+        // vertex leaves the frontier once all its neighbours were added, and must have both edges by then
+        vector<int> order = best, position(n), candidate(n);
+        int narrowest = frontierWidth(adj, order, position);
+        const int rotations = 64;
+        for (const auto &tour: tours) {
+            if (!isPermutation(tour, n)) continue;
+            for (int k = 0; k < rotations && k < n; k++) {
+                auto first = tour.begin() + (ptrdiff_t) k * n / min(rotations, n);
+                rotate_copy(tour.begin(), first, tour.end(), candidate.begin());
+                int width = frontierWidth(adj, candidate, position);
+                if (width < narrowest) {
+                    narrowest = width;
+                    order = candidate;
+                }
+            }
+        }
+        frontierWidth(adj, order, position);
+        vector<Cost> cheapest(n, 0);
+        for (int v = 0; v < n; v++) {
+            for (int w: adj[v]) {
+                if (w == adj[v][0] || m.at(v, w) < cheapest[v]) cheapest[v] = m.at(v, w);
+            }
+        }
+        vector<vector<int>> leaving(n);
+        for (int v = 0; v < n; v++) {
+            int last = position[v];
+            for (int w: adj[v]) last = max(last, position[w]);
+            leaving[last].push_back(v);
+        }
+
+        vector<int> frontier, slot(n, -1);
+        vector<State> states(1, State{string(), 0}), next;
+        vector<vector<Back>> backs(n);
+        unordered_map<string, int> seen;
+        string codes;
+
+        for (int step = 0; step < n; step++) {
+            int v = order[step];
+            bool last = step == n - 1;
+            vector<int> earlier;
+            for (int w: adj[v]) {
+                if (position[w] < step) earlier.push_back(slot[w]);
+            }
+            // the frontier after this step: the old one plus v, without the vertices that leave
+            int width = (int) frontier.size() + 1;
+            if (width > MAX_FRONTIER) {
+                // the labels would not fit in a byte; such tours disagree too much to be merged anyway
+                r.exact = false;
+                states.clear();
+                break;
+            }
+            vector<bool> leaves(width, false);
+            for (int w: leaving[step]) {
+                leaves[w == v ? width - 1 : slot[w]] = true;
+            }
+
+            next.clear();
+            seen.clear();
+            vector<Back> &back = backs[step];
+            back.clear();
+            // applies the choice of edges to the new vertex to a state, and keeps the result if it is valid
+            auto emit = [&](int parent, Cost cost, int first, int second) {
+                string kept;
+                kept.reserve(width);
+                for (int k = 0; k < width; k++) {
+                    if (!leaves[k]) {
+                        kept.push_back(codes[k]);
+                    } else if ((unsigned char) codes[k] != DONE) {
+                        return;
+                    }
+                }
+                canonicalize(kept);
+                auto it = seen.find(kept);
+                if (it == seen.end()) {
+                    seen.emplace(kept, (int) next.size());
+                    next.push_back(State{kept, cost});
+                    back.push_back(Back{parent, first, second});
+                } else if (cost < next[it->second].cost) {
+                    next[it->second].cost = cost;
+                    back[it->second] = Back{parent, first, second};
+                }
+            };
+
+            for (int s = 0; s < (int) states.size() && !stop.step(); s++) {
+                const string &old = states[s].codes;
+                Cost cost = states[s].cost;
+                // a label no path uses yet
+                auto fresh = (unsigned char) (DONE + 1 + width);
+
+                // no edge yet
+                codes = old;
+                codes.push_back((char) FREE);
+                emit(s, cost, -1, -1);
+
+                for (size_t i = 0; i < earlier.size(); i++) {
+                    int a = earlier[i];
+                    auto ca = (unsigned char) old[a];
+                    if (ca == DONE) continue;
+                    int u = frontier[a];
+                    Cost withA = cost + m.at(u, v);
+
+                    // one edge: v becomes a path end
+                    codes = old;
+                    codes.push_back((char) (ca == FREE ? fresh : ca));
+                    codes[a] = (char) (ca == FREE ? fresh : DONE);
+                    emit(s, withA, u, -1);
+
+                    // two edges: v becomes an inner vertex and the two paths are joined
+                    for (size_t j = i + 1; j < earlier.size(); j++) {
+                        int b = earlier[j];
+                        auto cb = (unsigned char) old[b];
+                        if (cb == DONE) continue;
+                        int w = frontier[b];
+                        codes = old;
+                        codes.push_back((char) DONE);
+                        if (ca == FREE && cb == FREE) {
+                            codes[a] = codes[b] = (char) fresh;
+                        } else if (ca == FREE || cb == FREE) {
+                            codes[a] = (char) (ca == FREE ? cb : DONE);
+                            codes[b] = (char) (cb == FREE ? ca : DONE);
+                        } else if (ca != cb) {
+                            codes[a] = codes[b] = (char) DONE;
+                            replace(codes.begin(), codes.end(), (char) cb, (char) ca);
+                        } else {
+                            // both ends of one path: this closes the tour, which must then hold every vertex
+                            if (!last) continue;
+                            codes[a] = codes[b] = (char) DONE;
+                        }
+                        emit(s, withA + m.at(v, w), u, w);
+                    }
+                }
+            }
+
+            // move to the frontier of the next step
+            frontier.push_back(v);
+            vector<int> remaining;
+            for (int k = 0; k < width; k++) {
+                if (leaves[k]) {
+                    slot[frontier[k]] = -1;
+                } else {
+                    slot[frontier[k]] = (int) remaining.size();
+                    remaining.push_back(frontier[k]);
+                }
+            }
+            frontier.swap(remaining);
+            if (next.size() > maxStates) {
+                // keep the states with the smallest cost plus a bound on the edges their frontier still needs,
+                // counted as half an edge per missing degree; both sides are doubled to stay in integers
+                vector<Cost> bound(next.size());
+                for (size_t k = 0; k < next.size(); k++) {
+                    bound[k] = 2 * next[k].cost;
+                    const string &c = next[k].codes;
+                    for (size_t f = 0; f < c.size(); f++) {
+                        auto code = (unsigned char) c[f];
+                        if (code != DONE) bound[k] += (code == FREE ? 2 : 1) * cheapest[frontier[f]];
+                    }
+                }
+                vector<int> rank(next.size());
+                for (size_t k = 0; k < rank.size(); k++) rank[k] = (int) k;
+                nth_element(rank.begin(), rank.begin() + (ptrdiff_t) maxStates, rank.end(),
+                            [&](int x, int y) { return bound[x] < bound[y]; });
+                rank.resize(maxStates);
+                vector<State> kept;
+                vector<Back> keptBack;
+                for (int k: rank) {
+                    kept.push_back(std::move(next[k]));
+                    keptBack.push_back(back[k]);
+                }
+                next.swap(kept);
+                back.swap(keptBack);
+                r.exact = false;
+            }
+            if (stop.wasCancelled()) {
+                r.exact = false;
+                states.clear();
+                break;
+            }
+            r.maxStates = max(r.maxStates, next.size());
+            r.maxFrontier = max(r.maxFrontier, (int) frontier.size());
+            states.swap(next);
+            if (states.empty()) break;
+        }
+
+        vector<int> tour = best;
+        // after the last step the only state left is the closed tour, if it was not dropped
+        if (!states.empty() && states[0].codes.empty() && states[0].cost < r.bestInputCost) {
+            vector<vector<int>> chosen(n);
+            int s = 0;
+            for (int step = n - 1; step >= 0; step--) {
+                const Back &b = backs[step][s];
+                for (int w: {b.first, b.second}) {
+                    if (w == -1) continue;
+                    chosen[order[step]].push_back(w);
+                    chosen[w].push_back(order[step]);
+                }
+                s = b.parent;
+            }
+            tour.clear();
+            int previous = -1, current = order[0];
+            do {
+                tour.push_back(current);
+                int following = chosen[current][0] == previous ? chosen[current][1] : chosen[current][0];
+                previous = current;
+                current = following;
+            } while (current != order[0]);
+            rotate(tour.begin(), find(tour.begin(), tour.end(), best[0]), tour.end());
+        }
+        return tour;
+    }
+}
+
+vector<int> TourMerge::merge(const DistanceMatrix &m, const vector<vector<int>> &tours, size_t maxStates,
+                             TourMergeReport *report, const CancellationToken *cancel) {
+    auto begin = chrono::steady_clock::now();
+    TourMergeReport local;
+    TourMergeReport &r = report ? *report : local;
+    CancellationCheck stop(cancel);
+    vector<int> tour = mergeUnion(m, tours, maxStates, r, stop);
+    if (!r.exact && r.inputTours > 2 && !stop.wasCancelled()) {
+        // the union of two tours has a much narrower frontier, so merge the result with each tour in turn;
+        // every merge keeps the better of its two inputs at worst
+        Cost cost = m.tourCost(tour);
+        for (const auto &other: tours) {
+            TourMergeReport pair;
+            vector<int> merged = mergeUnion(m, {tour, other}, maxStates, pair, stop);
+            if (stop.wasCancelled()) break;
+            if (pair.inputTours == 2 && m.tourCost(merged) < cost) {
+                tour = merged;
+                cost = m.tourCost(merged);
+            }
+        }
+    }
+    r.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    return tour;
+}
@@ -0,0 +1,58 @@
+#ifndef PROJ2_TOURMERGE_H
+#define PROJ2_TOURMERGE_H
+
+#include <vector>
+#include <cstddef>
+#include "DistanceMatrix.h"
+#include "Cancellation.h"
+
+/**
+ * @brief What a tour merge looked at, see TourMerge::merge()
+ */
+struct TourMergeReport {
+    int inputTours = 0;            // tours that were valid permutations of the matrix indices
+    std::size_t unionEdges = 0;    // undirected edges used by at least one tour
+    int maxFrontier = 0;           // largest number of vertices with edges across the cut
+    std::size_t maxStates = 0;     // largest number of states kept at one step
+    bool exact = true;             // false if some step had to drop states, so better tours may exist in the union
+    Cost bestInputCost = INFINITE_COST;
+    double seconds = 0.0;
+};
+
+/**
+ * @brief Tour merging: the best tour that only uses edges of a few good tours
+ * @details Good tours share most of their edges, so the graph made of their union has a degree close to 2 and
+ * the best tour inside it is usually better than each of them while staying cheap to find exactly. The search
+ * is a dynamic program over the vertices in the order of the best input tour. After each vertex the state is
+ * how the chosen edges meet the cut between the vertices seen and those not seen yet: the degree of every
+ * vertex with union edges across the cut, and which of them are the two ends of the same path. Its cost
+ * depends on the number of such vertices, which stays small when the tours agree.
+ * The weights are assumed to be symmetric, like in the 2-opt search.
+ */
+class TourMerge {
+public:
+    /** Default largest number of states kept at one step */
+    static const std::size_t DEFAULT_MAX_STATES = 1 << 14;
+
+    /**
+     * @brief Finds the best tour in the union graph of some tours
+     * @details Tours that are not permutations of the matrix indices are ignored. When a step has more than
+     * maxStates states only the most promising ones are kept and the report is marked as not exact, and the
+     * result is then also merged with each input in turn, two tours at a time, whose unions are much narrower.
+     * The result is never worse than the best input. Time complexity: O(n * S * d^2 * F), where S is the number
+     * of states per step, d the degree in the union graph and F the width of the frontier
+     * @param m Distance matrix
+     * @param tours Tours of matrix indices, without repeating the first vertex
+     * @param maxStates Largest number of states kept at one step
+     * @param report Report to fill in, if not null
+     * @param cancel Token that stops the merge, which then returns the best input and marks the report as not
+     * exact, or null
+     * @return The merged tour, starting at the first vertex of the best input, or an empty tour if no input
+     * tour is valid
+     */
+    static std::vector<int> merge(const DistanceMatrix &m, const std::vector<std::vector<int>> &tours,
+                                  std::size_t maxStates = DEFAULT_MAX_STATES, TourMergeReport *report = nullptr,
+                                  const CancellationToken *cancel = nullptr);
+};
+
+#endif //PROJ2_TOURMERGE_H
@@ -0,0 +1,144 @@
+#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TRACE_HAS_RDTSC
+#endif
+
+using namespace std;
+
+namespace {
+    struct Span {
+        const char *name;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    struct ThreadBuffer {
+        int tid;
+        uint64_t count = 0;
+        vector<Span> spans;
+    };
+
+    atomic<bool> enabled(false);
+    mutex registryMutex;
+    vector<shared_ptr<ThreadBuffer>> registry;
+
+    // reference point used to convert ticks to microseconds
+    uint64_t originTicks = 0;
+    chrono::steady_clock::time_point originTime;
+
+    ThreadBuffer &threadBuffer() {
+        thread_local shared_ptr<ThreadBuffer> buffer;
+        if (!buffer) {
+            buffer = make_shared<ThreadBuffer>();
+            buffer->spans.resize(Trace::BUFFER_SIZE);
+            lock_guard<mutex> lock(registryMutex);
+            buffer->tid = (int) registry.size() + 1;
+            registry.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    void writeEscaped(FILE *out, const char *s) {
+        for (; *s; s++) {
+            if (*s == '"' || *s == '\\') fputc('\\', out);
+            fputc(*s, out);
+        }
+    }
+}
+
+const int Trace::BUFFER_SIZE;
+
+void Trace::enable() {
+    lock_guard<mutex> lock(registryMutex);
+    if (!enabled.load()) {
+        originTime = chrono::steady_clock::now();
+        originTicks = now();
+        enabled.store(true);
+    }
+}
+
+bool Trace::isEnabled() {
+    return enabled.load(memory_order_relaxed);
+}
+
+void Trace::enableFromEnvironment() {
+    const char *file = getenv("PROJ2_TRACE");
+    if (file != nullptr && *file != '\0') enable();
+}
+
+void Trace::writeFromEnvironment() {
+    const char *file = getenv("PROJ2_TRACE");
+    if (file != nullptr && *file != '\0' && isEnabled()) writeChromeJson(file);
+}
+
+uint64_t Trace::now() {
+#ifdef TRACE_HAS_RDTSC
+    return __rdtsc();
+#else
+    return (uint64_t) chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void Trace::record(const char *name, uint64_t begin, uint64_t end) {
+    ThreadBuffer &buffer = threadBuffer();
+    Span &span = buffer.spans[buffer.count % BUFFER_SIZE];
+    span.name = name;
+    span.begin = begin;
+    span.end = end;
+    buffer.count++;
+}
+
+bool Trace::writeChromeJson(const string &filename) {
+    FILE *out = fopen(filename.c_str(), "w");
+    if (out == nullptr) return false;
+
+    lock_guard<mutex> lock(registryMutex);
+    // calibrate the tick rate over the whole recording
+    double elapsedUs = chrono::duration<double, micro>(chrono::steady_clock::now() - originTime).count();
+    uint64_t elapsedTicks = now() - originTicks;
+    double ticksPerUs = elapsedUs > 0 ? elapsedTicks / elapsedUs : 1.0;
+
+    fprintf(out, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto &buffer: registry) {
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+                first ? "" : ",\n", buffer->tid, buffer->tid == 1 ? "main" : "worker", buffer->tid);
+        first = false;
+        uint64_t kept = buffer->count < (uint64_t) BUFFER_SIZE ? buffer->count : BUFFER_SIZE;
+        for (uint64_t k = buffer->count - kept; k < buffer->count; k++) {
+            const Span &span = buffer->spans[k % BUFFER_SIZE];
+            if (span.begin < originTicks) continue;
+            fprintf(out, ",\n{\"name\":\"");
+            writeEscaped(out, span.name);
+            fprintf(out, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", buffer->tid,
+                    (span.begin - originTicks) / ticksPerUs, (span.end - span.begin) / ticksPerUs);
+        }
+    }
+    fprintf(out, "\n]}\n");
+    return fclose(out) == 0;
+}
+
+TraceSpan::TraceSpan(const char *name) : name(name), begin(0), active(Trace::isEnabled()) {
+    if (active) begin = Trace::now();
+}
+
+void TraceSpan::end() {
+    if (active) {
+        Trace::record(name, begin, Trace::now());
+        active = false;
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    end();
+}
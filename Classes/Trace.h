@@ -0,0 +1,99 @@
+#ifndef PROJ2_TRACE_H
+#define PROJ2_TRACE_H
+
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Timeline recorder for the load and solve pipeline
+ * @details Spans are kept in a fixed-size ring buffer per thread, timestamped with the CPU time stamp
+ * counter where available, and exported in the Chrome trace event format (chrome://tracing, Perfetto).
+ * Recording is off until enable() is called, in which case a span costs a single flag check.
+ */
+class Trace {
+public:
+    /** Number of spans kept per thread, older spans are overwritten */
+    static const int BUFFER_SIZE = 1 << 16;
+
+    /**
+     * @brief Starts recording spans
+     * @details Time complexity: O(1)
+     */
+    static void enable();
+
+    /**
+     * @brief Checks if spans are being recorded
+     * @details Time complexity: O(1)
+     * @return True if recording
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Enables recording if the PROJ2_TRACE environment variable names an output file
+     * @details Time complexity: O(1)
+     */
+    static void enableFromEnvironment();
+
+    /**
+     * @brief Writes the spans of all threads as Chrome trace JSON
+     * @details Time complexity: O(S), where S is the number of recorded spans. Should be called while
+     * no other thread is recording
+     * @param filename Output file
+     * @return True if the file was written
+     */
+    static bool writeChromeJson(const std::string &filename);
+
+    /**
+     * @brief Writes the trace to the file named by PROJ2_TRACE, if recording was enabled from the environment
+     * @details Time complexity: O(S), where S is the number of recorded spans
+     */
+    static void writeFromEnvironment();
+
+    /**
+     * @brief Reads the timestamp counter used for spans
+     * @details Time complexity: O(1)
+     * @return Current tick count
+     */
+    static uint64_t now();
+
+    /**
+     * @brief Records a finished span on the calling thread
+     * @details Time complexity: O(1)
+     * @param name Name of the span, must be a string literal or otherwise outlive the trace
+     * @param begin Tick count at the start of the span
+     * @param end Tick count at the end of the span
+     */
+    static void record(const char *name, uint64_t begin, uint64_t end);
+};
+
+/**
+ * @brief Records the time between its construction and destruction as a trace span
+ */
+class TraceSpan {
+public:
+    /**
+     * @brief Starts the span
+     * @details Time complexity: O(1)
+     * @param name Name of the span, must be a string literal or otherwise outlive the trace
+     */
+    explicit TraceSpan(const char *name);
+
+    /**
+     * @brief Ends the span early
+     * @details Time complexity: O(1). Does nothing if the span has already ended
+     */
+    void end();
+
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan &) = delete;
+
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *name;
+    uint64_t begin;
+    bool active;
+};
+
+#endif //PROJ2_TRACE_H
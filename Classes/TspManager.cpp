@@ -1,4 +1,12 @@
 #include "TspManager.h"
+#include <thread>
+#include <atomic>
+#include <random>
+#include <set>
+#include <mutex>
+#include "Autotuner.h"
+#include "TourEvaluator.h"
+#include "ThreadPool.h"
 
 using namespace std;
 
@@ -7,6 +15,7 @@ TspManager::TspManager() {
 }
 
 TspManager::TspManager(const Data &d) {
+    TraceSpan span("buildGraph");
     graph = d.getGraph();
     nodesloc = d.getNodesLoc();
     labels = d.getLabels();
@@ -16,18 +25,21 @@ void TspManager::tspBacktracking() {
     if (!graph.getVertexSet().empty()) {
         vector<int> bestTour;
         double totalWeight = INT_MAX;
+        AllocationScope alloc;
         auto start = chrono::high_resolution_clock::now();
         tspBacktrackingMethod(bestTour, totalWeight);
         auto end = chrono::high_resolution_clock::now();
 
         chrono::duration<double> duration = end - start;
 
+        TraceSpan output("output");
         cout << "Best tour: ";
         for (int i: bestTour) {
             cout << i << " ";
         }
         cout << endl << "Total weight: " << totalWeight << endl;
         cout << "Time taken by algorithm: " << to_string(duration.count()) << " seconds" << endl;
+        alloc.print("tspBacktracking");
 
     } else {
         cout << "Graph is empty" << endl;
@@ -35,51 +47,20 @@ void TspManager::tspBacktracking() {
 }
 
 void TspManager::tspBacktrackingMethod(vector<int> &bestTour, double &minTourCost) {
-    int startNode = 0;
-    vector<int> tour = {startNode};
-    vector<bool> visited(graph.getNumVertex(), false);
-    visited[startNode] = true;
-    tspRec(tour, visited, 0.0, minTourCost, bestTour);
-}
-
-void TspManager::tspRec(vector<int> &tour, vector<bool> &visited, double currentCost, double &minCost,
-                        vector<int> &bestTour) {
-    int numVertices = graph.getNumVertex();
-
-    if (tour.size() == numVertices) {
-        int lastNode = tour.back();
-        double returnCost = getEdgeWeight(graph, lastNode, tour[0]);
-        if (returnCost > 0) {
-            double totalCost = currentCost + returnCost;
-            if (totalCost < minCost) {
-                minCost = totalCost;
-                bestTour = tour;
-                bestTour.push_back(tour[0]);
-            }
-        }
-    } else {
-        for (int i = 0; i < numVertices; ++i) {
-            if (!visited[i]) {
-                int lastNode = tour.back();
-                if (hasEdge(graph.findVertex(lastNode), graph.findVertex(i))) {
-                    visited[i] = true;
-                    tour.push_back(i);
-                    tspRec(tour, visited, currentCost + getEdgeWeight(graph, lastNode, i), minCost, bestTour);
-                    visited[i] = false;
-                    tour.pop_back();
-                }
-            }
-        }
+    const DistanceMatrix &m = getEdgeMatrix();
+    TraceSpan span("backtrackingSearch");
+    int start = m.findIndex(0);
+    if (start == -1) start = 0;
+    vector<int> indices;
+    double cost = toDouble(ExactSolver::branchAndBound(m, start, indices, checkpoint, cancellation));
+    if (indices.empty() && wasCancelled()) {
+        indices = LocalSearch::nearestNeighbour(m, start);
+        cost = toDouble(m.tourCost(indices));
     }
-}
-
-bool TspManager::hasEdge(Vertex<int> *pVertex, Vertex<int> *pVertex1) {
-    for (auto edge: pVertex->getAdj()) {
-        if (edge->getDest() == pVertex1) {
-            return true;
-        }
+    if (cost < minTourCost) {
+        minTourCost = cost;
+        toNodeTour(m, indices, bestTour);
     }
-    return false;
 }
 
 double TspManager::getEdgeWeight(Graph<int> &graph, int node, int i) {
@@ -100,9 +81,11 @@ struct CompareEdgeWeights {
 
 void TspManager::tspPrim(bool incompleteGraph) {
     if (incompleteGraph) {
+        TraceSpan span("completeGraph");
         completeGraph(graph);
     }
     if (graph.getNumVertex() == 0) return;
+    AllocationScope alloc;
     Vertex<int> *startVertex = graph.getVertexSet()[0];
 
     unordered_set<Vertex<int> *> visitedVertices;
@@ -114,8 +97,10 @@ void TspManager::tspPrim(bool incompleteGraph) {
     vector<Edge<int> *> shortestPathEdges;
 
     auto start = chrono::high_resolution_clock::now();
+    TraceSpan mstSpan("primMST");
 
-    while (!pq.empty() && visitedVertices.size() < graph.getNumVertex()) {
+    CancellationCheck stop(cancellation);
+    while (!pq.empty() && visitedVertices.size() < graph.getNumVertex() && !stop.step()) {
         Edge<int> *minEdge = pq.top();
         pq.pop();
         Vertex<int> *destVertex = minEdge->getDest();
@@ -129,25 +114,28 @@ void TspManager::tspPrim(bool incompleteGraph) {
     }
 
     auto end = chrono::high_resolution_clock::now();
+    mstSpan.end();
 
     chrono::duration<double> duration = end - start;
 
-    int totalWeight = 0;
+    TraceSpan output("costAndOutput");
+    Cost totalWeight = 0;
     for (Edge<int> *edge: shortestPathEdges) {
         cout << edge->getOrig()->getInfo() << " -> " << edge->getDest()->getInfo() << " (Weight: "
              << edge->getWeight() << ")" << endl;
-        totalWeight += edge->getWeight();
+        totalWeight += toWeight(edge->getWeight());
     }
 
     if (!shortestPathEdges.empty()) {
         Vertex<int> *lastVertex = shortestPathEdges.back()->getDest();
         cout << lastVertex->getInfo() << " -> " << startVertex->getInfo() << " (Weight: "
              << graph.getEdgeWeight(lastVertex->getInfo(), startVertex->getInfo()) << ")" << endl;
-        totalWeight += graph.getEdgeWeight(lastVertex->getInfo(), startVertex->getInfo());
+        totalWeight += toWeight(graph.getEdgeWeight(lastVertex->getInfo(), startVertex->getInfo()));
     }
 
-    cout << "Total weight: " << totalWeight << endl;
+    cout << "Total weight: " << toDouble(totalWeight) << endl;
     cout << "Time taken by algorithm: " << to_string(duration.count()) << " seconds" << endl;
+    alloc.print("tspPrim");
 }
 
 float TspManager::getLatitude(Vertex<int> *vertex) const {
@@ -206,21 +194,7 @@ void TspManager::completeGraph(Graph<int> graphCopy) {
 }
 
 double TspManager::haversineDistance(double lat1, double lon1, double lat2, double lon2) {
-
-    double lat1Rad = lat1 * M_PI / 180.0;
-    double lon1Rad = lon1 * M_PI / 180.0;
-    double lat2Rad = lat2 * M_PI / 180.0;
-    double lon2Rad = lon2 * M_PI / 180.0;
-
-    double dLat = lat2Rad - lat1Rad;
-    double dLon = lon2Rad - lon1Rad;
-    double a = sin(dLat / 2) * sin(dLat / 2) +
-               cos(lat1Rad) * cos(lat2Rad) *
-               sin(dLon / 2) * sin(dLon / 2);
-    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-    double distance = 6371 * c;
-
-    return distance;
+    return DistanceMatrix::haversineDistance(lat1, lon1, lat2, lon2);
 }
 
 void TspManager::tspTriangularHeuristicInput() {
@@ -236,36 +210,47 @@ void TspManager::tspTriangularHeuristicInput() {
 
         vector<int> bestTour;
 
+        AllocationScope alloc;
         auto start = chrono::high_resolution_clock::now();
         tspTriangularHeuristicMethod(bestTour, startNode);
         auto end = chrono::high_resolution_clock::now();
         chrono::duration<double> duration = end - start;
 
+        TraceSpan output("costAndOutput");
         cout << "Best tour: ";
-        int sum = 0;
+        Cost sum = 0;
         for (int i = 0; i < bestTour.size(); i++) {
             cout << bestTour[i] << " ";
             if (i > 0) {
-                sum += getEdgeWeight(graph, bestTour[i - 1], bestTour[i]);
+                sum += toWeight(getEdgeWeight(graph, bestTour[i - 1], bestTour[i]));
             }
         }
 
-        sum += graph.getEdgeWeight(bestTour.back(), bestTour[0]);
+        sum += toWeight(graph.getEdgeWeight(bestTour.back(), bestTour[0]));
         cout << bestTour[0] << endl;
-        cout << "Total distance: " << sum << endl;
+        cout << "Total distance: " << toDouble(sum) << endl;
         cout << "Time taken by the algorithm: " << to_string(duration.count()) << " seconds" << endl;
+        alloc.print("tspTriangularHeuristic");
     } else {
         cout << "Graph is empty" << endl;
     }
 }
 
 void TspManager::tspTriangularHeuristicMethod(vector<int> &bestTour, int startNode) {
+    TraceSpan span("nearestNeighbourConstruct");
     vector<int> tour;
     vector<bool> visited(graph.getNumVertex(), false);
     tour.push_back(startNode);
     visited[startNode] = true;
     int currentNode = startNode;
     while (tour.size() < graph.getNumVertex()) {
+        if (wasCancelled()) {
+            // the rest of the vertices in id order, so the tour still visits them all
+            for (int i = 0; i < graph.getNumVertex(); i++) {
+                if (!visited[i]) tour.push_back(i);
+            }
+            break;
+        }
         double minDist = numeric_limits<double>::max();
         int nextNode = -1;
         for (int i = 0; i < graph.getNumVertex(); i++) {
@@ -290,7 +275,8 @@ void TspManager::tspTriangularHeuristicMethod(vector<int> &bestTour, int startNo
 }
 
 
-vector<Vertex<int> *> TspManager::primMPQ(Graph<int> *g) {
+vector<Vertex<int> *> TspManager::primMPQ(Graph<int> *g) const {
+    TraceSpan span("primMST");
     if (g->getVertexSet().empty()) {
         return g->getVertexSet();
     }
@@ -303,7 +289,8 @@ vector<Vertex<int> *> TspManager::primMPQ(Graph<int> *g) {
     s->setDist(0);
     MutablePriorityQueue<Vertex<int>> q;
     q.insert(s);
-    while (!q.empty()) {
+    // when cancelled, the vertices not reached yet keep their tentative edge or none, which leaves a forest
+    while (!q.empty() && !wasCancelled()) {
         auto v = q.extractMin();
         v->setVisited(true);
         for (auto &e: v->getAdj()) {
@@ -331,16 +318,19 @@ void TspManager::compareAlgorithmsPerformance() {
     vector<int> bestTour;
     double totalWeight = INT_MAX;
 
+    unique_ptr<AllocationScope> alloc(new AllocationScope());
     auto start = chrono::high_resolution_clock::now();
     tspBacktrackingMethod(bestTour, totalWeight);
     auto end = chrono::high_resolution_clock::now();
     chrono::duration<double> duration = end - start;
     cout << "Total weight: " << totalWeight << endl;
     cout << "Time taken by backtracking algorithm: " << to_string(duration.count()) << " seconds" << endl;
+    alloc->print("tspBacktracking");
     cout << "----------------//----------------" << endl;
 
     totalWeight = 0.0;
     bestTour = {};
+    alloc.reset(new AllocationScope());
     start = chrono::high_resolution_clock::now();
     tspTriangularHeuristicMethod(bestTour, 0);
     end = chrono::high_resolution_clock::now();
@@ -353,9 +343,11 @@ void TspManager::compareAlgorithmsPerformance() {
     totalWeight += graph.getEdgeWeight(bestTour.back(), bestTour[0]);
     cout << "Total weight: " << totalWeight << endl;
     cout << "Time taken by triangular heuristic algorithm: " << to_string(duration.count()) << " seconds" << endl;
+    alloc->print("tspTriangularHeuristic");
     cout << "----------------//----------------" << endl;
 
     totalWeight = 0;
+    alloc.reset(new AllocationScope());
     Graph<int> graphTemp = copyGraph(graph);
     vector<Edge<int> *> shortestPathEdges;
     start = chrono::high_resolution_clock::now();
@@ -371,9 +363,11 @@ void TspManager::compareAlgorithmsPerformance() {
     duration = end - start;
     cout << "Total weight: " << totalWeight << endl;
     cout << "Time taken by Prim's algorithm: " << to_string(duration.count()) << " seconds" << endl;
+    alloc->print("tspPrim");
 }
 
 Graph<int> TspManager::copyGraph(const Graph<int> &originalGraph) {
+    TraceSpan span("copyGraph");
     Graph<int> copiedGraph;
 
     for (auto v: originalGraph.getVertexSet()) {
@@ -389,7 +383,8 @@ Graph<int> TspManager::copyGraph(const Graph<int> &originalGraph) {
     return copiedGraph;
 }
 
-void TspManager::tspPrimMethod(const Graph<int> &graphTemp, Vertex<int> *startVertex, vector<Edge<int> *> &shortestPathEdges) {
+void TspManager::tspPrimMethod(const Graph<int> &graphTemp, Vertex<int> *startVertex, vector<Edge<int> *> &shortestPathEdges) const {
+    TraceSpan span("primMST");
     if (graphTemp.getNumVertex() == 0) return;
 
     unordered_set<Vertex<int> *> visitedVertices;
@@ -399,7 +394,8 @@ void TspManager::tspPrimMethod(const Graph<int> &graphTemp, Vertex<int> *startVe
         pq.push(edge);
     }
 
-    while (!pq.empty() && visitedVertices.size() < graphTemp.getNumVertex()) {
+    CancellationCheck stop(cancellation);
+    while (!pq.empty() && visitedVertices.size() < graphTemp.getNumVertex() && !stop.step()) {
         Edge<int> *minEdge = pq.top();
         pq.pop();
         Vertex<int> *destVertex = minEdge->getDest();
@@ -418,11 +414,16 @@ void TspManager::kruskalRealWorld(){
     cout << "Enter the starting node: ";
     cin >> source;
 
+    AllocationScope alloc;
     auto start = chrono::high_resolution_clock::now();
+    TraceSpan mstSpan("kruskalMST");
     auto res = graph.kruskalMST(source);
+    mstSpan.end();
     auto end = chrono::high_resolution_clock::now();
     chrono::duration<double> duration = end - start;
 
+    TraceSpan output("costAndOutput");
+
     double totalWeight = 0.0;
     cout << res[0].getOrig()->getInfo() << " ";
     for (auto i : res){
@@ -440,6 +441,7 @@ void TspManager::kruskalRealWorld(){
     cout << endl;
     cout << "Total weight: " << fixed << setprecision(2) << totalWeight << endl;
     cout << "Time taken by Kruskal's algorithm: " << to_string(duration.count()) << " seconds" << endl;
+    alloc.print("kruskalMST");
 }
 
 
@@ -456,11 +458,13 @@ void TspManager::tspTriangularHeuristicAlternativeInput() {
             cout << "Invalid starting node!" << endl;
             return;
         }
+        AllocationScope alloc;
         auto start = chrono::high_resolution_clock::now();
         triangularHeuristicAproximation(startNode, aproximationTour, aproximationTourCost);
         auto end = chrono::high_resolution_clock::now();
         chrono::duration<double> duration = end - start;
 
+        TraceSpan output("output");
         cout << "Best tour: ";
         for (auto & i : aproximationTour) {
             cout << i->getInfo() << " ";
@@ -469,6 +473,7 @@ void TspManager::tspTriangularHeuristicAlternativeInput() {
         cout << aproximationTour[0]->getInfo() << endl;
         cout << "Total distance: " << fixed << setprecision(2) << aproximationTourCost << endl;
         cout << "Time taken by the algorithm: " << to_string(duration.count()) << " seconds" << endl;
+        alloc.print("triangularHeuristicAproximation");
     }
 }
 
@@ -487,6 +492,7 @@ void TspManager::triangularHeuristicAproximation(const int startNodeId, std::vec
     for (auto v: graph.getVertexSet()) {
         v->setVisited(false);
     }
+    TraceSpan buildSpan("buildMstGraph");
     Graph<int> mstGraph;
     for (auto v: mst) {
         mstGraph.addVertex(v->getInfo());
@@ -499,26 +505,546 @@ void TspManager::triangularHeuristicAproximation(const int startNodeId, std::vec
             }
         }
     }
+    buildSpan.end();
+    TraceSpan dfsSpan("dfs");
     auto vector1 = mstGraph.dfs();
     for (auto s: vector1) {
         aproximationTour.push_back(graph.findVertex(s));
     }
     aproximationTour.push_back(startVertex);
+    dfsSpan.end();
 
-    aproximationTourCost = calculateTourCost(aproximationTour, graph);
+    aproximationTourCost = calculateTourCost(aproximationTour);
 }
 
-double TspManager::calculateTourCost(vector<Vertex<int> *> tour, Graph<int> &g) {
-    double totalCost = 0.0;
+double TspManager::calculateTourCost(const vector<Vertex<int> *> &tour) {
+    const DistanceMatrix &m = getEdgeMatrix();
+    TraceSpan span("tourCost");
+    vector<int> indices;
+    indices.reserve(tour.size());
+    for (Vertex<int> *v: tour) {
+        indices.push_back(m.findIndex(v->getInfo()));
+    }
+    return toDouble(TourEvaluator::tourCost(m, indices.data(), indices.size()));
+}
 
-    for (size_t i = 0; i < tour.size(); i++) {
-        if (i > 0) {
-            totalCost += getEdgeWeight(g, tour[i - 1]->getInfo(), tour[i]->getInfo());
+
+double TspManager::nearestNeighbourCost(const GraphSnapshot &snapshot) {
+    int n = snapshot.getNumVertex();
+    if (n == 0) return 0.0;
+    vector<bool> visited(n, false);
+    visited[0] = true;
+    int current = 0;
+    double cost = 0.0;
+    for (int step = 1; step < n; step++) {
+        double minDist = numeric_limits<double>::infinity();
+        int next = -1;
+        for (size_t e = snapshot.edgeBegin(current); e < snapshot.edgeEnd(current); e++) {
+            int w = snapshot.getTarget(e);
+            if (!visited[w] && snapshot.getWeight(e) < minDist) {
+                minDist = snapshot.getWeight(e);
+                next = w;
+            }
+        }
+        if (next == -1) return numeric_limits<double>::infinity();
+        visited[next] = true;
+        cost += minDist;
+        current = next;
+    }
+    return cost + snapshot.getEdgeWeight(current, 0);
+}
+
+void TspManager::liveUpdateSimulation(double seconds) {
+    if (graph.getNumVertex() < 2) {
+        cout << "Graph is empty" << endl;
+        return;
+    }
+
+    TraceSpan snapshotSpan("buildSnapshot");
+    VersionedGraph live(GraphSnapshot::fromGraph(graph));
+    snapshotSpan.end();
+    int numReaders = (int) max(1u, min(4u, thread::hardware_concurrency()));
+    atomic<bool> stop(false);
+    atomic<long> queries(0);
+    mutex seenMutex;
+    set<unsigned long> versionsSeen;
+
+    vector<thread> readers;
+    for (int r = 0; r < numReaders; r++) {
+        readers.emplace_back([&]() {
+            set<unsigned long> seen;
+            while (!stop.load()) {
+                TraceSpan span("liveQuery");
+                auto snapshot = live.pin();
+                nearestNeighbourCost(*snapshot);
+                seen.insert(snapshot->getVersion());
+                queries++;
+            }
+            lock_guard<mutex> lock(seenMutex);
+            versionsSeen.insert(seen.begin(), seen.end());
+        });
+    }
+
+    mt19937 rng(42);
+    vector<Vertex<int> *> vertices = graph.getVertexSet();
+    uniform_int_distribution<size_t> pickVertex(0, vertices.size() - 1);
+    uniform_real_distribution<double> scale(0.5, 1.5);
+    unsigned long published = 0;
+
+    auto start = chrono::high_resolution_clock::now();
+    chrono::duration<double> elapsed(0);
+    while (elapsed.count() < seconds) {
+        GraphDelta delta;
+        {
+            auto pinned = live.pin();
+            for (int k = 0; k < 16; k++) {
+                int u = pinned->findIndex(vertices[pickVertex(rng)]->getInfo());
+                if (pinned->edgeBegin(u) == pinned->edgeEnd(u)) continue;
+                size_t e = pinned->edgeBegin(u) + pickVertex(rng) % (pinned->edgeEnd(u) - pinned->edgeBegin(u));
+                delta.setBidirectionalWeight(pinned->getId(u), pinned->getId(pinned->getTarget(e)),
+                                             pinned->getWeight(e) * scale(rng));
+            }
+        }
+        TraceSpan span("publish");
+        published = live.publish(delta);
+        span.end();
+        this_thread::sleep_for(chrono::milliseconds(10));
+        elapsed = chrono::high_resolution_clock::now() - start;
+    }
+    stop = true;
+    for (auto &t: readers) {
+        t.join();
+    }
+    live.reclaim();
+
+    cout << "Reader threads: " << numReaders << endl;
+    cout << "Queries answered: " << queries.load() << " (" << fixed << setprecision(1)
+         << queries.load() / elapsed.count() << " per second)" << endl;
+    cout << "Versions published: " << published << endl;
+    cout << "Distinct versions seen by readers: " << versionsSeen.size() << endl;
+    cout << "Snapshots still retired: " << live.getNumRetired() << endl;
+}
+
+int TspManager::getNumVertex() const {
+    return graph.getNumVertex();
+}
+
+double TspManager::nearestNeighbourTour(int startNode, vector<int> &tour) {
+    tour.clear();
+    if (graph.getNumVertex() == 0) return 0.0;
+    tspTriangularHeuristicMethod(tour, startNode);
+    double cost = 0.0;
+    for (size_t i = 1; i < tour.size(); i++) {
+        cost += graph.getEdgeWeight(tour[i - 1], tour[i]);
+    }
+    cost += graph.getEdgeWeight(tour.back(), tour[0]);
+    tour.push_back(tour[0]);
+    return cost;
+}
+
+double TspManager::mstApproximationTour(int startNode, vector<int> &tour) {
+    tour.clear();
+    vector<Vertex<int> *> aproximationTour;
+    double cost = 0.0;
+    triangularHeuristicAproximation(startNode, aproximationTour, cost);
+    for (auto v: aproximationTour) {
+        tour.push_back(v->getInfo());
+    }
+    return cost;
+}
+
+double TspManager::backtrackingTour(vector<int> &tour) {
+    tour.clear();
+    double cost = INT_MAX;
+    if (graph.getNumVertex() == 0) return 0.0;
+    tspBacktrackingMethod(tour, cost);
+    return cost;
+}
+
+double TspManager::primMstWeight() {
+    double total = 0.0;
+    for (auto v: primMPQ(&graph)) {
+        if (v->getPath() != nullptr) total += v->getPath()->getWeight();
+    }
+    return total;
+}
+
+double TspManager::kruskalMstWeight(int source) {
+    double total = 0.0;
+    for (const auto &e: graph.kruskalMST(source)) {
+        total += e.getWeight();
+    }
+    return total;
+}
+
+double TspManager::shortestPathDistance(int source, int dest) {
+    if (!graph.dijkstra(source)) return numeric_limits<double>::infinity();
+    Vertex<int> *v = graph.findVertex(dest);
+    return v == nullptr ? numeric_limits<double>::infinity() : v->getDist();
+}
+
+InstanceFeatures TspManager::getInstanceFeatures(unsigned seed) const {
+    InstanceFeatures features;
+    vector<Vertex<int> *> vertices = graph.getVertexSet();
+    int n = (int) vertices.size();
+    features.n = n;
+    if (n == 0) return features;
+
+    unordered_map<int, int> index;
+    for (int i = 0; i < n; i++) {
+        index[vertices[i]->getInfo()] = i;
+    }
+    vector<int> stamp(n, -1);
+    long long distinct = 0;
+    features.complete = true;
+    for (int i = 0; i < n; i++) {
+        int degree = 0;
+        for (auto e: vertices[i]->getAdj()) {
+            features.edges++;
+            int j = index[e->getDest()->getInfo()];
+            if (j != i && stamp[j] != i) {
+                stamp[j] = i;
+                degree++;
+            }
+        }
+        distinct += degree;
+        if (degree != n - 1) features.complete = false;
+    }
+    features.density = n > 1 ? (double) distinct / ((double) n * (n - 1)) : 0.0;
+
+    features.hasCoordinates = true;
+    for (auto v: vertices) {
+        if (nodesloc.find(v->getInfo()) == nodesloc.end()) {
+            features.hasCoordinates = false;
+            break;
+        }
+    }
+
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pickVertex(0, n - 1);
+    int violations = 0;
+    for (int attempt = 0; attempt < 20000 && features.sampledTriangles < 2000; attempt++) {
+        vector<Edge<int> *> adj = vertices[pickVertex(rng)]->getAdj();
+        if (adj.size() < 2) continue;
+        uniform_int_distribution<size_t> pickEdge(0, adj.size() - 1);
+        Edge<int> *first = adj[pickEdge(rng)];
+        Edge<int> *second = adj[pickEdge(rng)];
+        int i = first->getDest()->getInfo(), k = second->getDest()->getInfo();
+        if (i == k) continue;
+        double direct = graph.getEdgeWeight(i, k);
+        if (direct == numeric_limits<double>::max()) continue;
+        features.sampledTriangles++;
+        if (direct > first->getWeight() + second->getWeight() + 1e-6) violations++;
+    }
+    if (features.sampledTriangles > 0) {
+        features.metricViolationRate = (double) violations / features.sampledTriangles;
+    }
+    return features;
+}
+
+double TspManager::coordinateDistance(int u, int v) const {
+    auto a = nodesloc.find(u), b = nodesloc.find(v);
+    if (a == nodesloc.end() || b == nodesloc.end()) return numeric_limits<double>::infinity();
+    // nodes are stored as (longitude, latitude)
+    return 1000.0 * haversineDistance(a->second.second, a->second.first, b->second.second, b->second.first);
+}
+
+double TspManager::edgeWeightOrDistance(int u, int v) const {
+    double w = graph.getEdgeWeight(u, v);
+    if (w != numeric_limits<double>::max()) return w;
+    return coordinateDistance(u, v);
+}
+
+const DistanceMatrix &TspManager::getDistanceMatrix() {
+    if (!matrix) {
+        TraceSpan span("buildDistanceMatrix");
+        matrix = make_shared<DistanceMatrix>(DistanceMatrix::fromGraph(graph));
+        int n = matrix->size();
+        DistanceMatrix &filled = *matrix;
+        ThreadPool::shared().parallelFor(0, (size_t) n, 16, [&](size_t first, size_t last) {
+            for (int i = (int) first; i < (int) last; i++) {
+                for (int j = 0; j < n; j++) {
+                    if (i != j && filled.at(i, j) == MISSING_WEIGHT) {
+                        filled.set(i, j, toWeight(coordinateDistance(filled.getId(i), filled.getId(j))));
+                    }
+                }
+            }
+        });
+    }
+    return *matrix;
+}
+
+const DistanceMatrix &TspManager::getEdgeMatrix() {
+    if (!edgeMatrix) {
+        TraceSpan span("buildEdgeMatrix");
+        edgeMatrix = make_shared<DistanceMatrix>(DistanceMatrix::fromGraph(graph));
+    }
+    return *edgeMatrix;
+}
+
+void TspManager::toNodeTour(const DistanceMatrix &m, const vector<int> &indices, vector<int> &tour) {
+    tour.clear();
+    for (int i: indices) {
+        tour.push_back(m.getId(i));
+    }
+    if (!tour.empty()) tour.push_back(tour.front());
+}
+
+double TspManager::heldKarpTour(vector<int> &tour) {
+    const DistanceMatrix &m = getEdgeMatrix();
+    TraceSpan span("heldKarp");
+    vector<int> indices;
+    Cost cost = ExactSolver::heldKarp(m, indices, checkpoint, cancellation);
+    if (indices.empty() && wasCancelled() && m.size() > 0) {
+        indices = LocalSearch::nearestNeighbour(m, 0);
+        cost = m.tourCost(indices);
+    }
+    toNodeTour(m, indices, tour);
+    return toDouble(cost);
+}
+
+double TspManager::localSearchTour(int startNode, vector<int> &tour) {
+    const DistanceMatrix &m = getDistanceMatrix();
+    int start = m.findIndex(startNode);
+    if (start == -1) start = 0;
+    TraceSpan span("localSearch");
+    vector<int> indices = LocalSearch::solve(m, start, Autotuner::getConfig(m.size()), 42, cancellation);
+    span.end();
+    toNodeTour(m, indices, tour);
+    return toDouble(m.tourCost(indices));
+}
+
+double TspManager::precedenceTour(int startNode, const vector<pair<int, int>> &pairs, vector<int> &tour) {
+    tour.clear();
+    const DistanceMatrix &m = getDistanceMatrix();
+    int start = m.findIndex(startNode);
+    vector<pair<int, int>> indices;
+    for (const auto &p: pairs) {
+        indices.emplace_back(m.findIndex(p.first), m.findIndex(p.second));
+    }
+    PrecedenceConstraints constraints;
+    if (start == -1 || !constraints.build(m.size(), indices)) return numeric_limits<double>::infinity();
+    TraceSpan span("precedenceSearch");
+    vector<int> order = PrecedenceSearch::solve(m, start, constraints, Autotuner::getConfig(m.size()).candidates,
+                                                cancellation);
+    span.end();
+    if (order.empty()) return numeric_limits<double>::infinity();
+    toNodeTour(m, order, tour);
+    return toDouble(m.tourCost(order));
+}
+
+double TspManager::mergeTours(const vector<vector<int>> &tours, vector<int> &tour, TourMergeReport *report) {
+    tour.clear();
+    const DistanceMatrix &m = getDistanceMatrix();
+    vector<vector<int>> inputs;
+    for (const auto &t: tours) {
+        vector<int> indices;
+        for (size_t i = 0; i < t.size(); i++) {
+            if (i + 1 == t.size() && t.size() > 1 && t[i] == t[0]) break;
+            indices.push_back(m.findIndex(t[i]));
+        }
+        inputs.push_back(indices);
+    }
+    TraceSpan span("tourMerge");
+    vector<int> merged = TourMerge::merge(m, inputs, TourMerge::DEFAULT_MAX_STATES, report, cancellation);
+    span.end();
+    if (merged.empty()) return numeric_limits<double>::infinity();
+    toNodeTour(m, merged, tour);
+    return toDouble(m.tourCost(merged));
+}
+
+double TspManager::mergeStage(vector<int> &tour, double seconds, TourMergeReport *report) {
+    const DistanceMatrix &m = getDistanceMatrix();
+    auto priced = [&](const vector<int> &t) {
+        vector<int> indices;
+        for (size_t i = 0; i + 1 < t.size(); i++) {
+            indices.push_back(m.findIndex(t[i]));
         }
+        return toDouble(m.tourCost(indices));
+    };
+    double cost = priced(tour);
+    if (tour.size() < 5) return cost;
+
+    // the stage has its own deadline, and still stops on the token of the caller
+    CancellationToken stage;
+    stage.setParent(cancellation);
+    stage.setDeadline(seconds);
+    const CancellationToken *caller = cancellation;
+    cancellation = &stage;
+
+    // a few runs are enough: more tours widen the union graph faster than they add good edges
+    const int runs = 3;
+    const auto &vertices = graph.getVertexSet();
+    vector<vector<int>> tours = {tour};
+    vector<int> other;
+    for (int k = 1; k <= runs && !stage.isCancelled(); k++) {
+        localSearchTour(vertices[(size_t) k * vertices.size() / (runs + 1)]->getInfo(), other);
+        tours.push_back(other);
     }
+    vector<int> merged;
+    double mergedCost = stage.isCancelled() ? cost : mergeTours(tours, merged, report);
+    cancellation = caller;
 
-    totalCost += getEdgeWeight(g, tour.back()->getInfo(), tour[0]->getInfo());
+    if (!merged.empty() && mergedCost < cost) {
+        tour = merged;
+        cost = mergedCost;
+    }
+    return cost;
+}
+
+void TspManager::tspTourMerging(double seconds) {
+    if (graph.getVertexSet().empty()) {
+        cout << "Graph is empty" << endl;
+        return;
+    }
+    vector<int> tour;
+    double before = localSearchTour(graph.getVertexSet()[0]->getInfo(), tour);
+    TourMergeReport report;
+    auto start = chrono::high_resolution_clock::now();
+    double cost = mergeStage(tour, seconds, &report);
+    chrono::duration<double> duration = chrono::high_resolution_clock::now() - start;
+
+    cout << "Best tour: ";
+    for (int i: tour) {
+        cout << i << " ";
+    }
+    cout << endl << fixed << setprecision(2) << "Total weight: " << cost << " (local search alone: " << before
+         << ")" << endl;
+    cout << "Union graph: " << report.unionEdges << " edges over " << report.inputTours << " tours" << endl;
+    cout << "Time taken by merge stage: " << to_string(duration.count()) << " seconds" << endl;
+}
 
-    return totalCost;
+double TspManager::backboneTour(int runs, vector<int> &tour, BackboneReport *report) {
+    tour.clear();
+    const DistanceMatrix &m = getDistanceMatrix();
+    LocalSearchConfig config = Autotuner::getConfig(m.size());
+    config.kicks = max(config.kicks, 10 * m.size());
+    TraceSpan span("backbone");
+    vector<int> indices = Backbone::solve(m, runs, config, 42, report, cancellation);
+    span.end();
+    toNodeTour(m, indices, tour);
+    return toDouble(m.tourCost(indices));
 }
 
+double TspManager::guidedLocalSearchTour(int startNode, double seconds, vector<int> &tour,
+                                         GuidedLocalSearchReport *report) {
+    tour.clear();
+    const DistanceMatrix &m = getDistanceMatrix();
+    int start = m.findIndex(startNode);
+    if (start == -1) start = 0;
+    GuidedLocalSearchConfig config;
+    config.candidates = Autotuner::getConfig(m.size()).candidates;
+    config.seconds = seconds;
+    TraceSpan span("guidedLocalSearch");
+    vector<int> indices = GuidedLocalSearch::solve(m, start, config, cancellation, report);
+    span.end();
+    toNodeTour(m, indices, tour);
+    return toDouble(m.tourCost(indices));
+}
+
+double TspManager::tabuSearchTour(int startNode, double seconds, vector<int> &tour, TabuSearchReport *report) {
+    tour.clear();
+    const DistanceMatrix &m = getDistanceMatrix();
+    int start = m.findIndex(startNode);
+    if (start == -1) start = 0;
+    TabuSearchConfig config;
+    config.seconds = seconds;
+    TraceSpan span("tabuSearch");
+    vector<int> indices = TabuSearch::solve(m, start, config, cancellation, report);
+    span.end();
+    toNodeTour(m, indices, tour);
+    return toDouble(m.tourCost(indices));
+}
+
+void TspManager::setCheckpoint(const CheckpointOptions &options) {
+    checkpoint = options;
+}
+
+void TspManager::setCancellation(const CancellationToken *token) {
+    cancellation = token;
+}
+
+bool TspManager::wasCancelled() const {
+    return cancellation != nullptr && cancellation->isCancelled();
+}
+
+double TspManager::runPipeline(Pipeline pipeline, vector<int> &tour) {
+    tour.clear();
+    if (graph.getNumVertex() == 0) return 0.0;
+    switch (pipeline) {
+        case Pipeline::ExactDP:
+            return heldKarpTour(tour);
+        case Pipeline::BranchAndBound:
+            return backtrackingTour(tour);
+        case Pipeline::LocalSearch:
+            return localSearchTour(graph.getVertexSet()[0]->getInfo(), tour);
+        case Pipeline::MstApproximation: {
+            mstApproximationTour(graph.getVertexSet()[0]->getInfo(), tour);
+            // the preorder walk may use pairs without an edge, which are priced by distance
+            double cost = 0.0;
+            for (size_t i = 1; i < tour.size(); i++) {
+                cost += edgeWeightOrDistance(tour[i - 1], tour[i]);
+            }
+            return cost;
+        }
+    }
+    return 0.0;
+}
+
+void TspManager::automaticSelection(double budgetSeconds) {
+    if (graph.getVertexSet().empty()) {
+        cout << "Graph is empty" << endl;
+        return;
+    }
+    AlgorithmSelector selector;
+    if (selector.loadCalibration("calibration.csv")) {
+        cout << "Using calibration.csv" << endl;
+    }
+    InstanceFeatures features = getInstanceFeatures();
+    selector.printPredictions(features, budgetSeconds);
+    Pipeline pipeline = selector.select(features, budgetSeconds);
+    cout << "Selected pipeline: " << AlgorithmSelector::getName(pipeline) << endl;
+
+    vector<int> tour;
+    auto start = chrono::high_resolution_clock::now();
+    double cost = runPipeline(pipeline, tour);
+    auto end = chrono::high_resolution_clock::now();
+    chrono::duration<double> duration = end - start;
+
+    // the heuristic pipelines are followed by the merge stage when they leave enough of the budget
+    bool heuristic = pipeline == Pipeline::LocalSearch || pipeline == Pipeline::MstApproximation;
+    if (heuristic && (features.complete || features.hasCoordinates) && duration.count() < budgetSeconds / 2) {
+        double before = cost;
+        cost = mergeStage(tour, budgetSeconds - duration.count());
+        duration = chrono::high_resolution_clock::now() - start;
+        cout << "Merge stage: " << fixed << setprecision(2) << before << " -> " << cost << endl;
+    }
+
+    cout << "Best tour: ";
+    for (int i: tour) {
+        cout << i << " ";
+    }
+    cout << endl << "Total weight: " << fixed << setprecision(2) << cost << endl;
+    cout << "Time taken by algorithm: " << to_string(duration.count()) << " seconds" << endl;
+}
+
+void TspManager::tspTabuSearch(double seconds) {
+    if (graph.getVertexSet().empty()) {
+        cout << "Graph is empty" << endl;
+        return;
+    }
+    vector<int> tour;
+    TabuSearchReport report;
+    double cost = tabuSearchTour(graph.getVertexSet()[0]->getInfo(), seconds, tour, &report);
+
+    cout << "Best tour: ";
+    for (int i: tour) {
+        cout << i << " ";
+    }
+    cout << endl << "Total weight: " << fixed << setprecision(2) << cost << endl;
+    cout << "Start tour (2-opt): " << toDouble(report.initialCost) << endl;
+    cout << "Iterations: " << report.iterations << " (" << setprecision(0) << report.iterationsPerSecond
+         << " per second), " << report.twoOptMoves << " 2-opt and " << report.swapMoves << " swap moves" << endl;
+    cout << "Aspirations: " << report.aspirations << ", diversifications: " << report.diversifications << endl;
+    cout << "Time taken by algorithm: " << to_string(report.seconds) << " seconds" << endl;
+}
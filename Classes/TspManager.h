@@ -12,6 +12,20 @@
 #include <chrono>
 #include <unordered_set>
 #include "MutablePriorityQueue.h"
+#include "VersionedGraph.h"
+#include "AllocationTracker.h"
+#include "Trace.h"
+#include "DistanceMatrix.h"
+#include "LocalSearch.h"
+#include "ExactSolver.h"
+#include "AlgorithmSelector.h"
+#include "Precedence.h"
+#include "TourMerge.h"
+#include "Backbone.h"
+#include "Cancellation.h"
+#include "GuidedLocalSearch.h"
+#include "TabuSearch.h"
+#include <memory>
 
 class TspManager {
 public:
@@ -71,39 +85,256 @@ public:
      */
     void tspTriangularHeuristicAlternativeInput();
 
+    /**
+     * @brief Runs nearest neighbour queries on the graph while its edge weights are being updated
+     * @details Reader threads pin a version of the graph for each query while a writer publishes random
+     * weight changes, and the number of queries, published versions and reclaimed snapshots is reported.
+     * Time complexity: O(Q * V^2logV), where Q is the number of queries answered
+     * @param seconds Duration of the simulation
+     */
+    void liveUpdateSimulation(double seconds);
+
+    /**
+     * @brief Gets the number of vertices of the loaded graph
+     * @details Time complexity: O(1)
+     * @return Number of vertices
+     */
+    int getNumVertex() const;
+
+    /**
+     * @brief Builds the nearest neighbour tour without printing it
+     * @details Time complexity: O(V^2), where V is the number of vertices in the graph
+     * @param startNode Integer representing the start node
+     * @param tour Vector to store the tour
+     * @return The cost of the tour, including the edge back to the start
+     */
+    double nearestNeighbourTour(int startNode, std::vector<int> &tour);
+
+    /**
+     * @brief Builds the MST preorder (triangular approximation) tour without printing it
+     * @details Time complexity: O(ElogV), where E is the number of edges and V is the number of vertices in the graph
+     * @param startNode Integer representing the start node
+     * @param tour Vector to store the tour
+     * @return The cost of the tour
+     */
+    double mstApproximationTour(int startNode, std::vector<int> &tour);
+
+    /**
+     * @brief Finds the optimal tour by backtracking without printing it
+     * @details Time complexity: O(n!), where n is the number of vertices in the graph
+     * @param tour Vector to store the tour
+     * @return The cost of the tour
+     */
+    double backtrackingTour(std::vector<int> &tour);
+
+    /**
+     * @brief Computes the weight of the minimum spanning tree with Prim's algorithm
+     * @details Time complexity: O(ElogV), where E is the number of edges and V is the number of vertices in the graph
+     * @return Total weight of the tree
+     */
+    double primMstWeight();
+
+    /**
+     * @brief Computes the weight of the minimum spanning tree with Kruskal's algorithm
+     * @details Time complexity: O(ElogE), where E is the number of edges in the graph
+     * @param source Integer representing the source node
+     * @return Total weight of the tree
+     */
+    double kruskalMstWeight(int source);
+
+    /**
+     * @brief Computes the length of the shortest path between two nodes with Dijkstra's algorithm
+     * @details Time complexity: O((V+E)logV), where E is the number of edges and V is the number of vertices in the graph
+     * @param source Integer representing the source node
+     * @param dest Integer representing the destination node
+     * @return The length of the path, or infinity if there is none
+     */
+    double shortestPathDistance(int source, int dest);
+
+    /**
+     * @brief Gets the features of the loaded instance (size, density, completeness, metricity, coordinates)
+     * @details Metricity is estimated by sampling triangles. Time complexity: O(V + E)
+     * @param seed Seed for the triangle sampling
+     * @return The features
+     */
+    InstanceFeatures getInstanceFeatures(unsigned seed = 42) const;
+
+    /**
+     * @brief Gets the distance matrix of the graph, built on first use
+     * @details Missing edges are replaced by the haversine distance between the nodes when their coordinates
+     * are known. Time complexity: O(V^2 + E) the first time, O(1) afterwards
+     * @return The distance matrix
+     */
+    const DistanceMatrix &getDistanceMatrix();
+
+    /**
+     * @brief Gets the weights of the edges of the graph only, built on first use
+     * @details Unlike getDistanceMatrix(), missing edges stay MISSING_WEIGHT, so the exact solvers and the
+     * pricing of given tours never use a pair the graph does not connect. Time complexity: O(V^2 + E) the first
+     * time, O(1) afterwards
+     * @return The edge matrix
+     */
+    const DistanceMatrix &getEdgeMatrix();
+
+    /**
+     * @brief Finds the optimal tour with Held-Karp dynamic programming
+     * @details Time complexity: O(2^V * V^2), where V is the number of vertices in the graph
+     * @param tour Vector to store the tour
+     * @return The cost of the tour
+     */
+    double heldKarpTour(std::vector<int> &tour);
+
+    /**
+     * @brief Builds a nearest neighbour tour on the distance matrix and improves it with 2-opt
+     * @details Time complexity: O(V^2) for the construction and candidate lists, plus the local search
+     * @param startNode Integer representing the start node
+     * @param tour Vector to store the tour
+     * @return The cost of the tour
+     */
+    double localSearchTour(int startNode, std::vector<int> &tour);
+
+    /**
+     * @brief Builds a tour that visits each pickup before its delivery and improves it without breaking a pair
+     * @details The pairs are checked for cycles with a topological sort. Time complexity: O(V^2 + P) for the
+     * construction, plus the local search, where P is the number of pairs
+     * @param startNode Integer representing the start node, which must not be a delivery
+     * @param pairs Pairs of node ids, the pickup first
+     * @param tour Vector to store the tour, ending at the start
+     * @return The cost of the tour, or infinity if a node is unknown or no tour respects the pairs
+     */
+    double precedenceTour(int startNode, const std::vector<std::pair<int, int>> &pairs, std::vector<int> &tour);
+
+    /**
+     * @brief Finds the best tour that only uses edges of some tours built by the other heuristics
+     * @details Can follow any of the tour methods above, whose closed tours of node ids it takes as they are.
+     * Time complexity: see TourMerge::merge()
+     * @param tours Tours of node ids, ending at their start
+     * @param tour Vector to store the merged tour, ending at its start
+     * @param report Report to fill in, if not null
+     * @return The cost of the tour, or infinity if no input tour visits every node once
+     */
+    double mergeTours(const std::vector<std::vector<int>> &tours, std::vector<int> &tour,
+                      TourMergeReport *report = nullptr);
+
+    /**
+     * @brief Improves the tour of a heuristic by merging it with local search tours from spread-out starts
+     * @details The local search runs and the merge share the time budget and stop on the cancellation token, so
+     * the stage can follow any tour method. Time complexity: bounded by the budget
+     * @param tour Closed tour of node ids, replaced by the merged tour when that is shorter
+     * @param seconds Time budget of the stage
+     * @param report Report of the merge to fill in, if not null
+     * @return The cost of the resulting tour
+     */
+    double mergeStage(std::vector<int> &tour, double seconds, TourMergeReport *report = nullptr);
+
+    /**
+     * @brief Fixes the edges common to good local search tours and solves the rest exactly, see Backbone
+     * @details Each run is iterated local search with at least 10 kicks per vertex, since only tours close to the
+     * optimum agree on enough edges. Time complexity: O(R * (V^2 + K * k * m)) for the runs plus O(2^s * s^2),
+     * where R is the number of runs and s the number of super-nodes
+     * @param runs Number of local search runs
+     * @param tour Vector to store the tour, ending at its start
+     * @param report Report to fill in, if not null
+     * @return The cost of the tour
+     */
+    double backboneTour(int runs, std::vector<int> &tour, BackboneReport *report = nullptr);
+
+    /**
+     * @brief Improves the nearest neighbour tour with guided local search for a fixed time, see GuidedLocalSearch
+     * @details Stops early when the cancellation token fires. Time complexity: O(V^2logk) for the start, then
+     * bounded by the budget
+     * @param startNode Integer representing the start node
+     * @param seconds Time budget
+     * @param tour Vector to store the tour, ending at its start
+     * @param report Report to fill in, if not null
+     * @return The cost of the tour
+     */
+    double guidedLocalSearchTour(int startNode, double seconds, std::vector<int> &tour,
+                                 GuidedLocalSearchReport *report = nullptr);
+
+    /**
+     * @brief Improves the nearest neighbour tour with tabu search for a fixed time, see TabuSearch
+     * @details Stops early when the cancellation token fires. Time complexity: O(V^2logk) for the start, then
+     * bounded by the budget
+     * @param startNode Integer representing the start node
+     * @param seconds Time budget
+     * @param tour Vector to store the tour, ending at its start
+     * @param report Report to fill in, if not null
+     * @return The cost of the tour
+     */
+    double tabuSearchTour(int startNode, double seconds, std::vector<int> &tour, TabuSearchReport *report = nullptr);
+
+    /**
+     * @brief Makes the exact pipelines save their progress to a checkpoint file and resume from it
+     * @details Time complexity: O(1)
+     * @param options Checkpoint file and interval, an empty filename disables checkpoints
+     */
+    void setCheckpoint(const CheckpointOptions &options);
+
+    /**
+     * @brief Makes the solvers stop early when a token fires, keeping the best tour found until then
+     * @details Backtracking, Held-Karp, local search, the nearest neighbour heuristic and Prim's algorithm poll
+     * the token. An exact search cancelled before it found a tour falls back to the nearest neighbour tour, and a
+     * heuristic appends the vertices it did not reach, so a tour is always returned. Time complexity: O(1)
+     * @param token Token, which must outlive its use by this manager, or null to never stop early
+     */
+    void setCancellation(const CancellationToken *token);
+
+    /**
+     * @brief Checks if the token given to setCancellation() has fired
+     * @details Time complexity: O(1)
+     * @return True if the last results may be incomplete
+     */
+    bool wasCancelled() const;
+
+    /**
+     * @brief Runs a solver pipeline without printing
+     * @details Time complexity: that of the pipeline
+     * @param pipeline Pipeline to run
+     * @param tour Vector to store the tour, ending at its start
+     * @return The cost of the tour
+     */
+    double runPipeline(Pipeline pipeline, std::vector<int> &tour);
+
+    /**
+     * @brief Picks the pipeline expected to give the best tour within a latency budget, runs it and prints the result
+     * @details Uses calibration.csv from the working directory when present. Time complexity: that of the chosen pipeline
+     * @param budgetSeconds Latency budget in seconds
+     */
+    void automaticSelection(double budgetSeconds);
+
+    /**
+     * @brief Runs tabu search from the first vertex for a fixed time and prints the tour and the search statistics
+     * @details Time complexity: O(V^2logk) for the start, then bounded by the budget
+     * @param seconds Time budget
+     */
+    void tspTabuSearch(double seconds);
+
+    /**
+     * @brief Runs local search from the first vertex, follows it with the merge stage and prints both tours
+     * @details Time complexity: that of the local search, then bounded by the budget
+     * @param seconds Time budget of the merge stage
+     */
+    void tspTourMerging(double seconds);
+
 private:
     Graph<int> graph;
     std::unordered_map<int, std::pair<float, float>> nodesloc;
     std::unordered_map<int, std::string> labels;
+    std::shared_ptr<DistanceMatrix> matrix;
+    std::shared_ptr<DistanceMatrix> edgeMatrix;
+    CheckpointOptions checkpoint;
+    const CancellationToken *cancellation = nullptr;
 
     /**
      * @brief Executes the backtracking method for the TSP problem
-     * @details Time complexity: O(n!), where n is the number of vertices in the graph
+     * @details Branch and bound over the distance matrix, starting at vertex 0 and saving checkpoints when
+     * enabled. Time complexity: O(n!), where n is the number of vertices in the graph
      * @param bestTour Vector to store the best tour
      * @param minTourCost Double to store the minimum tour cost
      */
     void tspBacktrackingMethod(std::vector<int> &bestTour, double &minTourCost);
 
-    /**
-     * @brief Recursive function for the TSP problem
-     * @details Time complexity: O(n!), where n is the number of vertices in the graph
-     * @param tour Vector to store the current tour
-     * @param visited Vector to store the visited nodes
-     * @param currentCost Double to store the current cost
-     * @param minCost Double to store the minimum cost
-     * @param bestTour Vector to store the best tour
-     */
-    void tspRec(std::vector<int> &tour, std::vector<bool> &visited, double currentCost, double &minCost, std::vector<int> &bestTour);
-
-    /**
-     * @brief Checks if an edge exists between two vertices
-     * @details Time complexity: O(E), where E is the number of edges in the graph
-     * @param pVertex Pointer to the first vertex
-     * @param pVertex1 Pointer to the second vertex
-     * @return True if an edge exists, false otherwise
-     */
-    static bool hasEdge(Vertex<int> *pVertex, Vertex<int> *pVertex1);
-
     /**
      * @brief Gets the weight of an edge in the graph
      * @details Time complexity: O(E), where E is the number of edges in the graph
@@ -162,7 +393,7 @@ private:
      * @param g Pointer to the graph
      * @return Vector of pointers to the vertices
      */
-    static std::vector<Vertex<int> *> primMPQ(Graph<int> *g);
+    std::vector<Vertex<int> *> primMPQ(Graph<int> *g) const;
 
     /**
      * @brief Copies a graph
@@ -179,7 +410,7 @@ private:
      * @param startVertex Pointer to the start vertex
      * @param shortestPathEdges Vector to store the shortest path edges
      */
-    static void tspPrimMethod(const Graph<int> &graphTemp, Vertex<int> *startVertex, std::vector<Edge<int> *> &shortestPathEdges);
+    void tspPrimMethod(const Graph<int> &graphTemp, Vertex<int> *startVertex, std::vector<Edge<int> *> &shortestPathEdges) const;
 
     /**
      * @brief Executes the triangular heuristic approximation for the TSP problem
@@ -192,12 +423,47 @@ private:
 
     /**
      * @brief Calculates the tour cost
-     * @details Time complexity: O(V), where V is the number of vertices in the graph
+     * @details Priced on the edges of the graph only. Time complexity: O(V), where V is the number of vertices in
+     * the graph, once the edge matrix is built
      * @param tour Vector representing the tour
-     * @param g Reference to the graph
-     * @return The cost of the tour
+     * @return The cost of the tour, or infinity if it uses a pair of vertices without an edge
+     */
+    double calculateTourCost(const std::vector<Vertex<int> *> &tour);
+
+    /**
+     * @brief Calculates the cost of the nearest neighbour tour of a snapshot, starting at its first vertex
+     * @details Time complexity: O(V^2logV), where V is the number of vertices in the snapshot
+     * @param snapshot Snapshot of the graph
+     * @return The cost of the tour, or infinity if the tour gets stuck
+     */
+    static double nearestNeighbourCost(const GraphSnapshot &snapshot);
+
+    /**
+     * @brief Gets the weight of an edge, or the distance between its nodes when the edge does not exist
+     * @details Time complexity: O(E), where E is the number of edges in the graph
+     * @param u Integer representing the first node
+     * @param v Integer representing the second node
+     * @return The weight in meters, or infinity if there is no edge and no coordinates
+     */
+    double edgeWeightOrDistance(int u, int v) const;
+
+    /**
+     * @brief Gets the haversine distance between two nodes from their coordinates
+     * @details Time complexity: O(1)
+     * @param u Integer representing the first node
+     * @param v Integer representing the second node
+     * @return The distance in meters, or infinity if the coordinates are unknown
+     */
+    double coordinateDistance(int u, int v) const;
+
+    /**
+     * @brief Converts a tour of matrix indices into a closed tour of node ids
+     * @details Time complexity: O(V)
+     * @param m Matrix the indices refer to
+     * @param indices Tour of matrix indices
+     * @param tour Vector to store the node ids, ending at the start
      */
-    static double calculateTourCost(std::vector<Vertex<int> *> tour, Graph<int> &g);
+    void toNodeTour(const DistanceMatrix &m, const std::vector<int> &indices, std::vector<int> &tour);
 
 };
 
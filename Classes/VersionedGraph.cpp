@@ -0,0 +1,101 @@
+#include "VersionedGraph.h"
+#include <thread>
+
+using namespace std;
+
+const int VersionedGraph::MAX_READERS;
+const unsigned long VersionedGraph::IDLE;
+
+VersionedGraph::ReadGuard::ReadGuard(const VersionedGraph *owner, int slot, const GraphSnapshot *snapshot)
+        : owner(owner), slot(slot), snapshot(snapshot) {}
+
+VersionedGraph::ReadGuard::ReadGuard(ReadGuard &&other) noexcept
+        : owner(other.owner), slot(other.slot), snapshot(other.snapshot) {
+    other.owner = nullptr;
+}
+
+VersionedGraph::ReadGuard::~ReadGuard() {
+    if (owner != nullptr) owner->unpin(slot);
+}
+
+const GraphSnapshot &VersionedGraph::ReadGuard::operator*() const {
+    return *snapshot;
+}
+
+const GraphSnapshot *VersionedGraph::ReadGuard::operator->() const {
+    return snapshot;
+}
+
+VersionedGraph::VersionedGraph(GraphSnapshot initial) : current(new GraphSnapshot(move(initial))), globalEpoch(0) {
+    for (auto &reader: readers) {
+        reader.epoch.store(IDLE);
+    }
+}
+
+VersionedGraph::~VersionedGraph() {
+    delete current.load();
+    for (auto &r: retired) {
+        delete r.second;
+    }
+}
+
+VersionedGraph::ReadGuard VersionedGraph::pin() const {
+    while (true) {
+        for (int slot = 0; slot < MAX_READERS; slot++) {
+            // announce the epoch before loading the pointer: a writer that does not see this
+            // announcement has already swapped the pointer, so we cannot get a retired snapshot
+            unsigned long expected = IDLE;
+            unsigned long epoch = globalEpoch.load();
+            if (readers[slot].epoch.compare_exchange_strong(expected, epoch)) {
+                return ReadGuard(this, slot, current.load());
+            }
+        }
+        this_thread::yield();
+    }
+}
+
+void VersionedGraph::unpin(int slot) const {
+    readers[slot].epoch.store(IDLE);
+}
+
+unsigned long VersionedGraph::publish(const GraphDelta &delta) {
+    lock_guard<mutex> lock(writerMutex);
+    const GraphSnapshot *old = current.load();
+    auto next = new GraphSnapshot(old->applyDelta(delta));
+    current.store(next);
+    retired.push_back(make_pair(globalEpoch.fetch_add(1), old));
+    reclaimLocked();
+    return next->getVersion();
+}
+
+int VersionedGraph::reclaim() {
+    lock_guard<mutex> lock(writerMutex);
+    return reclaimLocked();
+}
+
+int VersionedGraph::reclaimLocked() {
+    unsigned long oldestPinned = IDLE;
+    for (auto &reader: readers) {
+        unsigned long epoch = reader.epoch.load();
+        if (epoch < oldestPinned) oldestPinned = epoch;
+    }
+
+    // a snapshot retired at epoch r can only be held by readers that pinned at an epoch <= r
+    int freed = 0;
+    auto it = retired.begin();
+    while (it != retired.end()) {
+        if (it->first < oldestPinned) {
+            delete it->second;
+            it = retired.erase(it);
+            freed++;
+        } else {
+            it++;
+        }
+    }
+    return freed;
+}
+
+size_t VersionedGraph::getNumRetired() const {
+    lock_guard<mutex> lock(writerMutex);
+    return retired.size();
+}
@@ -0,0 +1,122 @@
+#ifndef PROJ2_VERSIONEDGRAPH_H
+#define PROJ2_VERSIONEDGRAPH_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include "GraphSnapshot.h"
+
+/**
+ * @brief Graph that can be updated while it is being queried (read-copy-update)
+ * @details Readers pin the current snapshot and keep using it for as long as they need, without ever
+ * blocking. Writers build a new snapshot from a delta and publish it with an atomic pointer swap, so
+ * readers never see a half-applied update. Replaced snapshots are retired and only freed once every
+ * reader that could still hold them has unpinned (epoch-based reclamation).
+ */
+class VersionedGraph {
+public:
+    /** Maximum number of simultaneously pinned readers */
+    static const int MAX_READERS = 64;
+
+    /**
+     * @brief Keeps a snapshot alive while it is in scope
+     */
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard &&other) noexcept;
+
+        ReadGuard(const ReadGuard &) = delete;
+
+        ReadGuard &operator=(const ReadGuard &) = delete;
+
+        ~ReadGuard();
+
+        const GraphSnapshot &operator*() const;
+
+        const GraphSnapshot *operator->() const;
+
+    private:
+        friend class VersionedGraph;
+
+        ReadGuard(const VersionedGraph *owner, int slot, const GraphSnapshot *snapshot);
+
+        const VersionedGraph *owner;
+        int slot;
+        const GraphSnapshot *snapshot;
+    };
+
+    /**
+     * @brief Constructs a versioned graph whose first version is the given snapshot
+     * @details Time complexity: O(1)
+     * @param initial Initial snapshot
+     */
+    explicit VersionedGraph(GraphSnapshot initial);
+
+    VersionedGraph(const VersionedGraph &) = delete;
+
+    VersionedGraph &operator=(const VersionedGraph &) = delete;
+
+    /**
+     * @brief Frees the current snapshot and all retired ones
+     * @details No reader may be pinned when the graph is destroyed
+     */
+    ~VersionedGraph();
+
+    /**
+     * @brief Pins the current snapshot
+     * @details Time complexity: O(R) in the worst case, where R is the number of pinned readers; never blocks on writers
+     * @return Guard giving access to the snapshot until it goes out of scope
+     */
+    ReadGuard pin() const;
+
+    /**
+     * @brief Builds a new snapshot from the current one and a delta and publishes it
+     * @details Time complexity: O(V + ElogE). Concurrent writers are serialised, readers are never blocked
+     * @param delta Changes to apply
+     * @return Version of the published snapshot
+     */
+    unsigned long publish(const GraphDelta &delta);
+
+    /**
+     * @brief Frees the retired snapshots that no reader can be using anymore
+     * @details Time complexity: O(R + S), where S is the number of retired snapshots
+     * @return Number of snapshots freed
+     */
+    int reclaim();
+
+    /**
+     * @brief Gets the number of retired snapshots waiting to be freed
+     * @details Time complexity: O(1)
+     * @return Number of retired snapshots
+     */
+    std::size_t getNumRetired() const;
+
+private:
+    static const unsigned long IDLE = ~0UL;
+
+    struct alignas(64) ReaderSlot {
+        std::atomic<unsigned long> epoch;
+    };
+
+    std::atomic<const GraphSnapshot *> current;
+    std::atomic<unsigned long> globalEpoch;
+    mutable ReaderSlot readers[MAX_READERS];
+
+    mutable std::mutex writerMutex;
+    std::vector<std::pair<unsigned long, const GraphSnapshot *>> retired; // (retire epoch, snapshot)
+
+    /**
+     * @brief Releases a reader slot
+     * @param slot Index of the slot
+     */
+    void unpin(int slot) const;
+
+    /**
+     * @brief Frees the retired snapshots that no reader can be using anymore, with the writer lock held
+     * @return Number of snapshots freed
+     */
+    int reclaimLocked();
+};
+
+#endif //PROJ2_VERSIONEDGRAPH_H
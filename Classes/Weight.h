@@ -0,0 +1,108 @@
+#ifndef PROJ2_WEIGHT_H
+#define PROJ2_WEIGHT_H
+
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <cstdlib>
+
+/*
+ * Weight and cost types of the distance matrix and of the solvers built on it.
+ *
+ * By default weights are doubles. Building with FIXED_POINT_WEIGHTS (CMake option PROJ2_FIXED_POINT_WEIGHTS)
+ * stores them as 32-bit integers in hundredths of the input unit (centimetres for weights in metres), and
+ * tour costs are summed in 64 bits, so costs are exact, do not depend on the order of the additions and
+ * compare as plain integers. Weights up to 21,474,836 input units can be represented.
+ */
+
+#ifdef FIXED_POINT_WEIGHTS
+typedef int32_t Weight;
+typedef int64_t Cost;
+/** Weight units per input unit */
+const double WEIGHT_SCALE = 100.0;
+/** Weight of a missing edge */
+const Weight MISSING_WEIGHT = std::numeric_limits<int32_t>::max();
+/** Cost of a tour that does not exist */
+const Cost INFINITE_COST = std::numeric_limits<int64_t>::max();
+/** Smallest cost change treated as an improvement */
+const Cost COST_EPSILON = 0;
+#else
+typedef double Weight;
+typedef double Cost;
+const double WEIGHT_SCALE = 1.0;
+const Weight MISSING_WEIGHT = std::numeric_limits<double>::infinity();
+const Cost INFINITE_COST = std::numeric_limits<double>::infinity();
+const Cost COST_EPSILON = 1e-9;
+#endif
+
+/**
+ * @brief Converts a weight in input units to the stored weight type
+ * @details Infinite weights become MISSING_WEIGHT and, in fixed-point mode, values round to the nearest
+ * hundredth and saturate below MISSING_WEIGHT. Time complexity: O(1)
+ * @param value Weight in input units
+ * @return The stored weight
+ */
+inline Weight toWeight(double value) {
+#ifdef FIXED_POINT_WEIGHTS
+    if (std::isinf(value) || std::isnan(value)) return MISSING_WEIGHT;
+    double scaled = std::round(value * WEIGHT_SCALE);
+    if (scaled >= MISSING_WEIGHT) return MISSING_WEIGHT - 1;
+    if (scaled <= -(double) MISSING_WEIGHT) return -MISSING_WEIGHT;
+    return (Weight) scaled;
+#else
+    return value;
+#endif
+}
+
+/**
+ * @brief Converts a cost back to input units
+ * @details Time complexity: O(1)
+ * @param cost Cost
+ * @return The cost in input units, infinity for INFINITE_COST
+ */
+inline double toDouble(Cost cost) {
+    if (cost == INFINITE_COST) return std::numeric_limits<double>::infinity();
+    return (double) cost / WEIGHT_SCALE;
+}
+
+/**
+ * @brief Parses a weight written in decimal
+ * @details In fixed-point mode the digits are read exactly, so the value does not go through binary floating
+ * point before being scaled. Time complexity: O(L), where L is the length of the text
+ * @param text Decimal number
+ * @return The weight in input units
+ */
+inline double parseWeight(const std::string &text) {
+#ifdef FIXED_POINT_WEIGHTS
+    const char *p = text.c_str();
+    while (*p == ' ' || *p == '\t') p++;
+    bool negative = *p == '-';
+    if (*p == '-' || *p == '+') p++;
+    int64_t units = 0;
+    int decimals = -1;
+    int64_t scale = (int64_t) WEIGHT_SCALE;
+    for (; (*p >= '0' && *p <= '9') || (*p == '.' && decimals < 0); p++) {
+        if (*p == '.') {
+            decimals = 0;
+            continue;
+        }
+        if (decimals >= 0 && (int64_t) std::pow(10, decimals + 1) > scale) {
+            // round half up on the first digit past the resolution
+            if (*p >= '5') units++;
+            break;
+        }
+        units = units * 10 + (*p - '0');
+        if (decimals >= 0) decimals++;
+    }
+    if (*p == 'e' || *p == 'E') return std::strtod(text.c_str(), nullptr);
+    for (int d = decimals < 0 ? 0 : decimals; (int64_t) std::pow(10, d) < scale; d++) {
+        units *= 10;
+    }
+    return (negative ? -(double) units : (double) units) / WEIGHT_SCALE;
+#else
+    return std::strtod(text.c_str(), nullptr);
+#endif
+}
+
+#endif //PROJ2_WEIGHT_H
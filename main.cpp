@@ -1,11 +1,22 @@
 #include <iostream>
 #include "Classes/Menu.h"
+#include "Classes/Trace.h"
+#include "Classes/Cli.h"
+#include "Classes/Autotuner.h"
 
-int main() {
+int main(int argc, char *argv[]) {
+    Trace::enableFromEnvironment();
+    Autotuner::loadConfigs("tuning.csv");
+    if (argc > 1) {
+        int status = Cli::run(argc, argv);
+        Trace::writeFromEnvironment();
+        return status;
+    }
     std::cout << "Loading ..." << std::endl;
     Menu m = Menu();
     m.showMenu();
     std::cout << std::endl;
+    Trace::writeFromEnvironment();
     std::cout << "Done!" << std::endl;
     return 0;
 }
@@ -0,0 +1,346 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "Classes/Graph.h"
+#include "Classes/MutablePriorityQueue.h"
+#include "Classes/AllocationTracker.h"
+
+using namespace std;
+
+/*
+ * Microbenchmarks of the Graph.h primitives, MutablePriorityQueue and DisjointSets, in ns/op and allocations/op.
+ * Built as proj2_microbench, with allocation tracking always on.
+ *
+ * Usage: proj2_microbench [filter] [max-vertices] [output.json]
+ * Only the primitives whose name contains the filter are run. The JSON output has one sample per repetition
+ * and can be compared with 'proj2 bench-compare'.
+ */
+
+namespace {
+    const int REPETITIONS = 5;
+
+    /**
+     * @brief Result of one primitive on one graph
+     */
+    struct Measurement {
+        string primitive;
+        string graph;
+        long ops = 0;
+        vector<double> nsPerOp;   // one value per repetition
+        double allocsPerOp = 0.0;
+        double bytesPerOp = 0.0;
+    };
+
+    /**
+     * @brief Shape of a benchmark graph
+     */
+    struct GraphShape {
+        string label;
+        int n;
+        string degrees;  // "uniform": 8 edges per vertex, "powerlaw": Pareto degrees of mean about 8, "complete"
+    };
+
+    /**
+     * @brief Edges of a graph shape, drawn once so every primitive sees the same graph
+     * @param shape Shape
+     * @param rng Random number generator
+     * @return Pairs of vertex ids
+     */
+    vector<pair<int, int>> drawEdges(const GraphShape &shape, mt19937 &rng) {
+        vector<pair<int, int>> edges;
+        uniform_int_distribution<int> pick(0, shape.n - 1);
+        for (int u = 0; u < shape.n; u++) {
+            int degree = 8;
+            if (shape.degrees == "complete") {
+                degree = shape.n - 1;
+            } else if (shape.degrees == "powerlaw") {
+                // Pareto with shape 1.5 and minimum 3 has mean 9; a few hubs get thousands of edges
+                double x = uniform_real_distribution<double>(0.0, 1.0)(rng);
+                degree = min(shape.n - 1, (int) (3.0 / pow(1.0 - x, 1.0 / 1.5)));
+            }
+            for (int k = 0; k < degree; k++) {
+                int v = shape.degrees == "complete" ? (u + 1 + k) % shape.n : pick(rng);
+                if (v != u) edges.emplace_back(u, v);
+            }
+        }
+        return edges;
+    }
+
+    void build(Graph<int> &g, int n, const vector<pair<int, int>> &edges) {
+        for (int v = 0; v < n; v++) {
+            g.addVertex(v);
+        }
+        for (const auto &e: edges) {
+            g.addEdge(e.first, e.second, 1.0 + (e.first ^ e.second) % 100);
+        }
+    }
+
+    /**
+     * @brief Frees the vertices and edges of a graph, which ~Graph() leaves alone because graphs are shallow-copied
+     * @param g Graph, unusable afterwards
+     */
+    void release(Graph<int> &g) {
+        for (auto v: g.getVertexSet()) {
+            for (auto e: v->getAdj()) {
+                delete e;
+            }
+            delete v;
+        }
+    }
+
+    /**
+     * @brief Runs a primitive a few times and keeps the time and heap traffic per operation
+     * @param primitive Name of the primitive
+     * @param graph Label of the graph
+     * @param setup Prepares a repetition, not timed
+     * @param body Runs the operations and returns how many it ran
+     * @param teardown Cleans up after a repetition, not timed
+     * @return The measurement
+     */
+    Measurement measure(const string &primitive, const string &graph, const function<void()> &setup,
+                        const function<long()> &body, const function<void()> &teardown) {
+        Measurement result;
+        result.primitive = primitive;
+        result.graph = graph;
+        for (int r = 0; r < REPETITIONS; r++) {
+            setup();
+            AllocationScope scope;
+            auto start = chrono::steady_clock::now();
+            long ops = body();
+            auto end = chrono::steady_clock::now();
+            AllocationStats stats = scope.getStats();
+            teardown();
+            result.ops = max(ops, 1L);
+            result.nsPerOp.push_back(chrono::duration<double, nano>(end - start).count() / (double) result.ops);
+            result.allocsPerOp = (double) stats.allocations / (double) result.ops;
+            result.bytesPerOp = (double) stats.bytes / (double) result.ops;
+        }
+        return result;
+    }
+
+    double median(vector<double> values) {
+        sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    void print(const Measurement &m) {
+        cout << left << setw(22) << m.primitive << setw(18) << m.graph << right << setw(10) << m.ops
+             << fixed << setprecision(1) << setw(14) << median(m.nsPerOp) << setprecision(2) << setw(12)
+             << m.allocsPerOp << setprecision(1) << setw(12) << m.bytesPerOp << endl;
+    }
+
+    /**
+     * @brief Runs the graph primitives on one graph shape
+     * @param shape Shape
+     * @param wanted Returns true for the primitives to run
+     * @param results Vector to append the measurements to
+     */
+    void graphPrimitives(const GraphShape &shape, const function<bool(const string &)> &wanted,
+                         vector<Measurement> &results) {
+        mt19937 rng(42);
+        vector<pair<int, int>> edges = drawEdges(shape, rng);
+        int n = shape.n;
+        const long lookups = 200000;
+        vector<int> randomVertices(lookups);
+        vector<pair<int, int>> randomEdges(lookups);
+        uniform_int_distribution<int> pickVertex(0, n - 1);
+        uniform_int_distribution<size_t> pickEdge(0, edges.size() - 1);
+        for (long k = 0; k < lookups; k++) {
+            randomVertices[k] = pickVertex(rng);
+            randomEdges[k] = edges[pickEdge(rng)];
+        }
+        // removals change the graph, so each repetition gets a fresh one
+        unique_ptr<Graph<int>> g;
+        auto fresh = [&]() {
+            g.reset(new Graph<int>());
+            build(*g, n, edges);
+        };
+        auto empty = [&]() { g.reset(new Graph<int>()); };
+        auto withVertices = [&]() {
+            g.reset(new Graph<int>());
+            for (int v = 0; v < n; v++) g->addVertex(v);
+        };
+        auto drop = [&]() {
+            release(*g);
+            g.reset();
+        };
+        auto run = [&](const string &primitive, const function<void()> &setup, const function<long()> &body) {
+            if (!wanted(primitive)) return;
+            results.push_back(measure(primitive, shape.label, setup, body, drop));
+            print(results.back());
+        };
+
+        run("addVertex", empty, [&]() {
+            for (int v = 0; v < n; v++) g->addVertex(v);
+            return (long) n;
+        });
+        run("addEdge", withVertices, [&]() {
+            for (const auto &e: edges) g->addEdge(e.first, e.second, 1.0);
+            return (long) edges.size();
+        });
+        run("findVertex", fresh, [&]() {
+            long found = 0;
+            for (int v: randomVertices) found += g->findVertex(v) != nullptr;
+            return found;
+        });
+        run("getAdj", fresh, [&]() {
+            size_t total = 0;
+            for (int v: randomVertices) total += g->findVertex(v)->getAdj().size();
+            return total > 0 ? lookups : 0;
+        });
+        run("getEdgeWeight", fresh, [&]() {
+            double total = 0;
+            for (const auto &e: randomEdges) total += g->getEdgeWeight(e.first, e.second);
+            return total > 0 ? lookups : 0;
+        });
+        // removing the edges of a random sample of pairs, and a few vertices, each of which scans the whole graph
+        long removals = min<long>(lookups / 10, (long) edges.size());
+        run("removeEdge", fresh, [&]() {
+            for (long k = 0; k < removals; k++) g->removeEdge(randomEdges[k].first, randomEdges[k].second);
+            return removals;
+        });
+        long vertexRemovals = max(1, min(100, 2000000 / (n + (int) edges.size())));
+        run("removeVertex", fresh, [&]() {
+            long removed = 0;
+            for (long k = 0; k < vertexRemovals; k++) removed += g->removeVertex(randomVertices[k]);
+            return removed;
+        });
+    }
+
+    /**
+     * @brief Runs the MutablePriorityQueue and DisjointSets operations on n elements
+     * @param n Number of elements
+     * @param wanted Returns true for the primitives to run
+     * @param results Vector to append the measurements to
+     */
+    void queuePrimitives(int n, const function<bool(const string &)> &wanted, vector<Measurement> &results) {
+        mt19937 rng(42);
+        string label = "n=" + to_string(n);
+        vector<double> keys(n);
+        for (double &k: keys) k = uniform_real_distribution<double>(0.0, 1e6)(rng);
+        vector<Vertex<int> *> items;
+        unique_ptr<MutablePriorityQueue<Vertex<int>>> q;
+        auto makeItems = [&]() {
+            for (int i = 0; i < n; i++) {
+                items.push_back(new Vertex<int>(i));
+                items.back()->setDist(keys[i]);
+            }
+            q.reset(new MutablePriorityQueue<Vertex<int>>());
+        };
+        auto filled = [&]() {
+            makeItems();
+            for (auto v: items) q->insert(v);
+        };
+        auto freeItems = [&]() {
+            for (auto v: items) delete v;
+            items.clear();
+            q.reset();
+        };
+        auto run = [&](const string &primitive, const function<void()> &setup, const function<long()> &body,
+                       const function<void()> &teardown) {
+            if (!wanted(primitive)) return;
+            results.push_back(measure(primitive, label, setup, body, teardown));
+            print(results.back());
+        };
+
+        run("pq.insert", makeItems, [&]() {
+            for (auto v: items) q->insert(v);
+            return (long) n;
+        }, freeItems);
+        run("pq.extractMin", filled, [&]() {
+            long extracted = 0;
+            while (!q->empty()) {
+                q->extractMin();
+                extracted++;
+            }
+            return extracted;
+        }, freeItems);
+        run("pq.decreaseKey", filled, [&]() {
+            for (auto v: items) {
+                v->setDist(v->getDist() / 2);
+                q->decreaseKey(v);
+            }
+            return (long) n;
+        }, freeItems);
+
+        unique_ptr<DisjointSets<int>> sets;
+        vector<pair<int, int>> pairs(n);
+        uniform_int_distribution<int> pick(0, n - 1);
+        for (auto &p: pairs) p = {pick(rng), pick(rng)};
+        auto makeSets = [&]() {
+            sets.reset(new DisjointSets<int>());
+            for (int i = 0; i < n; i++) sets->makeSet(i);
+        };
+        auto dropSets = [&]() { sets.reset(); };
+        run("ds.makeSet", [&]() { sets.reset(new DisjointSets<int>()); }, [&]() {
+            for (int i = 0; i < n; i++) sets->makeSet(i);
+            return (long) n;
+        }, dropSets);
+        run("ds.unionSets", makeSets, [&]() {
+            for (const auto &p: pairs) sets->unionSets(p.first, p.second);
+            return (long) n;
+        }, dropSets);
+        run("ds.findSet", [&]() {
+            makeSets();
+            for (int i = 0; i < n / 2; i++) sets->unionSets(pairs[i].first, pairs[i].second);
+        }, [&]() {
+            long total = 0;
+            for (const auto &p: pairs) total += sets->findSet(p.first) >= 0;
+            return total;
+        }, dropSets);
+    }
+
+    bool saveJson(const string &filename, const vector<Measurement> &results) {
+        ofstream file(filename);
+        if (!file.is_open()) {
+            cerr << "There was an error opening file " << filename << endl;
+            return false;
+        }
+        // same layout as Benchmark::saveJson()
+        file << "{\n  \"dataset\": \"microbench\",\n  \"cases\": [" << setprecision(17);
+        for (size_t i = 0; i < results.size(); i++) {
+            const Measurement &m = results[i];
+            file << (i == 0 ? "" : ",") << "\n    {\"name\": \"" << m.primitive << "/" << m.graph
+                 << "\", \"unit\": \"ns/op\", \"better\": \"lower\", \"samples\": [";
+            for (size_t k = 0; k < m.nsPerOp.size(); k++) {
+                file << (k == 0 ? "" : ", ") << m.nsPerOp[k];
+            }
+            file << "]}";
+        }
+        file << "\n  ]\n}\n";
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    string filter = argc > 1 ? argv[1] : "";
+    int maxVertices = argc > 2 ? stoi(argv[2]) : 100000;
+    auto wanted = [&](const string &primitive) { return primitive.find(filter) != string::npos; };
+    if (!AllocationScope::isEnabled()) cout << "Allocation tracking is off, allocs/op will read 0" << endl;
+
+    cout << left << setw(22) << "primitive" << setw(18) << "graph" << right << setw(10) << "ops" << setw(14)
+         << "ns/op" << setw(12) << "allocs/op" << setw(12) << "bytes/op" << endl;
+    vector<Measurement> results;
+    vector<GraphShape> shapes;
+    for (int n = 1000; n <= maxVertices; n *= 10) {
+        shapes.push_back({"uniform n=" + to_string(n), n, "uniform"});
+        shapes.push_back({"powerlaw n=" + to_string(n), n, "powerlaw"});
+    }
+    if (maxVertices >= 500) shapes.push_back({"complete n=500", 500, "complete"});
+    for (const auto &shape: shapes) {
+        graphPrimitives(shape, wanted, results);
+    }
+    for (int n = 1000; n <= maxVertices; n *= 10) {
+        queuePrimitives(n, wanted, results);
+    }
+    if (argc > 3 && !saveJson(argv[3], results)) return 1;
+    return 0;
+}